@@ -0,0 +1,401 @@
+#include "Benchmark.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/AnimationLOD.h"
+#include "CoffeeEngine/Animation/Animator.h"
+#include "CoffeeEngine/Animation/Pose.h"
+#include "CoffeeEngine/Animation/Skeleton.h"
+#include "CoffeeEngine/Animation/Skinning.h"
+#include "CoffeeEngine/Core/ThreadPool.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/SkinData.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Coffee::Bench {
+
+    static constexpr int kBoneCounts[] = {30, 100, 250};
+    static constexpr int kInstanceCounts[] = {1, 16, 256};
+    static constexpr int kKeyCount = 31; // One second at 30 keys per second
+    static constexpr int kVerticesPerBone = 32;
+    static constexpr int kBoneUpdatesPerMeasure = 4000000; ///< Work of one measure, so every configuration takes a similar time.
+
+    /**
+     * @brief A skeleton with two clips and a mesh skinned to it.
+     */
+    struct SyntheticRig
+    {
+        int boneCount = 0;
+        Ref<Animation> walk;
+        Ref<Animation> run;
+        std::vector<Vertex> vertices;
+        SkinData skin;
+    };
+
+    static std::string BoneName(int bone)
+    {
+        return "Bone" + std::to_string(bone);
+    }
+
+    // Chains of four bones branching off earlier bones, like limbs and fingers off a spine
+    static std::vector<int> CreateParents(int boneCount)
+    {
+        std::vector<int> parents(boneCount, -1);
+        for (int i = 1; i < boneCount; i++)
+            parents[i] = (i % 5 == 0) ? i / 5 : i - 1;
+        return parents;
+    }
+
+    static AssimpNodeData CreateNode(int bone, const std::vector<std::vector<int>>& children, const std::vector<glm::mat4>& locals)
+    {
+        AssimpNodeData node;
+        node.name = BoneName(bone);
+        node.transformation = locals[bone];
+        node.childrenCount = static_cast<int>(children[bone].size());
+        for (int child : children[bone])
+            node.children.push_back(CreateNode(child, children, locals));
+        return node;
+    }
+
+    static Ref<Skeleton> CreateSkeleton(const std::vector<int>& parents, const std::vector<glm::mat4>& locals)
+    {
+        int boneCount = static_cast<int>(parents.size());
+
+        std::vector<std::vector<int>> children(boneCount);
+        std::vector<glm::mat4> globals(boneCount);
+        std::map<std::string, BoneInfo> boneInfoMap;
+        for (int b = 0; b < boneCount; b++)
+        {
+            if (parents[b] >= 0)
+                children[parents[b]].push_back(b);
+
+            globals[b] = parents[b] >= 0 ? globals[parents[b]] * locals[b] : locals[b];
+            boneInfoMap[BoneName(b)] = {b, glm::inverse(globals[b])};
+        }
+
+        return CreateRef<Skeleton>("Synthetic" + std::to_string(boneCount), CreateNode(0, children, locals), boneInfoMap);
+    }
+
+    static Ref<Animation> CreateClip(const std::string& name, const Ref<Skeleton>& skeleton, const std::vector<glm::mat4>& locals, float frequency)
+    {
+        int boneCount = static_cast<int>(locals.size());
+
+        std::vector<Bone> bones;
+        bones.reserve(boneCount);
+        for (int b = 0; b < boneCount; b++)
+        {
+            std::vector<Bone::KeyPosition> positions(kKeyCount);
+            std::vector<Bone::KeyRotation> rotations(kKeyCount);
+            std::vector<Bone::KeyScale> scales(kKeyCount);
+
+            glm::vec3 bindTranslation = glm::vec3(locals[b][3]);
+            glm::quat bindRotation = glm::quat_cast(glm::mat3(locals[b]));
+            glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 0.25f * (b % 4), 0.5f));
+            for (int k = 0; k < kKeyCount; k++)
+            {
+                float t = static_cast<float>(k);
+                float phase = t * frequency + 0.1f * b;
+                positions[k] = {bindTranslation + glm::vec3(0.0f, 0.01f * std::sin(phase), 0.0f), t};
+                rotations[k] = {bindRotation * glm::angleAxis(0.4f * std::sin(phase), axis), t};
+                scales[k] = {glm::vec3(1.0f), t};
+            }
+
+            bones.emplace_back(BoneName(b), b, std::move(positions), std::move(rotations), std::move(scales));
+        }
+
+        return CreateRef<Animation>(name, static_cast<float>(kKeyCount - 1), 30, std::move(bones), skeleton);
+    }
+
+    static SyntheticRig CreateRig(int boneCount, std::mt19937& rng)
+    {
+        std::vector<int> parents = CreateParents(boneCount);
+        std::vector<glm::mat4> locals(boneCount);
+        for (int b = 0; b < boneCount; b++)
+        {
+            float angle = 0.2f * static_cast<float>(b % 7) - 0.6f;
+            locals[b] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, b == 0 ? 0.0f : 0.1f, 0.0f)) *
+                        glm::toMat4(glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f)));
+        }
+
+        SyntheticRig rig;
+        rig.boneCount = boneCount;
+        // Both clips share the skeleton, like the clips of an imported library
+        Ref<Skeleton> skeleton = CreateSkeleton(parents, locals);
+        rig.walk = CreateClip("Walk", skeleton, locals, 0.21f);
+        rig.run = CreateClip("Run", skeleton, locals, 0.42f);
+
+        // Each vertex follows a bone and, weighted less, its parent and grandparent
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        uint32_t vertexCount = static_cast<uint32_t>(boneCount * kVerticesPerBone);
+        rig.vertices.resize(vertexCount);
+        std::vector<VertexInfluences> influences(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            int bone = static_cast<int>(v / kVerticesPerBone);
+            rig.vertices[v].Position = glm::vec3(value(rng), 0.1f * bone, value(rng));
+            rig.vertices[v].Normals = glm::normalize(glm::vec3(value(rng), value(rng), 1.0f));
+
+            float weight = 1.0f;
+            for (int b = bone; b >= 0 && influences[v].count < 3; b = parents[b])
+            {
+                influences[v].Add(static_cast<uint32_t>(b), weight);
+                weight *= 0.5f;
+            }
+        }
+        rig.skin = SkinData::Build(influences);
+
+        return rig;
+    }
+
+    // The bones of a Mixamo humanoid, each after its parent
+    static void AddHumanoidBone(std::vector<std::string>& names, std::vector<int>& parents, const std::string& name, int parent)
+    {
+        names.push_back(name);
+        parents.push_back(parent);
+    }
+
+    static int AddHumanoidChain(std::vector<std::string>& names, std::vector<int>& parents, const std::string& prefix, int length, int parent)
+    {
+        for (int i = 1; i <= length; i++)
+        {
+            AddHumanoidBone(names, parents, prefix + std::to_string(i), parent);
+            parent = static_cast<int>(names.size()) - 1;
+        }
+        return parent;
+    }
+
+    static AssimpNodeData CreateNamedNode(int bone, const std::vector<std::string>& names, const std::vector<std::vector<int>>& children)
+    {
+        AssimpNodeData node;
+        node.name = names[bone];
+        node.transformation = glm::mat4(1.0f);
+        node.childrenCount = static_cast<int>(children[bone].size());
+        for (int child : children[bone])
+            node.children.push_back(CreateNamedNode(child, names, children));
+        return node;
+    }
+
+    static Ref<Skeleton> CreateHumanoidSkeleton()
+    {
+        std::vector<std::string> names;
+        std::vector<int> parents;
+        AddHumanoidBone(names, parents, "Hips", -1);
+        int spine2 = AddHumanoidChain(names, parents, "Spine", 3, 0);
+
+        AddHumanoidBone(names, parents, "Neck", spine2);
+        AddHumanoidBone(names, parents, "Head", static_cast<int>(names.size()) - 1);
+        int head = static_cast<int>(names.size()) - 1;
+        AddHumanoidBone(names, parents, "HeadTop_End", head);
+        AddHumanoidBone(names, parents, "LeftEye", head);
+        AddHumanoidBone(names, parents, "RightEye", head);
+
+        for (const char* side : {"Left", "Right"})
+        {
+            std::string prefix = side;
+            AddHumanoidBone(names, parents, prefix + "Shoulder", spine2);
+            AddHumanoidBone(names, parents, prefix + "Arm", static_cast<int>(names.size()) - 1);
+            AddHumanoidBone(names, parents, prefix + "ForeArm", static_cast<int>(names.size()) - 1);
+            AddHumanoidBone(names, parents, prefix + "Hand", static_cast<int>(names.size()) - 1);
+            int hand = static_cast<int>(names.size()) - 1;
+            for (const char* finger : {"Thumb", "Index", "Middle", "Ring", "Pinky"})
+                AddHumanoidChain(names, parents, prefix + "Hand" + finger, 4, hand);
+
+            AddHumanoidBone(names, parents, prefix + "UpLeg", 0);
+            AddHumanoidBone(names, parents, prefix + "Leg", static_cast<int>(names.size()) - 1);
+            AddHumanoidBone(names, parents, prefix + "Foot", static_cast<int>(names.size()) - 1);
+            AddHumanoidBone(names, parents, prefix + "ToeBase", static_cast<int>(names.size()) - 1);
+            AddHumanoidBone(names, parents, prefix + "Toe_End", static_cast<int>(names.size()) - 1);
+        }
+
+        std::vector<std::vector<int>> children(names.size());
+        std::map<std::string, BoneInfo> boneInfoMap;
+        for (size_t b = 0; b < names.size(); b++)
+        {
+            if (parents[b] >= 0)
+                children[parents[b]].push_back(static_cast<int>(b));
+            boneInfoMap[names[b]] = {static_cast<int>(b), glm::mat4(1.0f)};
+        }
+
+        return CreateRef<Skeleton>("Humanoid", CreateNamedNode(0, names, children), boneInfoMap);
+    }
+
+    // Bone reduction may only drop the fingers and the small bones of the head, a dropped arm or head shows in bind pose
+    static void CheckHumanoidBoneReduction()
+    {
+        Ref<Skeleton> skeleton = CreateHumanoidSkeleton();
+        const std::vector<AnimationNode>& nodes = skeleton->GetNodes();
+
+        auto isDetail = [](const std::string& name) {
+            for (const char* detail : {"HandThumb", "HandIndex", "HandMiddle", "HandRing", "HandPinky", "Eye", "HeadTop_End"})
+            {
+                if (name.find(detail) != std::string::npos)
+                    return true;
+            }
+            return false;
+        };
+
+        AnimationLODSettings settings;
+        std::printf("\nBone reduction on a %zu bone humanoid\n", nodes.size());
+        for (uint32_t tier = 0; tier < settings.tierCount; tier++)
+        {
+            int boneReduction = settings.tiers[tier].boneReduction;
+            uint32_t dropped = 0;
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i].reductionLevel > boneReduction)
+                    continue;
+
+                dropped++;
+                if (!isDetail(skeleton->GetNodeName(static_cast<int>(i))))
+                {
+                    std::printf("FAILED: tier %u drops %s\n", tier, skeleton->GetNodeName(static_cast<int>(i)).c_str());
+                    g_Failed = true;
+                }
+            }
+            std::printf("%-48s %12u bones\n", ("tier " + std::to_string(tier) + " (reduction " + std::to_string(boneReduction) + ") drops").c_str(), dropped);
+        }
+    }
+
+    static int IterationsFor(int boneCount, int instanceCount)
+    {
+        return std::max(5, kBoneUpdatesPerMeasure / (boneCount * instanceCount));
+    }
+
+    // The stages of one evaluation, on a single instance
+    static void RunStageBenchmarks(const SyntheticRig& rig)
+    {
+        const Animation& walk = *rig.walk;
+        const Animation& run = *rig.run;
+        const uint32_t nodeCount = static_cast<uint32_t>(walk.GetNodes().size());
+        const uint32_t boneCount = static_cast<uint32_t>(rig.boneCount);
+        const int iterations = IterationsFor(rig.boneCount, 1);
+        auto time = [&](int i) { return std::fmod(i * 0.5f, walk.GetDuration()); };
+
+        PosePool pool(nodeCount, 3);
+        Pose walkPose = pool.Acquire();
+        Pose runPose = pool.Acquire();
+        Pose blendedPose = pool.Acquire();
+
+        std::vector<Bone::SamplingCursor> walkCursors(walk.GetBones().size());
+        std::vector<Bone::SamplingCursor> runCursors(run.GetBones().size());
+        SamplePose(walk, 0.0f, walkCursors.data(), walkPose);
+        SamplePose(run, 0.0f, runCursors.data(), runPose);
+
+        Report("keyframe sampling, scalar reference", Measure(iterations, [&](int i) {
+            SamplePoseReference(walk, time(i), walkCursors.data(), walkPose);
+            g_Sink = walkPose.translations[0].y;
+        }), boneCount, 1);
+
+        Report("keyframe sampling", Measure(iterations, [&](int i) {
+            SamplePose(walk, time(i), walkCursors.data(), walkPose);
+            g_Sink = walkPose.translations[0].y;
+        }), boneCount, 1);
+
+        Report("pose blending", Measure(iterations, [&](int i) {
+            BlendPoses(walkPose, runPose, (i % 100) * 0.01f, blendedPose);
+            g_Sink = blendedPose.rotations[0].w;
+        }), boneCount, 1);
+
+        std::vector<glm::mat4> globalTransforms(nodeCount);
+        std::vector<glm::mat4> boneMatrices(walk.GetBoneCount());
+        Report("hierarchy propagation", Measure(iterations, [&](int) {
+            ComputeBoneMatrices(walk.GetNodes(), blendedPose, globalTransforms.data(), boneMatrices.data());
+            g_Sink = boneMatrices[0][3][0];
+        }), boneCount, 1);
+
+        // A socket on the last bone of the hierarchy only needs its chain up to the root
+        Ref<BoneMask> socketMask = walk.GetSkeleton()->GetBoneMask({BoneName(rig.boneCount - 1)});
+        Report("masked evaluation (one socket)", Measure(iterations, [&](int i) {
+            SamplePose(walk, time(i), walkCursors.data(), walkPose, 0, socketMask.get());
+            ComputeBoneMatrices(walk.GetNodes(), walkPose, globalTransforms.data(), nullptr, socketMask.get());
+            g_Sink = globalTransforms[socketMask->GetNodes().back()][3][0];
+        }), boneCount, 1);
+
+        uint32_t vertexCount = static_cast<uint32_t>(rig.vertices.size());
+        std::vector<glm::vec3> positions(vertexCount), normals(vertexCount);
+        Report("cpu skinning (32 vertices per bone)", Measure(std::max(5, iterations / kVerticesPerBone), [&](int) {
+            SkinVertices(rig.vertices.data(), rig.skin, 0, vertexCount, boneMatrices.data(), boneCount, positions.data(), normals.data());
+            g_Sink = positions[0].x;
+        }), boneCount, 1);
+
+        pool.Release(blendedPose);
+        pool.Release(runPose);
+        pool.Release(walkPose);
+    }
+
+    // Whole animator updates of many instances, with desynchronized clocks as in a crowd
+    static void RunInstanceBenchmarks(const SyntheticRig& rig, int instanceCount)
+    {
+        const uint32_t boneCount = static_cast<uint32_t>(rig.boneCount);
+        const int iterations = IterationsFor(rig.boneCount, instanceCount);
+        const float dt = 1.0f / 60.0f;
+
+        std::vector<Animator> animators;
+        animators.reserve(instanceCount);
+        for (int i = 0; i < instanceCount; i++)
+        {
+            animators.emplace_back(rig.walk.get());
+            animators.back().UpdateAnimation(i * 0.037f);
+        }
+
+        std::string name = "animator update, " + std::to_string(instanceCount) + " instances";
+        Report(name.c_str(), Measure(iterations, [&](int) {
+            for (Animator& animator : animators)
+                animator.UpdateAnimation(dt);
+            g_Sink = animators[0].GetFinalBoneMatrices()[0][3][0];
+        }), boneCount, instanceCount);
+
+        name = "animator update, thread pool, " + std::to_string(instanceCount) + " instances";
+        Report(name.c_str(), Measure(iterations, [&](int) {
+            ThreadPool::ParallelFor(static_cast<uint32_t>(instanceCount), 4, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++)
+                    animators[i].UpdateAnimation(dt);
+            });
+            g_Sink = animators[0].GetFinalBoneMatrices()[0][3][0];
+        }), boneCount, instanceCount);
+
+        // A fade that never completes keeps every update blending two clips
+        for (Animator& animator : animators)
+            animator.CrossFade(rig.run.get(), 1.0e9f);
+
+        name = "crossfade update, " + std::to_string(instanceCount) + " instances";
+        Report(name.c_str(), Measure(iterations, [&](int) {
+            for (Animator& animator : animators)
+                animator.UpdateAnimation(dt);
+            g_Sink = animators[0].GetFinalBoneMatrices()[0][3][0];
+        }), boneCount, instanceCount);
+    }
+
+    void RunAnimationBenchmarks()
+    {
+        BeginSuite("animation");
+
+        CheckHumanoidBoneReduction();
+
+        ThreadPool::Init();
+
+        std::mt19937 rng(1234);
+        for (int boneCount : kBoneCounts)
+        {
+            SyntheticRig rig = CreateRig(boneCount, rng);
+
+            std::printf("\nAnimation, %d bones, %d keys per track\n", boneCount, kKeyCount);
+            RunStageBenchmarks(rig);
+            for (int instanceCount : kInstanceCounts)
+                RunInstanceBenchmarks(rig, instanceCount);
+        }
+
+        ThreadPool::Shutdown();
+    }
+
+}
@@ -0,0 +1,103 @@
+#include "Benchmark.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Animation/Bone.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace Coffee::Bench {
+
+    static constexpr int kBoneCount = 60;
+    static constexpr int kKeyCount = 900; // 30 seconds at 30 keys per second
+
+    // A clip with the usual mix of tracks: smooth motion, constant scales and a few static bones.
+    static std::vector<Bone> CreateClip()
+    {
+        std::vector<Bone> bones;
+        bones.reserve(kBoneCount);
+
+        for (int b = 0; b < kBoneCount; b++)
+        {
+            std::vector<Bone::KeyPosition> positions(kKeyCount);
+            std::vector<Bone::KeyRotation> rotations(kKeyCount);
+            std::vector<Bone::KeyScale> scales(kKeyCount);
+
+            const bool isStatic = (b % 7) == 0;
+            const float frequency = 0.02f + 0.003f * b;
+
+            for (int i = 0; i < kKeyCount; i++)
+            {
+                float t = static_cast<float>(i);
+                float phase = isStatic ? 0.0f : t * frequency;
+                positions[i] = {glm::vec3(0.0f, 0.1f * b, 0.0f) + glm::vec3(std::sin(phase), 0.0f, std::cos(phase)) * 0.05f, t};
+                rotations[i] = {glm::angleAxis(std::sin(phase) * 1.2f, glm::normalize(glm::vec3(1.0f, 0.3f * b, 0.5f))), t};
+                scales[i] = {glm::vec3(1.0f), t};
+            }
+
+            bones.emplace_back("Bone" + std::to_string(b), b, std::move(positions), std::move(rotations), std::move(scales));
+        }
+
+        return bones;
+    }
+
+    void RunAnimationCompressionBenchmarks()
+    {
+        BeginSuite("animation_compression");
+
+        std::vector<Bone> raw = CreateClip();
+        std::vector<Bone> compressed = raw;
+
+        AnimationCompressionStats stats;
+        for (Bone& bone : compressed)
+            stats.Merge(bone.Compress(AnimationCompressionSettings{}));
+
+        // Error between the raw and compressed clip sampled between the original keys
+        float maxPositionError = 0.0f;
+        float maxRotationError = 0.0f;
+        for (int b = 0; b < kBoneCount; b++)
+        {
+            Bone::SamplingCursor rawCursor, compressedCursor;
+            for (float t = 0.0f; t < kKeyCount - 1; t += 0.25f)
+            {
+                glm::vec3 rawPosition, rawScale, position, scale;
+                glm::quat rawRotation, rotation;
+                raw[b].Sample(t, rawCursor, rawPosition, rawRotation, rawScale);
+                compressed[b].Sample(t, compressedCursor, position, rotation, scale);
+
+                maxPositionError = std::max(maxPositionError, glm::length(rawPosition - position));
+                maxRotationError = std::max(maxRotationError, QuatAngularDistance(rawRotation, rotation));
+            }
+        }
+
+        std::printf("\nAnimation compression, %d bones, %d keys per track\n", kBoneCount, kKeyCount);
+        std::printf("%-48s %12.1f KB\n", "raw clip memory", stats.rawBytes / 1024.0);
+        std::printf("%-48s %12.1f KB\n", "compressed clip memory", stats.compressedBytes / 1024.0);
+        std::printf("%-48s %12u -> %u\n", "keys", stats.rawKeys, stats.compressedKeys);
+        std::printf("%-48s %12.6f\n", "max position error at keys", stats.maxPositionError);
+        std::printf("%-48s %12.6f rad\n", "max rotation error at keys", stats.maxRotationError);
+        std::printf("%-48s %12.6f\n", "max position error between keys", maxPositionError);
+        std::printf("%-48s %12.6f rad\n", "max rotation error between keys", maxRotationError);
+
+        const float duration = static_cast<float>(kKeyCount - 1);
+        auto forwardTime = [&](int i) { return std::fmod(i * 0.5f, duration); };
+
+        std::vector<Bone::SamplingCursor> cursors(kBoneCount);
+        Report("raw clip, forward playback (per bone)", Measure(20000, [&](int i) {
+            const int b = i % kBoneCount;
+            g_Sink = raw[b].Sample(forwardTime(i / kBoneCount), cursors[b])[3][0];
+        }));
+
+        cursors.assign(kBoneCount, {});
+        Report("compressed clip, forward playback (per bone)", Measure(20000, [&](int i) {
+            const int b = i % kBoneCount;
+            g_Sink = compressed[b].Sample(forwardTime(i / kBoneCount), cursors[b])[3][0];
+        }));
+    }
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Coffee::Bench {
+
+    /**
+     * @brief Written by the benchmarks so the compiler cannot discard the measured work.
+     */
+    inline volatile float g_Sink = 0.0f;
+
+    /**
+     * @brief A single measurement, as written to the JSON report.
+     */
+    struct BenchmarkResult
+    {
+        std::string suite; ///< The suite the benchmark belongs to.
+        std::string name; ///< The name of the benchmark.
+        uint32_t bones = 0; ///< The bones of the skeleton, 0 if the benchmark does not depend on a skeleton.
+        uint32_t instances = 0; ///< The animated instances of one operation, 0 if not relevant.
+        double nsPerOp = 0.0; ///< The average time of one operation in nanoseconds.
+        double nsPerInstance = 0.0; ///< nsPerOp divided by the instances, 0 if not relevant.
+        double nsPerBone = 0.0; ///< nsPerOp divided by the bones of every instance, 0 if not relevant.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(CEREAL_NVP(suite), CEREAL_NVP(name), CEREAL_NVP(bones), CEREAL_NVP(instances),
+                    CEREAL_NVP(nsPerOp), CEREAL_NVP(nsPerInstance), CEREAL_NVP(nsPerBone));
+        }
+    };
+
+    /**
+     * @brief Set by the checks run next to the benchmarks, the run then exits with an error.
+     */
+    inline bool g_Failed = false;
+
+    /**
+     * @brief Every result reported since the start of the run.
+     */
+    inline std::vector<BenchmarkResult> g_Results;
+
+    /**
+     * @brief The suite the next reported results belong to.
+     */
+    inline std::string g_Suite;
+
+    /**
+     * @brief Runs a function repeatedly and returns the average time of one call.
+     * @param iterations The number of calls to measure.
+     * @param fn The function to measure.
+     * @return The average time per call in nanoseconds.
+     */
+    template<typename Fn>
+    double Measure(int iterations, Fn&& fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            fn(i);
+        auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    /**
+     * @brief Starts a suite, the results reported until the next suite are grouped under its name.
+     * @param suite The name of the suite in the JSON report.
+     */
+    inline void BeginSuite(const char* suite)
+    {
+        g_Suite = suite;
+    }
+
+    /**
+     * @brief Prints a single benchmark result.
+     * @param name The name of the benchmark.
+     * @param nsPerOp The average time per operation in nanoseconds.
+     */
+    inline void Report(const char* name, double nsPerOp)
+    {
+        std::printf("%-48s %12.2f ns/op\n", name, nsPerOp);
+        g_Results.push_back({g_Suite, name, 0, 0, nsPerOp, 0.0, 0.0});
+    }
+
+    /**
+     * @brief Prints a benchmark result scaled by the work of the operation.
+     * @param name The name of the benchmark.
+     * @param nsPerOp The average time per operation in nanoseconds.
+     * @param bones The bones of the skeleton of every instance.
+     * @param instances The instances updated by one operation.
+     */
+    inline void Report(const char* name, double nsPerOp, uint32_t bones, uint32_t instances)
+    {
+        double nsPerInstance = nsPerOp / instances;
+        double nsPerBone = nsPerInstance / bones;
+        std::printf("%-48s %12.2f ns/op %12.2f ns/instance %8.2f ns/bone\n", name, nsPerOp, nsPerInstance, nsPerBone);
+        g_Results.push_back({g_Suite, name, bones, instances, nsPerOp, nsPerInstance, nsPerBone});
+    }
+
+    void RunBoneSamplingBenchmarks();
+    void RunAnimationCompressionBenchmarks();
+    void RunSkinningBenchmarks();
+    void RunAnimationBenchmarks();
+    void RunShaderUniformBenchmarks();
+
+}
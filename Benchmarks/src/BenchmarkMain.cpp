@@ -0,0 +1,80 @@
+#include "Benchmark.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifndef COFFEE_ENGINE_VERSION
+    #define COFFEE_ENGINE_VERSION "unknown"
+#endif
+
+#ifndef COFFEE_BENCH_CONFIG
+    #define COFFEE_BENCH_CONFIG "unknown"
+#endif
+
+// Usage: coffee-anim-bench [--suite <name>]... [--json <file>]
+// Runs headless, no window or graphics context is created.
+int main(int argc, char** argv)
+{
+    using namespace Coffee::Bench;
+
+    std::vector<std::string> suites;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--suite") == 0 && i + 1 < argc)
+        {
+            suites.emplace_back(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            std::printf("Usage: %s [--suite bone_sampling|animation_compression|skinning|animation|shader_uniforms]... [--json <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Engine code may log, the loggers do not need a window
+    Coffee::Log::Init();
+
+    auto selected = [&](const char* suite) {
+        return suites.empty() || std::find(suites.begin(), suites.end(), suite) != suites.end();
+    };
+
+    if (selected("bone_sampling"))
+        RunBoneSamplingBenchmarks();
+    if (selected("animation_compression"))
+        RunAnimationCompressionBenchmarks();
+    if (selected("skinning"))
+        RunSkinningBenchmarks();
+    if (selected("animation"))
+        RunAnimationBenchmarks();
+    if (selected("shader_uniforms"))
+        RunShaderUniformBenchmarks();
+
+    if (jsonPath)
+    {
+        std::ofstream file(jsonPath);
+        if (!file)
+        {
+            std::printf("Could not write the report to %s\n", jsonPath);
+            return 1;
+        }
+
+        cereal::JSONOutputArchive archive(file);
+        archive(cereal::make_nvp("engineVersion", std::string(COFFEE_ENGINE_VERSION)),
+                cereal::make_nvp("config", std::string(COFFEE_BENCH_CONFIG)),
+                cereal::make_nvp("results", g_Results));
+    }
+
+    return g_Failed ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include "Benchmark.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/Pose.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Coffee::Bench {
+
+    static constexpr int kKeyCount = 10000;
+    static constexpr int kSamples = 200000;
+    static constexpr int kBatchBones = 256; ///< Bones sampled together by the SIMD comparison.
+    static constexpr int kBatchKeys = 31;
+
+    static Bone CreateLongBone(int keyCount)
+    {
+        std::vector<Bone::KeyPosition> positions(keyCount);
+        std::vector<Bone::KeyRotation> rotations(keyCount);
+        std::vector<Bone::KeyScale> scales(keyCount);
+
+        for (int i = 0; i < keyCount; i++)
+        {
+            float t = static_cast<float>(i);
+            positions[i] = {glm::vec3(std::sin(t * 0.1f), std::cos(t * 0.1f), t * 0.01f), t};
+            rotations[i] = {glm::angleAxis(t * 0.05f, glm::vec3(0.0f, 1.0f, 0.0f)), t};
+            scales[i] = {glm::vec3(1.0f), t};
+        }
+
+        return Bone("LongBone", 0, std::move(positions), std::move(rotations), std::move(scales));
+    }
+
+    // Reproduces the original lookup, which scanned every track from key 0 on each sample.
+    template<typename Key>
+    static int LinearScanIndex(const std::vector<Key>& keys, float animationTime)
+    {
+        for (int index = 0; index < static_cast<int>(keys.size()) - 1; ++index)
+        {
+            if (animationTime < keys[index + 1].timeStamp)
+                return index;
+        }
+        return static_cast<int>(keys.size()) - 2;
+    }
+
+    static glm::mat4 LinearScanUpdate(const Bone& bone, float animationTime)
+    {
+        const auto& positions = bone.GetPositionKeys();
+        const auto& rotations = bone.GetRotationKeys();
+        const auto& scales = bone.GetScaleKeys();
+
+        int p = LinearScanIndex(positions, animationTime);
+        int r = LinearScanIndex(rotations, animationTime);
+        int s = LinearScanIndex(scales, animationTime);
+
+        float pf = (animationTime - positions[p].timeStamp) / (positions[p + 1].timeStamp - positions[p].timeStamp);
+        float rf = (animationTime - rotations[r].timeStamp) / (rotations[r + 1].timeStamp - rotations[r].timeStamp);
+        float sf = (animationTime - scales[s].timeStamp) / (scales[s + 1].timeStamp - scales[s].timeStamp);
+
+        return glm::translate(glm::mat4(1.0f), glm::mix(positions[p].position, positions[p + 1].position, pf)) *
+               glm::toMat4(glm::normalize(glm::slerp(rotations[r].orientation, rotations[r + 1].orientation, rf))) *
+               glm::scale(glm::mat4(1.0f), glm::mix(scales[s].scale, scales[s + 1].scale, sf));
+    }
+
+    // Short tracks like those of a clip, rotating by up to about 20 degrees per key, with a few large jumps for the slerp fallback
+    static std::vector<Bone> CreateBatchBones(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+        std::vector<Bone> bones;
+        bones.reserve(kBatchBones);
+        for (int b = 0; b < kBatchBones; b++)
+        {
+            std::vector<Bone::KeyPosition> positions(kBatchKeys);
+            std::vector<Bone::KeyRotation> rotations(kBatchKeys);
+            std::vector<Bone::KeyScale> scales(kBatchKeys);
+
+            glm::vec3 axis = glm::normalize(glm::vec3(value(rng), value(rng), value(rng)) + glm::vec3(0.0f, 0.0f, 2.0f));
+            float speed = b % 16 == 0 ? 1.5f : 0.35f * value(rng);
+            for (int k = 0; k < kBatchKeys; k++)
+            {
+                float t = static_cast<float>(k);
+                positions[k] = {glm::vec3(value(rng), value(rng), value(rng)) * 0.1f, t};
+                rotations[k] = {glm::angleAxis(t * speed, axis), t};
+                scales[k] = {glm::vec3(1.0f + 0.1f * std::sin(t * 0.3f)), t};
+            }
+
+            bones.emplace_back("BatchBone" + std::to_string(b), b, std::move(positions), std::move(rotations), std::move(scales));
+        }
+        return bones;
+    }
+
+    // The SIMD sampling and composition against the scalar Bone::Sample path, on a batch of bones sampled at the same time
+    static void RunBatchSamplingBenchmarks()
+    {
+        std::mt19937 rng(4321);
+        std::vector<Bone> bones = CreateBatchBones(rng);
+        std::vector<Bone::SamplingCursor> cursors(kBatchBones);
+        std::vector<Bone::Segment> segments(kBatchBones);
+        std::vector<glm::vec3> translations(kBatchBones), scales(kBatchBones);
+        std::vector<glm::quat> rotations(kBatchBones);
+        std::vector<glm::mat4> transforms(kBatchBones), referenceTransforms(kBatchBones);
+
+        const float duration = static_cast<float>(kBatchKeys - 1);
+        auto time = [&](int i) { return std::fmod(i * 0.37f, duration); };
+
+        // Accuracy, at times spread over every segment of the tracks
+        float maxPositionError = 0.0f, maxRotationError = 0.0f, maxMatrixError = 0.0f;
+        for (int i = 0; i < 500; i++)
+        {
+            float t = time(i);
+            for (int b = 0; b < kBatchBones; b++)
+                bones[b].GetSegment(t, cursors[b], segments[b]);
+            SampleSegments(segments.data(), kBatchBones, translations.data(), rotations.data(), scales.data());
+            ComposeTransforms(translations.data(), rotations.data(), scales.data(), kBatchBones, transforms.data());
+
+            for (int b = 0; b < kBatchBones; b++)
+            {
+                Bone::SamplingCursor cursor;
+                glm::vec3 position, scale;
+                glm::quat rotation;
+                bones[b].Sample(t, cursor, position, rotation, scale);
+                glm::mat4 reference = bones[b].Sample(t, cursor);
+
+                maxPositionError = std::max(maxPositionError, glm::length(position - translations[b]));
+                maxRotationError = std::max(maxRotationError, 2.0f * std::acos(std::min(1.0f, std::abs(glm::dot(rotation, rotations[b])))));
+                for (int c = 0; c < 4; c++)
+                    maxMatrixError = std::max(maxMatrixError, glm::length(reference[c] - transforms[b][c]));
+            }
+        }
+
+        std::printf("\nBatch sampling, %d bones, %d keys per track\n", kBatchBones, kBatchKeys);
+        std::printf("%-48s %12g / %g deg / %g\n", "simd max error (position / rotation / matrix)", maxPositionError, glm::degrees(maxRotationError), maxMatrixError);
+
+        const int iterations = 20000;
+        std::fill(cursors.begin(), cursors.end(), Bone::SamplingCursor{});
+        Report("scalar Bone::Sample to mat4", Measure(iterations, [&](int i) {
+            float t = time(i);
+            for (int b = 0; b < kBatchBones; b++)
+                referenceTransforms[b] = bones[b].Sample(t, cursors[b]);
+            g_Sink = referenceTransforms[0][3][0];
+        }), kBatchBones, 1);
+
+        std::fill(cursors.begin(), cursors.end(), Bone::SamplingCursor{});
+        Report("simd segments, nlerp and affine compose", Measure(iterations, [&](int i) {
+            float t = time(i);
+            for (int b = 0; b < kBatchBones; b++)
+                bones[b].GetSegment(t, cursors[b], segments[b]);
+            SampleSegments(segments.data(), kBatchBones, translations.data(), rotations.data(), scales.data());
+            ComposeTransforms(translations.data(), rotations.data(), scales.data(), kBatchBones, transforms.data());
+            g_Sink = transforms[0][3][0];
+        }), kBatchBones, 1);
+    }
+
+    void RunBoneSamplingBenchmarks()
+    {
+        BeginSuite("bone_sampling");
+
+        Bone bone = CreateLongBone(kKeyCount);
+        const float duration = static_cast<float>(kKeyCount - 1);
+
+        // Forward playback at 60 fps with 30 ticks per second, looping at the end of the clip.
+        const float step = 0.5f;
+        auto forwardTime = [&](int i) { return std::fmod(i * step, duration); };
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> dist(0.0f, duration);
+        std::vector<float> seekTimes(kSamples);
+        for (float& t : seekTimes)
+            t = dist(rng);
+
+        std::printf("Bone sampling, %d keys per track\n", kKeyCount);
+
+        Report("linear scan, forward playback", Measure(kSamples / 100, [&](int i) {
+            g_Sink = LinearScanUpdate(bone, forwardTime(i * 100))[3][0];
+        }));
+
+        Report("linear scan, random seek", Measure(kSamples / 100, [&](int i) {
+            g_Sink = LinearScanUpdate(bone, seekTimes[i])[3][0];
+        }));
+
+        Bone::SamplingCursor cursor;
+        Report("cursor, forward playback", Measure(kSamples, [&](int i) {
+            bone.Update(forwardTime(i), cursor);
+            g_Sink = bone.GetLocalTransform()[3][0];
+        }));
+
+        cursor = {};
+        Report("cursor, reverse playback", Measure(kSamples, [&](int i) {
+            bone.Update(duration - forwardTime(i), cursor);
+            g_Sink = bone.GetLocalTransform()[3][0];
+        }));
+
+        cursor = {};
+        Report("cursor, random seek (binary search)", Measure(kSamples, [&](int i) {
+            bone.Update(seekTimes[i], cursor);
+            g_Sink = bone.GetLocalTransform()[3][0];
+        }));
+
+        RunBatchSamplingBenchmarks();
+    }
+
+}
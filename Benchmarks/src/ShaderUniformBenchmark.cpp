@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include "CoffeeEngine/Renderer/RenderState.h"
+#include "CoffeeEngine/Renderer/ShaderReflection.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <string>
+#include <unordered_map>
+
+namespace Coffee::Bench {
+
+    static constexpr int kDraws = 10000;
+    static constexpr int kIterations = 50;
+    static constexpr uint32_t kProgram = 1;
+
+    // The uniforms of StandardShader, in the order the driver would report them
+    static const char* const kStandardUniforms[] = {
+        "model", "normalMatrix", "entityID", "showNormals",
+        "boneOffset", "boneInfluences", "nextBoneOffset", "boneLerp",
+        "material.albedoMap", "material.normalMap", "material.metallicMap", "material.roughnessMap", "material.aoMap", "material.emissiveMap",
+        "material.color", "material.metallic", "material.roughness", "material.ao", "material.emissive",
+        "material.hasAlbedo", "material.hasNormal", "material.hasMetallic", "material.hasRoughness", "material.hasAO", "material.hasEmissive",
+    };
+
+    // The uniforms EndScene and Material::Use set on every draw
+    static const char* const kPerDrawUniforms[] = {
+        "model", "normalMatrix", "showNormals", "boneOffset", "entityID",
+        "material.color", "material.metallic", "material.roughness", "material.ao", "material.emissive",
+        "material.hasAlbedo", "material.hasNormal", "material.hasMetallic", "material.hasRoughness", "material.hasAO", "material.hasEmissive",
+    };
+
+    void RunShaderUniformBenchmarks()
+    {
+        BeginSuite("shader_uniforms");
+
+        ShaderReflection reflection;
+        std::unordered_map<std::string, int32_t> driverLocations;
+        int32_t location = 0;
+        for (const char* name : kStandardUniforms)
+        {
+            reflection.AddUniform({name, location, 0, 1});
+            driverLocations[name] = location++;
+        }
+        reflection.Finalize();
+
+        std::printf("Per-draw uniforms, %d draws of %zu uniforms, no graphics context\n", kDraws, std::size(kPerDrawUniforms));
+
+        // Before reflection every setter built a std::string and the driver hashed it, a string keyed map is the cheapest such lookup
+        Report("std::string + driver-like lookup, per draw", Measure(kIterations, [&](int) {
+            int32_t sum = 0;
+            for (int draw = 0; draw < kDraws; draw++)
+            {
+                for (const char* name : kPerDrawUniforms)
+                    sum += driverLocations.find(std::string(name))->second;
+            }
+            g_Sink = static_cast<float>(sum);
+        }) / kDraws);
+
+        Report("reflection table by name, per draw", Measure(kIterations, [&](int) {
+            int32_t sum = 0;
+            for (int draw = 0; draw < kDraws; draw++)
+            {
+                for (const char* name : kPerDrawUniforms)
+                    sum += reflection.FindLocation(name);
+            }
+            g_Sink = static_cast<float>(sum);
+        }) / kDraws);
+
+        // The handles are resolved once, what is left per draw is comparing the values with the uniform cache
+        int32_t handles[std::size(kPerDrawUniforms)];
+        for (size_t i = 0; i < std::size(kPerDrawUniforms); i++)
+            handles[i] = reflection.FindLocation(kPerDrawUniforms[i]);
+
+        glm::vec4 material(0.8f, 0.2f, 0.5f, 1.0f);
+        int flag = 1;
+        Report("precomputed handles + uniform cache, per draw", Measure(kIterations, [&](int) {
+            uint32_t uploads = 0;
+            for (int draw = 0; draw < kDraws; draw++)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(draw), 0.0f, 0.0f));
+                glm::mat3 normalMatrix(model);
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[0], &model, sizeof(model));
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[1], &normalMatrix, sizeof(normalMatrix));
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[2], &flag, sizeof(flag));
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[3], &flag, sizeof(flag));
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[4], &model[3], sizeof(glm::vec3));
+                uploads += RenderState::ShouldUploadUniform(kProgram, handles[5], &material, sizeof(material));
+                for (size_t i = 6; i < std::size(kPerDrawUniforms); i++)
+                    uploads += RenderState::ShouldUploadUniform(kProgram, handles[i], &flag, sizeof(flag));
+            }
+            g_Sink = static_cast<float>(uploads);
+        }) / kDraws);
+
+        const RenderStateStats& stats = RenderState::GetStats();
+        std::printf("%-48s %12u / %u\n", "uniform uploads issued / elided", stats.IssuedUniforms, stats.ElidedUniforms);
+        RenderState::ResetStats();
+    }
+
+}
@@ -0,0 +1,200 @@
+#include "Benchmark.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Animation/Skinning.h"
+#include "CoffeeEngine/Core/ThreadPool.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/MorphTargets.h"
+#include "CoffeeEngine/Renderer/SkinData.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Coffee::Bench {
+
+    static constexpr int kVertexCount = 100000;
+    static constexpr int kBoneCount = 100;
+    static constexpr int kIterations = 50;
+
+    // Vertices with one to four influences, as imported from a character rig.
+    static std::vector<Vertex> CreateSkinnedVertices(std::mt19937& rng, SkinData& skin)
+    {
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_int_distribution<uint32_t> bone(0, kBoneCount - 1);
+        std::uniform_int_distribution<int> influenceCount(1, 4);
+
+        std::vector<Vertex> vertices(kVertexCount);
+        std::vector<VertexInfluences> influences(kVertexCount);
+        for (int v = 0; v < kVertexCount; v++)
+        {
+            Vertex& vertex = vertices[v];
+            vertex.Position = glm::vec3(position(rng), position(rng), position(rng));
+            vertex.Normals = glm::normalize(glm::vec3(position(rng), position(rng), position(rng)) + glm::vec3(0.0f, 0.0f, 2.0f));
+
+            int count = influenceCount(rng);
+            for (int i = 0; i < count; i++)
+                influences[v].Add(bone(rng), 0.1f + std::abs(position(rng)));
+        }
+
+        skin = SkinData::Build(influences);
+        return vertices;
+    }
+
+    static std::vector<glm::mat4> CreatePalette(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+        std::vector<glm::mat4> palette(kBoneCount);
+        for (glm::mat4& matrix : palette)
+        {
+            glm::quat rotation = glm::normalize(glm::quat(value(rng), value(rng), value(rng), value(rng)));
+            matrix = glm::translate(glm::mat4(1.0f), glm::vec3(value(rng), value(rng), value(rng))) * glm::toMat4(rotation);
+        }
+        return palette;
+    }
+
+    static constexpr int kMorphTargetCount = 48;
+    static constexpr int kMorphVerticesPerTarget = 1500;
+    static constexpr int kActiveMorphTargets = 8;
+
+    // Blend shapes moving small regions of the first fifth of the mesh, like the face of a character
+    static std::vector<MorphTargetDeltas> CreateMorphTargets(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> offset(-0.02f, 0.02f);
+        std::uniform_int_distribution<int> regionStart(0, kVertexCount / 5 - kMorphVerticesPerTarget * 2);
+
+        std::vector<MorphTargetDeltas> targets(kMorphTargetCount);
+        for (int t = 0; t < kMorphTargetCount; t++)
+        {
+            MorphTargetDeltas& target = targets[t];
+            target.name = "Target" + std::to_string(t);
+            target.positions.assign(kVertexCount, glm::vec3(0.0f));
+            target.normals.assign(kVertexCount, glm::vec3(0.0f));
+
+            // Every other vertex of the region, the vertices of a face are interleaved with its neighbours in the buffer
+            int start = regionStart(rng);
+            for (int i = 0; i < kMorphVerticesPerTarget; i++)
+            {
+                int v = start + i * 2;
+                target.positions[v] = glm::vec3(offset(rng), offset(rng), offset(rng));
+                target.normals[v] = glm::vec3(offset(rng), offset(rng), offset(rng)) * 10.0f;
+            }
+        }
+        return targets;
+    }
+
+    static void RunMorphTargetBenchmarks(std::mt19937& rng, const std::vector<Vertex>& vertices)
+    {
+        std::vector<MorphTargetDeltas> targets = CreateMorphTargets(rng);
+        MorphTargetData morphTargets = MorphTargetData::Build("Face", targets);
+
+        std::vector<float> weights(kMorphTargetCount, 0.0f);
+        for (int t = 0; t < kActiveMorphTargets; t++)
+            weights[t * (kMorphTargetCount / kActiveMorphTargets)] = 0.25f + 0.1f * t;
+
+        size_t denseBytes = static_cast<size_t>(kMorphTargetCount) * kVertexCount * 2 * sizeof(glm::vec3);
+        std::printf("Morph targets, %d targets of %d vertices, %d active: %zu KB sparse, %zu KB dense\n",
+                    kMorphTargetCount, kMorphVerticesPerTarget, kActiveMorphTargets, morphTargets.GetMemorySize() / 1024, denseBytes / 1024);
+
+        // The naive evaluation: every active target walks every vertex of the mesh
+        std::vector<Vertex> dense = vertices;
+        Report("morph targets, dense, per frame", Measure(kIterations, [&](int) {
+            dense = vertices;
+            for (int t = 0; t < kMorphTargetCount; t++)
+            {
+                if (!MorphTargetData::IsActive(weights[t], 1.0e-3f))
+                    continue;
+                for (int v = 0; v < kVertexCount; v++)
+                {
+                    dense[v].Position += targets[t].positions[v] * weights[t];
+                    dense[v].Normals += targets[t].normals[v] * weights[t];
+                }
+            }
+            g_Sink = dense[0].Position.x;
+        }));
+
+        // Restoring the touched vertices is part of the frame, as in MorphedMesh::Update
+        std::vector<Vertex> sparse = vertices;
+        auto restore = [&]() {
+            morphTargets.ForEachTouchedBlock(weights.data(), 1.0e-3f, [&](const uint32_t* indices, uint32_t count) {
+                for (uint32_t i = 0; i < count; i++)
+                    sparse[indices[i]] = vertices[indices[i]];
+            });
+        };
+
+        Report("morph targets, sparse scalar reference, per frame", Measure(kIterations, [&](int) {
+            restore();
+            morphTargets.AccumulateReference(weights.data(), 1.0e-3f, sparse.data());
+            g_Sink = sparse[0].Position.x;
+        }));
+
+        Report("morph targets, sparse simd, per frame", Measure(kIterations, [&](int) {
+            restore();
+            morphTargets.Accumulate(weights.data(), 1.0e-3f, sparse.data());
+            g_Sink = sparse[0].Position.x;
+        }));
+
+        float maxPositionError = 0.0f;
+        float maxNormalError = 0.0f;
+        for (int v = 0; v < kVertexCount; v++)
+        {
+            maxPositionError = std::max(maxPositionError, glm::length(sparse[v].Position - dense[v].Position));
+            maxNormalError = std::max(maxNormalError, glm::length(sparse[v].Normals - dense[v].Normals));
+        }
+        std::printf("%-48s %12g / %g\n", "sparse max error (position / normal)", maxPositionError, maxNormalError);
+    }
+
+    void RunSkinningBenchmarks()
+    {
+        BeginSuite("skinning");
+
+        std::mt19937 rng(1234);
+        SkinData skin;
+        std::vector<Vertex> vertices = CreateSkinnedVertices(rng, skin);
+        std::vector<glm::mat4> palette = CreatePalette(rng);
+
+        std::vector<glm::vec3> referencePositions(kVertexCount), referenceNormals(kVertexCount);
+        std::vector<glm::vec3> positions(kVertexCount), normals(kVertexCount);
+
+        std::printf("CPU skinning, %d vertices, %d bones, %u skin bytes per vertex\n", kVertexCount, kBoneCount, skin.GetStride());
+
+        double reference = Measure(kIterations, [&](int) {
+            SkinVerticesReference(vertices.data(), skin, 0, kVertexCount, palette.data(), kBoneCount, referencePositions.data(), referenceNormals.data());
+            g_Sink = referencePositions[0].x;
+        });
+        Report("scalar reference, per vertex", reference / kVertexCount);
+
+        double simd = Measure(kIterations, [&](int) {
+            SkinVertices(vertices.data(), skin, 0, kVertexCount, palette.data(), kBoneCount, positions.data(), normals.data());
+            g_Sink = positions[0].x;
+        });
+        Report("simd, per vertex", simd / kVertexCount);
+
+        float maxPositionError = 0.0f;
+        float maxNormalError = 0.0f;
+        for (int i = 0; i < kVertexCount; i++)
+        {
+            maxPositionError = std::max(maxPositionError, glm::length(positions[i] - referencePositions[i]));
+            maxNormalError = std::max(maxNormalError, glm::length(normals[i] - referenceNormals[i]));
+        }
+        std::printf("%-48s %12g / %g\n", "simd max error (position / normal)", maxPositionError, maxNormalError);
+
+        ThreadPool::Init();
+        Report("simd, thread pool, per vertex", Measure(kIterations, [&](int) {
+            SkinVerticesParallel(vertices.data(), skin, kVertexCount, palette.data(), kBoneCount, positions.data(), normals.data());
+            g_Sink = positions[0].x;
+        }) / kVertexCount);
+        std::printf("%-48s %12u\n", "thread pool workers", ThreadPool::GetWorkerCount());
+        ThreadPool::Shutdown();
+
+        RunMorphTargetBenchmarks(rng, vertices);
+    }
+
+}
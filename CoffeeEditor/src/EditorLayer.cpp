@@ -1,5 +1,6 @@
 #include "EditorLayer.h"
 
+#include "CoffeeEngine/Animation/AnimationSystem.h"
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Assert.h"
 #include "CoffeeEngine/Core/Base.h"
@@ -15,6 +16,7 @@
 #include "CoffeeEngine/Project/Project.h"
 #include "CoffeeEngine/Renderer/DebugRenderer.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 #include "CoffeeEngine/Renderer/Renderer.h"
 #include "CoffeeEngine/Scene/Components.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
@@ -394,15 +396,24 @@ namespace Coffee {
         //transparent overlay displaying fps draw calls etc
         ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | /*ImGuiWindowFlags_AlwaysAutoResize |*/ ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
 
-        ImGui::SetNextWindowPos(ImVec2(ImGui::GetWindowPos().x + ImGui::GetWindowSize().x - 205, ImGui::GetWindowPos().y + ImGui::GetWindowSize().y - 100));
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetWindowPos().x + ImGui::GetWindowSize().x - 205, ImGui::GetWindowPos().y + ImGui::GetWindowSize().y - 140));
 
         ImGui::SetNextWindowBgAlpha(0.35f); // Transparent background
 
         ImGui::Begin("Renderer Stats", NULL, window_flags);
         ImGui::Text("Size: %.0f x %.0f (%0.1fMP)", m_ViewportSize.x, m_ViewportSize.y, m_ViewportSize.x * m_ViewportSize.y / 1000000.0f);
         ImGui::Text("Draw Calls: %d", Renderer::GetStats().DrawCalls);
+        ImGui::Text("Instanced: %d", Renderer::GetStats().InstanceCount);
+        ImGui::Text("Indirect Draws: %d", Renderer::GetStats().IndirectDrawCount);
         ImGui::Text("Vertex Count: %d", Renderer::GetStats().VertexCount);
         ImGui::Text("Index Count: %d", Renderer::GetStats().IndexCount);
+        ImGui::Text("State Changes: %d shaders, %d materials, %d meshes", Renderer::GetStats().ShaderChanges, Renderer::GetStats().MaterialChanges, Renderer::GetStats().MeshChanges);
+        ImGui::Text("Queue Sort: %.3f ms", Renderer::GetStats().SortTime);
+        ImGui::Text("GL Binds: %d issued, %d elided", RenderState::GetStats().IssuedBinds, RenderState::GetStats().ElidedBinds);
+        ImGui::Text("GL Uniforms: %d issued, %d elided", RenderState::GetStats().IssuedUniforms, RenderState::GetStats().ElidedUniforms);
+        const auto& animationStats = AnimationSystem::GetLODStats();
+        ImGui::Text("Anim LODs: %d/%d/%d/%d", animationStats[0].population, animationStats[1].population, animationStats[2].population, animationStats[3].population);
+        ImGui::Text("Pose Cache Hits: %.0f%%", AnimationSystem::GetPoseCache().GetStats().GetHitRate() * 100.0f);
         ImGui::End();
 
         // Display EditorCamera speed vertical slider & zoom vertical slider at the center left
@@ -476,6 +487,7 @@ namespace Coffee {
         ImGui::Begin("Render Settings");
 
         ImGui::Checkbox("Post Processing", &Renderer::GetRenderSettings().PostProcessing);
+        ImGui::Checkbox("Multi-Draw Indirect", &Renderer::GetRenderSettings().MultiDrawIndirect);
 
         ImGui::DragFloat("Exposure", &Renderer::GetRenderSettings().Exposure, 0.001f, 100.0f);
 
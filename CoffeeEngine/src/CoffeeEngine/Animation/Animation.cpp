@@ -0,0 +1,57 @@
+#include "CoffeeEngine/Animation/Animation.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    Animation::Animation(std::string name, float duration, int ticksPerSecond, std::vector<Bone> bones, const Ref<Skeleton>& skeleton)
+        : m_Name(std::move(name)), m_Duration(duration), m_TicksPerSecond(ticksPerSecond), m_Bones(std::move(bones))
+    {
+        SetSkeleton(skeleton);
+    }
+
+    void Animation::SetSkeleton(const Ref<Skeleton>& skeleton)
+    {
+        ZoneScoped;
+
+        m_Skeleton = skeleton;
+
+        m_ChannelNodes.resize(m_Bones.size());
+        for (size_t i = 0; i < m_Bones.size(); i++)
+        {
+            m_ChannelNodes[i] = m_Skeleton->FindNode(m_Bones[i].GetBoneName());
+        }
+
+        BuildNodeChannels();
+    }
+
+    void Animation::BuildNodeChannels()
+    {
+        m_NodeChannels.assign(m_Skeleton ? m_Skeleton->GetNodes().size() : 0, -1);
+        for (int i = 0; i < static_cast<int>(m_ChannelNodes.size()); i++)
+        {
+            int node = m_ChannelNodes[i];
+            if (node >= 0 && node < static_cast<int>(m_NodeChannels.size()))
+                m_NodeChannels[node] = i;
+        }
+    }
+
+    const MorphChannel* Animation::FindMorphChannel(const std::string& name) const
+    {
+        auto it = std::find_if(m_MorphChannels.begin(), m_MorphChannels.end(), [&](const MorphChannel& channel) { return channel.GetName() == name; });
+        return it != m_MorphChannels.end() ? &(*it) : nullptr;
+    }
+
+    const AnimationCompressionStats& Animation::Compress(const AnimationCompressionSettings& settings)
+    {
+        ZoneScoped;
+
+        m_CompressionStats = {};
+        for (Bone& bone : m_Bones)
+        {
+            m_CompressionStats.Merge(bone.Compress(settings));
+        }
+        return m_CompressionStats;
+    }
+
+}
@@ -4,39 +4,48 @@
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include <cereal/access.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <string>
 #include <vector>
-#include <map>
 #include <algorithm>
 #include <cassert>
 
-#include"CoffeeEngine/Renderer/Model.h"
+#include "CoffeeEngine/Animation/AnimationCompression.h"
 #include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/MorphChannel.h"
+#include "CoffeeEngine/Animation/Skeleton.h"
 
 
 namespace Coffee {
-     struct BoneInfo;
-
-    struct AssimpNodeData
-    {
-        glm::mat4 transformation;
-        std::string name;
-        int childrenCount;
-        std::vector<AssimpNodeData> children;
-    };
 
+    /**
+     * @brief A clip: the channels of the animated nodes of a Skeleton.
+     *
+     * The hierarchy, bind pose and offsets live in the Skeleton, which is shared by every clip
+     * of the rig. A clip only stores the node driven by each channel.
+     */
     class Animation
     {
     public:
         Animation() = default;
 
+        /**
+         * @brief Builds a clip from its channels, for procedural or synthetic clips.
+         * @param name The name of the clip.
+         * @param duration The duration in ticks.
+         * @param ticksPerSecond The playback rate of the ticks.
+         * @param bones The channels, matched to the nodes of the skeleton by name.
+         * @param skeleton The skeleton the clip animates.
+         */
+        Animation(std::string name, float duration, int ticksPerSecond, std::vector<Bone> bones, const Ref<Skeleton>& skeleton);
+
         Bone* FindBone(const std::string& name)
         {
             auto iter = std::find_if(m_Bones.begin(), m_Bones.end(),
@@ -44,19 +53,108 @@ namespace Coffee {
             return iter != m_Bones.end() ? &(*iter) : nullptr;
         }
 
+        const std::string& GetName() const { return m_Name; }
+        const std::vector<Bone>& GetBones() const { return m_Bones; }
         float GetTicksPerSecond() const { return m_TicksPerSecond; }
         float GetDuration() const { return m_Duration; }
-        const AssimpNodeData& GetRootNode() const { return m_RootNode; }
-        const std::map<std::string, BoneInfo>& GetBoneIDMap() const { return m_BoneInfoMap; }
+
+        /**
+         * @brief Gets the skeleton the clip animates.
+         */
+        const Ref<Skeleton>& GetSkeleton() const { return m_Skeleton; }
+
+        /**
+         * @brief Gets the flattened hierarchy of the skeleton.
+         * @return The nodes in topological order.
+         */
+        const std::vector<AnimationNode>& GetNodes() const { return m_Skeleton->GetNodes(); }
+
+        /**
+         * @brief Gets the channel driving every node.
+         * @return The index in GetBones() of the channel of every node, -1 for the nodes without one.
+         */
+        const std::vector<int>& GetNodeChannels() const { return m_NodeChannels; }
+
+        /**
+         * @brief Gets the blend shape weights animated by the clip, one channel per morphed mesh.
+         */
+        const std::vector<MorphChannel>& GetMorphChannels() const { return m_MorphChannels; }
+
+        /**
+         * @brief Finds the morph channel of a mesh.
+         * @param name The channel name of the mesh, see MorphTargetData::GetChannelName.
+         * @return The channel, or nullptr if the clip does not animate the mesh.
+         */
+        const MorphChannel* FindMorphChannel(const std::string& name) const;
+
+        /**
+         * @brief Adds the blend shape weights of a mesh, for procedural or synthetic clips.
+         * @param channel The channel.
+         */
+        void AddMorphChannel(MorphChannel channel) { m_MorphChannels.push_back(std::move(channel)); }
+
+        /**
+         * @brief Gets the number of final bone matrices written by this animation.
+         * @return The highest bone index plus one.
+         */
+        int GetBoneCount() const { return m_Skeleton->GetBoneCount(); }
+
+        /**
+         * @brief Compresses the keys of every channel.
+         * @param settings The error tolerances.
+         * @return The memory and error report of the whole clip.
+         */
+        const AnimationCompressionStats& Compress(const AnimationCompressionSettings& settings);
+
+        /**
+         * @brief Gets the report of the last compression.
+         * @return The memory and error report, empty if the clip is not compressed.
+         */
+        const AnimationCompressionStats& GetCompressionStats() const { return m_CompressionStats; }
 
     private:
+        /**
+         * @brief Resolves the node of every channel by name, channels of nodes missing from the skeleton are ignored.
+         * @param skeleton The skeleton the clip animates.
+         */
+        void SetSkeleton(const Ref<Skeleton>& skeleton);
 
+        /**
+         * @brief Builds the channel of every node from the node of every channel.
+         */
+        void BuildNodeChannels();
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void save(Archive& archive) const
+        {
+            archive(m_Name, m_Duration, m_TicksPerSecond, m_Bones, m_Skeleton, m_ChannelNodes, m_MorphChannels, m_CompressionStats);
+        }
+
+        template<class Archive>
+        void load(Archive& archive)
+        {
+            archive(m_Name, m_Duration, m_TicksPerSecond, m_Bones, m_Skeleton, m_ChannelNodes, m_MorphChannels, m_CompressionStats);
+            BuildNodeChannels();
+        }
+
+    private:
+
+        std::string m_Name;
         float m_Duration = 0.0f;
         int m_TicksPerSecond = 0;
         std::vector<Bone> m_Bones;
-        AssimpNodeData m_RootNode;
-        std::map<std::string, BoneInfo> m_BoneInfoMap;
+
+        Ref<Skeleton> m_Skeleton; ///< The skeleton the clip animates, shared by the clips of the rig.
+        std::vector<int> m_ChannelNodes; ///< The node driven by every channel, -1 if the skeleton has no such node.
+        std::vector<int> m_NodeChannels; ///< The channel of every node, see GetNodeChannels.
+        std::vector<MorphChannel> m_MorphChannels; ///< The blend shape weights of the morphed meshes.
+
+        AnimationCompressionStats m_CompressionStats;
 
         friend class Model;
+        friend class AnimationLibrary;
     };
 }
\ No newline at end of file
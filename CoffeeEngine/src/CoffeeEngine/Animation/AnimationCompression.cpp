@@ -0,0 +1,156 @@
+#include "CoffeeEngine/Animation/AnimationCompression.h"
+
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    /**
+     * @brief Greedy key reduction.
+     *
+     * Extends a segment from the last kept key as long as every key inside it can be rebuilt
+     * by interpolating the segment ends within the tolerance.
+     *
+     * @return The indices of the keys to keep, always including the first and last ones.
+     */
+    template<typename T, typename Interpolate, typename Error>
+    static std::vector<int> ReduceKeys(const std::vector<float>& times, const std::vector<T>& values, float tolerance, Interpolate interpolate, Error error)
+    {
+        std::vector<int> kept;
+        const int count = static_cast<int>(values.size());
+        if (count == 0)
+            return kept;
+
+        kept.push_back(0);
+
+        bool constant = true;
+        for (int i = 1; i < count && constant; i++)
+        {
+            constant = error(values[i], values[0]) <= tolerance;
+        }
+        if (constant)
+            return kept;
+
+        int start = 0;
+        for (int end = 2; end < count; end++)
+        {
+            const float span = times[end] - times[start];
+            bool fits = span > 0.0f;
+            for (int i = start + 1; i < end && fits; i++)
+            {
+                float factor = (times[i] - times[start]) / span;
+                fits = error(interpolate(values[start], values[end], factor), values[i]) <= tolerance;
+            }
+
+            if (!fits)
+            {
+                kept.push_back(end - 1);
+                start = end - 1;
+            }
+        }
+
+        kept.push_back(count - 1);
+        return kept;
+    }
+
+    static uint16_t QuantizeUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    CompressedVec3Track CompressedVec3Track::Compress(const std::vector<float>& times, const std::vector<glm::vec3>& source, float tolerance)
+    {
+        ZoneScoped;
+
+        CompressedVec3Track track;
+
+        std::vector<int> kept = ReduceKeys(times, source, tolerance,
+            [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); },
+            [](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); });
+
+        if (kept.empty())
+            return track;
+
+        glm::vec3 rangeMax = source[kept[0]];
+        track.rangeMin = source[kept[0]];
+        for (int index : kept)
+        {
+            track.rangeMin = glm::min(track.rangeMin, source[index]);
+            rangeMax = glm::max(rangeMax, source[index]);
+        }
+        track.rangeExtent = rangeMax - track.rangeMin;
+
+        track.times.reserve(kept.size());
+        track.values.reserve(kept.size() * 3);
+        for (int index : kept)
+        {
+            track.times.push_back(times[index]);
+            for (int c = 0; c < 3; c++)
+            {
+                float normalized = track.rangeExtent[c] > 0.0f ? (source[index][c] - track.rangeMin[c]) / track.rangeExtent[c] : 0.0f;
+                track.values.push_back(QuantizeUnorm16(normalized));
+            }
+        }
+
+        return track;
+    }
+
+    CompressedQuatTrack CompressedQuatTrack::Compress(const std::vector<float>& times, const std::vector<glm::quat>& source, float tolerance)
+    {
+        ZoneScoped;
+
+        CompressedQuatTrack track;
+
+        // Keep consecutive keys in the same hemisphere so interpolation takes the short path
+        std::vector<glm::quat> rotations(source.size());
+        for (size_t i = 0; i < source.size(); i++)
+        {
+            rotations[i] = glm::normalize(source[i]);
+            if (i > 0 && glm::dot(rotations[i - 1], rotations[i]) < 0.0f)
+                rotations[i] = -rotations[i];
+        }
+
+        std::vector<int> kept = ReduceKeys(times, rotations, tolerance,
+            [](const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); },
+            [](const glm::quat& a, const glm::quat& b) { return QuatAngularDistance(a, b); });
+
+        constexpr float range = 0.70710678f;
+
+        track.times.reserve(kept.size());
+        track.values.reserve(kept.size() * 3);
+        for (int index : kept)
+        {
+            const glm::quat& q = rotations[index];
+            const float components[4] = {q.x, q.y, q.z, q.w};
+
+            int largest = 0;
+            for (int i = 1; i < 4; i++)
+            {
+                if (std::abs(components[i]) > std::abs(components[largest]))
+                    largest = i;
+            }
+
+            // q and -q are the same rotation, so the dropped component can always be positive
+            const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+            uint16_t packed[3];
+            int next = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                if (i == largest)
+                    continue;
+                float normalized = (components[i] * sign + range) / (2.0f * range);
+                packed[next++] = static_cast<uint16_t>(std::lround(std::clamp(normalized, 0.0f, 1.0f) * 32767.0f));
+            }
+
+            packed[0] |= static_cast<uint16_t>((largest & 1) << 15);
+            packed[1] |= static_cast<uint16_t>(((largest >> 1) & 1) << 15);
+
+            track.times.push_back(times[index]);
+            track.values.insert(track.values.end(), packed, packed + 3);
+        }
+
+        return track;
+    }
+
+}
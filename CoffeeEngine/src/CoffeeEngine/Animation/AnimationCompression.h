@@ -0,0 +1,179 @@
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup animation Animation
+     * @brief Animation components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Error tolerances used when compressing animation clips at import.
+     *
+     * A key is removed when interpolating its neighbours reproduces it within the tolerance.
+     */
+    struct AnimationCompressionSettings
+    {
+        bool enabled = true; ///< Whether clips are compressed at import.
+        float positionTolerance = 0.0005f; ///< Maximum position error in model units.
+        float rotationTolerance = 0.001f; ///< Maximum rotation error in radians.
+        float scaleTolerance = 0.0005f; ///< Maximum scale error.
+    };
+
+    /**
+     * @brief Memory and accuracy report of a compressed clip.
+     */
+    struct AnimationCompressionStats
+    {
+        size_t rawBytes = 0; ///< Size of the uncompressed keys.
+        size_t compressedBytes = 0; ///< Size of the compressed tracks.
+        uint32_t rawKeys = 0; ///< Number of keys before key reduction.
+        uint32_t compressedKeys = 0; ///< Number of keys after key reduction.
+        float maxPositionError = 0.0f; ///< Maximum position error measured at the original keys.
+        float maxRotationError = 0.0f; ///< Maximum rotation error in radians measured at the original keys.
+        float maxScaleError = 0.0f; ///< Maximum scale error measured at the original keys.
+
+        void Merge(const AnimationCompressionStats& other)
+        {
+            rawBytes += other.rawBytes;
+            compressedBytes += other.compressedBytes;
+            rawKeys += other.rawKeys;
+            compressedKeys += other.compressedKeys;
+            maxPositionError = std::max(maxPositionError, other.maxPositionError);
+            maxRotationError = std::max(maxRotationError, other.maxRotationError);
+            maxScaleError = std::max(maxScaleError, other.maxScaleError);
+        }
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(rawBytes, compressedBytes, rawKeys, compressedKeys, maxPositionError, maxRotationError, maxScaleError);
+        }
+    };
+
+    /**
+     * @brief A vec3 track (position or scale) quantized to 16 bits per component.
+     *
+     * Values are range-reduced: each component is stored relative to the minimum and extent
+     * of the track, so the 16 bits cover only the range the track actually uses.
+     */
+    struct CompressedVec3Track
+    {
+        std::vector<float> times; ///< The timestamps of the kept keys.
+        std::vector<uint16_t> values; ///< Three quantized components per key.
+        glm::vec3 rangeMin = glm::vec3(0.0f); ///< The minimum value of the track.
+        glm::vec3 rangeExtent = glm::vec3(0.0f); ///< The extent (max - min) of the track.
+
+        int GetKeyCount() const { return static_cast<int>(times.size()); }
+
+        glm::vec3 Decode(int key) const
+        {
+            const uint16_t* v = &values[key * 3];
+            return rangeMin + glm::vec3(v[0], v[1], v[2]) * (rangeExtent * (1.0f / 65535.0f));
+        }
+
+        size_t GetMemoryUsage() const
+        {
+            return times.size() * sizeof(float) + values.size() * sizeof(uint16_t) + sizeof(glm::vec3) * 2;
+        }
+
+        /**
+         * @brief Removes redundant keys and quantizes the remaining ones.
+         * @param times The timestamps of the source keys.
+         * @param source The values of the source keys.
+         * @param tolerance The maximum interpolation error allowed when removing keys.
+         * @return The compressed track.
+         */
+        static CompressedVec3Track Compress(const std::vector<float>& times, const std::vector<glm::vec3>& source, float tolerance);
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(times, values, rangeMin, rangeExtent);
+        }
+    };
+
+    /**
+     * @brief A rotation track stored with smallest-three quantization (48 bits per key).
+     *
+     * The largest component of the unit quaternion is dropped and rebuilt from the other three,
+     * which are stored with 15 bits each. The index of the dropped component uses the
+     * two remaining bits.
+     */
+    struct CompressedQuatTrack
+    {
+        std::vector<float> times; ///< The timestamps of the kept keys.
+        std::vector<uint16_t> values; ///< Three packed words per key.
+
+        int GetKeyCount() const { return static_cast<int>(times.size()); }
+
+        glm::quat Decode(int key) const
+        {
+            constexpr float range = 0.70710678f; // The three smallest components are within [-1/sqrt(2), 1/sqrt(2)]
+            constexpr float scale = (2.0f * range) / 32767.0f;
+
+            const uint16_t* v = &values[key * 3];
+            const int largest = ((v[0] >> 15) & 1) | (((v[1] >> 15) & 1) << 1);
+
+            float a = (v[0] & 0x7FFF) * scale - range;
+            float b = (v[1] & 0x7FFF) * scale - range;
+            float c = (v[2] & 0x7FFF) * scale - range;
+            float d = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+
+            // Components are stored in x, y, z, w order with the largest one removed
+            float components[4];
+            int next = 0;
+            const float smallest[3] = {a, b, c};
+            for (int i = 0; i < 4; i++)
+            {
+                components[i] = (i == largest) ? d : smallest[next++];
+            }
+            return glm::quat(components[3], components[0], components[1], components[2]);
+        }
+
+        size_t GetMemoryUsage() const
+        {
+            return times.size() * sizeof(float) + values.size() * sizeof(uint16_t);
+        }
+
+        /**
+         * @brief Removes redundant keys and quantizes the remaining ones.
+         * @param times The timestamps of the source keys.
+         * @param source The rotations of the source keys.
+         * @param tolerance The maximum angular error in radians allowed when removing keys.
+         * @return The compressed track.
+         */
+        static CompressedQuatTrack Compress(const std::vector<float>& times, const std::vector<glm::quat>& source, float tolerance);
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(times, values);
+        }
+    };
+
+    /**
+     * @brief Returns the angle in radians between two rotations.
+     */
+    inline float QuatAngularDistance(const glm::quat& a, const glm::quat& b)
+    {
+        float d = std::min(1.0f, std::abs(glm::dot(glm::normalize(a), glm::normalize(b))));
+        return 2.0f * std::acos(d);
+    }
+
+    /** @} */
+}
@@ -0,0 +1,110 @@
+#include "CoffeeEngine/Animation/AnimationGraph.h"
+#include "CoffeeEngine/Animation/AnimationLibrary.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceLoader.h"
+
+#include <algorithm>
+
+namespace Coffee {
+
+    Ref<AnimationGraph> AnimationGraph::Create(const std::string& name)
+    {
+        return ResourceLoader::LoadAnimationGraph(name);
+    }
+
+    uint32_t AnimationGraph::AddParameter(const std::string& name, float defaultValue)
+    {
+        m_Parameters.push_back({name, defaultValue});
+        return static_cast<uint32_t>(m_Parameters.size() - 1);
+    }
+
+    uint32_t AnimationGraph::AddClip(UUID library, const std::string& clip)
+    {
+        m_Clips.push_back({library, clip});
+        m_ResolvedClips.clear();
+        return static_cast<uint32_t>(m_Clips.size() - 1);
+    }
+
+    uint32_t AnimationGraph::AddClipState(const std::string& name, uint32_t clip, bool loop, float speed)
+    {
+        AnimationGraphState state;
+        state.name = name;
+        state.type = AnimationStateType::Clip;
+        state.clip = clip;
+        state.loop = loop;
+        state.speed = speed;
+        m_States.push_back(std::move(state));
+        return static_cast<uint32_t>(m_States.size() - 1);
+    }
+
+    uint32_t AnimationGraph::AddBlendSpace1D(const std::string& name, uint32_t parameter, std::vector<BlendSpaceSample> samples)
+    {
+        std::sort(samples.begin(), samples.end(), [](const BlendSpaceSample& a, const BlendSpaceSample& b) {
+            return a.position.x < b.position.x;
+        });
+
+        AnimationGraphState state;
+        state.name = name;
+        state.type = AnimationStateType::BlendSpace1D;
+        state.samples = std::move(samples);
+        state.parameterX = static_cast<int>(parameter);
+        m_States.push_back(std::move(state));
+        return static_cast<uint32_t>(m_States.size() - 1);
+    }
+
+    uint32_t AnimationGraph::AddBlendSpace2D(const std::string& name, uint32_t parameterX, uint32_t parameterY, std::vector<BlendSpaceSample> samples)
+    {
+        AnimationGraphState state;
+        state.name = name;
+        state.type = AnimationStateType::BlendSpace2D;
+        state.samples = std::move(samples);
+        state.parameterX = static_cast<int>(parameterX);
+        state.parameterY = static_cast<int>(parameterY);
+        m_States.push_back(std::move(state));
+        return static_cast<uint32_t>(m_States.size() - 1);
+    }
+
+    int AnimationGraph::FindParameter(const std::string& name) const
+    {
+        for (size_t i = 0; i < m_Parameters.size(); i++)
+        {
+            if (m_Parameters[i].name == name)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    int AnimationGraph::FindState(const std::string& name) const
+    {
+        for (size_t i = 0; i < m_States.size(); i++)
+        {
+            if (m_States[i].name == name)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    const std::vector<Ref<Animation>>& AnimationGraph::ResolveClips()
+    {
+        if (m_ResolvedClips.size() == m_Clips.size())
+            return m_ResolvedClips;
+
+        m_ResolvedClips.clear();
+        m_ResolvedClips.reserve(m_Clips.size());
+
+        for (const AnimationClipReference& reference : m_Clips)
+        {
+            Ref<Animation> clip;
+            if (Ref<AnimationLibrary> library = ResourceLoader::LoadAnimationLibrary(reference.library))
+                clip = library->GetAnimation(reference.clip);
+
+            if (!clip)
+                COFFEE_CORE_ERROR("AnimationGraph::ResolveClips: Clip {0} of graph {1} not found", reference.clip, m_Name);
+
+            m_ResolvedClips.push_back(clip);
+        }
+
+        return m_ResolvedClips;
+    }
+
+}
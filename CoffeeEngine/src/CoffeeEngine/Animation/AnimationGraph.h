@@ -0,0 +1,219 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/UUID.h"
+#include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include "CoffeeEngine/Animation/Animation.h"
+
+#include <glm/glm.hpp>
+#include <cereal/access.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief A clip used by an animation graph, referenced by its library and its name.
+     */
+    struct AnimationClipReference
+    {
+        UUID library = UUID::null; ///< The UUID of the AnimationLibrary holding the clip.
+        std::string clip; ///< The name of the clip in the library.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(CEREAL_NVP(library), CEREAL_NVP(clip));
+        }
+    };
+
+    /**
+     * @brief A named float input of an animation graph.
+     */
+    struct AnimationGraphParameter
+    {
+        std::string name;
+        float defaultValue = 0.0f;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(CEREAL_NVP(name), CEREAL_NVP(defaultValue));
+        }
+    };
+
+    /**
+     * @brief A clip placed in a blend space.
+     */
+    struct BlendSpaceSample
+    {
+        uint32_t clip = 0; ///< The index of the clip in the graph.
+        glm::vec2 position = glm::vec2(0.0f); ///< The position of the clip. 1D blend spaces only use x.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(CEREAL_NVP(clip), CEREAL_NVP(position));
+        }
+    };
+
+    enum class AnimationStateType
+    {
+        Clip, ///< Plays a single clip.
+        BlendSpace1D, ///< Blends the two clips around the value of one parameter.
+        BlendSpace2D, ///< Blends the clips around the value of two parameters.
+    };
+
+    /**
+     * @brief A state of an animation graph.
+     */
+    struct AnimationGraphState
+    {
+        std::string name;
+        AnimationStateType type = AnimationStateType::Clip;
+        uint32_t clip = 0; ///< The clip of a Clip state.
+        std::vector<BlendSpaceSample> samples; ///< The clips of a blend space. 1D samples are sorted by x.
+        int parameterX = -1; ///< The parameter driving the x axis of a blend space.
+        int parameterY = -1; ///< The parameter driving the y axis of a 2D blend space.
+        float speed = 1.0f; ///< The playback speed multiplier.
+        bool loop = true; ///< Whether the state loops or holds its last frame.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            int typeInt = static_cast<int>(type);
+            archive(CEREAL_NVP(name), cereal::make_nvp("type", typeInt), CEREAL_NVP(clip), CEREAL_NVP(samples),
+                    CEREAL_NVP(parameterX), CEREAL_NVP(parameterY), CEREAL_NVP(speed), CEREAL_NVP(loop));
+            type = static_cast<AnimationStateType>(typeInt);
+        }
+    };
+
+    enum class AnimationConditionMode
+    {
+        Always, ///< The transition only depends on the exit time.
+        Greater, ///< The parameter is greater than the threshold.
+        Less, ///< The parameter is less than the threshold.
+        Equals, ///< The parameter is equal to the threshold.
+        NotEquals, ///< The parameter is not equal to the threshold.
+    };
+
+    /**
+     * @brief A transition between two states of an animation graph.
+     */
+    struct AnimationGraphTransition
+    {
+        int from = -1; ///< The source state, or -1 to allow the transition from any state.
+        uint32_t to = 0; ///< The destination state.
+        float duration = 0.2f; ///< The duration of the crossfade in seconds.
+        float exitTime = -1.0f; ///< The normalized time the source must reach, or a negative value to ignore it.
+        int parameter = -1; ///< The parameter of the condition.
+        AnimationConditionMode mode = AnimationConditionMode::Always;
+        float threshold = 0.0f; ///< The value the parameter is compared against.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            int modeInt = static_cast<int>(mode);
+            archive(CEREAL_NVP(from), CEREAL_NVP(to), CEREAL_NVP(duration), CEREAL_NVP(exitTime),
+                    CEREAL_NVP(parameter), cereal::make_nvp("mode", modeInt), CEREAL_NVP(threshold));
+            mode = static_cast<AnimationConditionMode>(modeInt);
+        }
+    };
+
+    /**
+     * @brief Resource describing the animation logic of a character: states, transitions and blend spaces.
+     *
+     * The graph is shared between characters, the per-character state lives in AnimationGraphInstance.
+     */
+    class AnimationGraph : public Resource
+    {
+    public:
+        AnimationGraph() : Resource(ResourceType::AnimationGraph) {}
+
+        /**
+         * @brief Creates an empty graph, or loads it if a graph with that name already exists.
+         * @param name The name of the graph.
+         * @return The graph.
+         */
+        static Ref<AnimationGraph> Create(const std::string& name);
+
+        uint32_t AddParameter(const std::string& name, float defaultValue = 0.0f);
+        uint32_t AddClip(UUID library, const std::string& clip);
+        uint32_t AddClipState(const std::string& name, uint32_t clip, bool loop = true, float speed = 1.0f);
+        uint32_t AddBlendSpace1D(const std::string& name, uint32_t parameter, std::vector<BlendSpaceSample> samples);
+        uint32_t AddBlendSpace2D(const std::string& name, uint32_t parameterX, uint32_t parameterY, std::vector<BlendSpaceSample> samples);
+        void AddTransition(const AnimationGraphTransition& transition) { m_Transitions.push_back(transition); }
+
+        void SetEntryState(uint32_t state) { m_EntryState = state; }
+        void SetWeightThreshold(float threshold) { m_WeightThreshold = threshold; }
+
+        /**
+         * @brief Finds a parameter by name.
+         * @return The index of the parameter, or -1 if there is no parameter with that name.
+         */
+        int FindParameter(const std::string& name) const;
+
+        /**
+         * @brief Finds a state by name.
+         * @return The index of the state, or -1 if there is no state with that name.
+         */
+        int FindState(const std::string& name) const;
+
+        const std::vector<AnimationGraphParameter>& GetParameters() const { return m_Parameters; }
+        const std::vector<AnimationClipReference>& GetClips() const { return m_Clips; }
+        const std::vector<AnimationGraphState>& GetStates() const { return m_States; }
+        const std::vector<AnimationGraphTransition>& GetTransitions() const { return m_Transitions; }
+        uint32_t GetEntryState() const { return m_EntryState; }
+        float GetWeightThreshold() const { return m_WeightThreshold; }
+
+        /**
+         * @brief Loads the clips referenced by the graph.
+         *
+         * Clips are resolved once and shared by every instance of the graph.
+         *
+         * @return The clips indexed like GetClips(). Unresolved clips are nullptr.
+         */
+        const std::vector<Ref<Animation>>& ResolveClips();
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void save(Archive& archive) const
+        {
+            archive(m_Parameters, m_Clips, m_States, m_Transitions, m_EntryState, m_WeightThreshold, cereal::base_class<Resource>(this));
+        }
+
+        template<class Archive>
+        void load(Archive& archive)
+        {
+            archive(m_Parameters, m_Clips, m_States, m_Transitions, m_EntryState, m_WeightThreshold, cereal::base_class<Resource>(this));
+        }
+
+    private:
+        std::vector<AnimationGraphParameter> m_Parameters;
+        std::vector<AnimationClipReference> m_Clips;
+        std::vector<AnimationGraphState> m_States;
+        std::vector<AnimationGraphTransition> m_Transitions;
+        uint32_t m_EntryState = 0;
+        float m_WeightThreshold = 0.01f; ///< Clips with a lower effective weight are not sampled.
+
+        std::vector<Ref<Animation>> m_ResolvedClips; ///< Runtime cache of the clips, not serialized.
+    };
+
+    /** @} */
+}
+
+CEREAL_REGISTER_TYPE(Coffee::AnimationGraph);
+CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::Resource, Coffee::AnimationGraph);
@@ -0,0 +1,353 @@
+#include "CoffeeEngine/Animation/AnimationGraphInstance.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    AnimationGraphInstance::AnimationGraphInstance(const Ref<AnimationGraph>& graph)
+        : m_Graph(graph)
+    {
+        ZoneScoped;
+
+        m_Clips = m_Graph->ResolveClips();
+        m_Cursors.resize(m_Clips.size());
+
+        // Every clip must share the hierarchy of the first one, as poses are blended node by node
+        for (size_t i = 0; i < m_Clips.size(); i++)
+        {
+            if (!m_Clips[i])
+                continue;
+
+            if (!m_Nodes)
+            {
+                m_Nodes = &m_Clips[i]->GetNodes();
+            }
+            else if (m_Clips[i]->GetNodes().size() != m_Nodes->size())
+            {
+                COFFEE_CORE_ERROR("AnimationGraphInstance: Clip {0} does not match the hierarchy of the graph {1}", m_Clips[i]->GetName(), m_Graph->GetName());
+                m_Clips[i] = nullptr;
+                continue;
+            }
+
+            m_Cursors[i].assign(m_Clips[i]->GetBones().size(), Bone::SamplingCursor{});
+        }
+
+        for (const AnimationGraphParameter& parameter : m_Graph->GetParameters())
+        {
+            m_Parameters.push_back(parameter.defaultValue);
+        }
+
+        int boneCount = 100;
+        for (const Ref<Animation>& clip : m_Clips)
+        {
+            if (clip)
+                boneCount = std::max(boneCount, clip->GetBoneCount());
+        }
+
+        const size_t nodeCount = m_Nodes ? m_Nodes->size() : 0;
+        m_PosePool.Reset(static_cast<uint32_t>(nodeCount), 2);
+        m_GlobalTransforms.assign(nodeCount, glm::mat4(1.0f));
+        m_FinalBoneMatrices.assign(boneCount, glm::mat4(1.0f));
+
+        if (!m_Graph->GetStates().empty())
+        {
+            m_CurrentState = static_cast<int>(std::min<size_t>(m_Graph->GetEntryState(), m_Graph->GetStates().size() - 1));
+        }
+    }
+
+    void AnimationGraphInstance::SetParameter(uint32_t parameter, float value)
+    {
+        if (parameter < m_Parameters.size())
+            m_Parameters[parameter] = value;
+    }
+
+    void AnimationGraphInstance::SetParameter(const std::string& name, float value)
+    {
+        int parameter = m_Graph->FindParameter(name);
+        if (parameter < 0)
+        {
+            COFFEE_CORE_ERROR("AnimationGraphInstance::SetParameter: Parameter {0} not found", name);
+            return;
+        }
+        m_Parameters[parameter] = value;
+    }
+
+    void AnimationGraphInstance::TransitionTo(uint32_t state, float duration)
+    {
+        if (state >= m_Graph->GetStates().size())
+            return;
+
+        if (duration > 0.0f && m_CurrentState >= 0)
+        {
+            m_PreviousState = m_CurrentState;
+            m_PreviousTime = m_CurrentTime;
+            m_FadeElapsed = 0.0f;
+            m_FadeDuration = duration;
+        }
+        else
+        {
+            m_PreviousState = -1;
+        }
+
+        m_CurrentState = static_cast<int>(state);
+        m_CurrentTime = 0.0f;
+    }
+
+    void AnimationGraphInstance::Update(float dt)
+    {
+        ZoneScoped;
+
+        if (m_CurrentState < 0 || !m_Nodes)
+            return;
+
+        EvaluateTransitions();
+
+        // Effective weight of the active states
+        float fadeWeight = 1.0f;
+        if (IsTransitioning())
+        {
+            m_FadeElapsed += dt;
+            fadeWeight = std::clamp(m_FadeElapsed / m_FadeDuration, 0.0f, 1.0f);
+        }
+
+        m_ContributionCount = 0;
+        CollectState(m_CurrentState, fadeWeight, m_CurrentTime, dt);
+        if (IsTransitioning())
+        {
+            CollectState(m_PreviousState, 1.0f - fadeWeight, m_PreviousTime, dt);
+            if (fadeWeight >= 1.0f)
+                m_PreviousState = -1;
+        }
+
+        // Drop the clips that would barely change the pose, then renormalize the rest
+        const float threshold = m_Graph->GetWeightThreshold();
+        float totalWeight = 0.0f;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < m_ContributionCount; i++)
+        {
+            if (m_Contributions[i].weight >= threshold)
+            {
+                totalWeight += m_Contributions[i].weight;
+                m_Contributions[kept++] = m_Contributions[i];
+            }
+        }
+        m_ContributionCount = kept;
+        m_SampledClipCount = kept;
+
+        if (kept == 0 || totalWeight <= 0.0f)
+            return;
+
+        Pose pose = m_PosePool.Acquire();
+        Pose sample = m_PosePool.Acquire();
+
+        // Running normalized blend: each clip is mixed in with its share of the weight so far
+        float accumulatedWeight = 0.0f;
+        for (uint32_t i = 0; i < m_ContributionCount; i++)
+        {
+            const Contribution& contribution = m_Contributions[i];
+            const Animation& clip = *m_Clips[contribution.clip];
+            const float time = contribution.normalizedTime * clip.GetDuration();
+
+            float weight = contribution.weight / totalWeight;
+            accumulatedWeight += weight;
+
+            if (i == 0)
+            {
+                SamplePose(clip, time, m_Cursors[contribution.clip].data(), pose, m_BoneReduction);
+            }
+            else
+            {
+                SamplePose(clip, time, m_Cursors[contribution.clip].data(), sample, m_BoneReduction);
+                BlendPoses(pose, sample, weight / accumulatedWeight, pose);
+            }
+        }
+
+        ComputeBoneMatrices(*m_Nodes, pose, m_GlobalTransforms.data(), m_FinalBoneMatrices.data());
+
+        m_PosePool.Release(sample);
+        m_PosePool.Release(pose);
+    }
+
+    void AnimationGraphInstance::EvaluateTransitions()
+    {
+        for (const AnimationGraphTransition& transition : m_Graph->GetTransitions())
+        {
+            if (transition.from >= 0 && transition.from != m_CurrentState)
+                continue;
+
+            if (transition.from < 0 && static_cast<int>(transition.to) == m_CurrentState)
+                continue;
+
+            if (transition.exitTime >= 0.0f && m_CurrentTime < transition.exitTime)
+                continue;
+
+            if (!IsConditionMet(transition))
+                continue;
+
+            TransitionTo(transition.to, transition.duration);
+            return;
+        }
+    }
+
+    bool AnimationGraphInstance::IsConditionMet(const AnimationGraphTransition& transition) const
+    {
+        if (transition.mode == AnimationConditionMode::Always)
+            return true;
+
+        if (transition.parameter < 0 || transition.parameter >= static_cast<int>(m_Parameters.size()))
+            return false;
+
+        const float value = m_Parameters[transition.parameter];
+        switch (transition.mode)
+        {
+            case AnimationConditionMode::Greater: return value > transition.threshold;
+            case AnimationConditionMode::Less: return value < transition.threshold;
+            case AnimationConditionMode::Equals: return value == transition.threshold;
+            case AnimationConditionMode::NotEquals: return value != transition.threshold;
+            default: return false;
+        }
+    }
+
+    void AnimationGraphInstance::CollectState(uint32_t stateIndex, float stateWeight, float& normalizedTime, float dt)
+    {
+        const AnimationGraphState& state = m_Graph->GetStates()[stateIndex];
+        const uint32_t first = m_ContributionCount;
+
+        switch (state.type)
+        {
+            case AnimationStateType::Clip:
+                AddContribution(state.clip, stateWeight);
+                break;
+            case AnimationStateType::BlendSpace1D:
+                CollectBlendSpace1D(state, stateWeight);
+                break;
+            case AnimationStateType::BlendSpace2D:
+                CollectBlendSpace2D(state, stateWeight);
+                break;
+        }
+
+        float duration = 0.0f;
+        float totalWeight = 0.0f;
+        for (uint32_t i = first; i < m_ContributionCount; i++)
+        {
+            duration += GetClipDuration(m_Contributions[i].clip) * m_Contributions[i].weight;
+            totalWeight += m_Contributions[i].weight;
+        }
+
+        if (totalWeight > 0.0f && duration > 0.0f)
+        {
+            normalizedTime += dt * state.speed * totalWeight / duration;
+            normalizedTime = state.loop ? normalizedTime - std::floor(normalizedTime) : std::min(normalizedTime, 1.0f);
+        }
+
+        for (uint32_t i = first; i < m_ContributionCount; i++)
+        {
+            m_Contributions[i].normalizedTime = normalizedTime;
+        }
+    }
+
+    void AnimationGraphInstance::AddContribution(uint32_t clip, float weight)
+    {
+        if (weight <= 0.0f || clip >= m_Clips.size() || !m_Clips[clip])
+            return;
+
+        if (m_ContributionCount < kMaxContributions)
+        {
+            m_Contributions[m_ContributionCount++] = {clip, weight, 0.0f};
+            return;
+        }
+
+        // Full: replace the lightest contribution if this one weighs more
+        auto lightest = std::min_element(m_Contributions.begin(), m_Contributions.end(),
+            [](const Contribution& a, const Contribution& b) { return a.weight < b.weight; });
+        if (lightest->weight < weight)
+            *lightest = {clip, weight, 0.0f};
+    }
+
+    void AnimationGraphInstance::CollectBlendSpace1D(const AnimationGraphState& state, float stateWeight)
+    {
+        const std::vector<BlendSpaceSample>& samples = state.samples;
+        if (samples.empty())
+            return;
+
+        const float x = state.parameterX >= 0 ? m_Parameters[state.parameterX] : 0.0f;
+
+        if (x <= samples.front().position.x)
+        {
+            AddContribution(samples.front().clip, stateWeight);
+            return;
+        }
+        if (x >= samples.back().position.x)
+        {
+            AddContribution(samples.back().clip, stateWeight);
+            return;
+        }
+
+        // Only the two samples around the parameter contribute
+        auto upper = std::upper_bound(samples.begin(), samples.end(), x,
+            [](float value, const BlendSpaceSample& sample) { return value < sample.position.x; });
+        const BlendSpaceSample& b = *upper;
+        const BlendSpaceSample& a = *(upper - 1);
+
+        const float span = b.position.x - a.position.x;
+        const float t = span > 0.0f ? (x - a.position.x) / span : 0.0f;
+
+        AddContribution(a.clip, stateWeight * (1.0f - t));
+        AddContribution(b.clip, stateWeight * t);
+    }
+
+    void AnimationGraphInstance::CollectBlendSpace2D(const AnimationGraphState& state, float stateWeight)
+    {
+        const std::vector<BlendSpaceSample>& samples = state.samples;
+        if (samples.empty())
+            return;
+
+        const glm::vec2 p(state.parameterX >= 0 ? m_Parameters[state.parameterX] : 0.0f,
+                          state.parameterY >= 0 ? m_Parameters[state.parameterY] : 0.0f);
+
+        // Gradient band interpolation: the weight of a sample falls to zero at every other sample. Every sample is weighed,
+        // AddContribution keeps the heaviest when there are more than kMaxContributions
+        std::vector<float>& weights = m_BlendSpaceWeights;
+        const size_t count = samples.size();
+        weights.assign(count, 0.0f);
+        float totalWeight = 0.0f;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float weight = 1.0f;
+            for (size_t j = 0; j < count && weight > 0.0f; j++)
+            {
+                if (i == j)
+                    continue;
+
+                glm::vec2 edge = samples[j].position - samples[i].position;
+                float lengthSquared = glm::dot(edge, edge);
+                if (lengthSquared <= 0.0f)
+                    continue;
+
+                weight = std::min(weight, 1.0f - glm::dot(p - samples[i].position, edge) / lengthSquared);
+            }
+
+            weights[i] = std::max(weight, 0.0f);
+            totalWeight += weights[i];
+        }
+
+        if (totalWeight <= 0.0f)
+            return;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            AddContribution(samples[i].clip, stateWeight * weights[i] / totalWeight);
+        }
+    }
+
+    float AnimationGraphInstance::GetClipDuration(uint32_t clip) const
+    {
+        const Animation& animation = *m_Clips[clip];
+        return animation.GetTicksPerSecond() > 0 ? animation.GetDuration() / animation.GetTicksPerSecond() : 0.0f;
+    }
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Animation/AnimationGraph.h"
+#include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/Pose.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief Evaluates an AnimationGraph for one character.
+     *
+     * Each update collects the clips of the active states with their effective weight,
+     * drops the ones below the weight threshold of the graph and samples only the rest.
+     * The cost depends on the clips that contribute to the pose, not on the size of the graph.
+     */
+    class AnimationGraphInstance
+    {
+    public:
+        static constexpr uint32_t kMaxContributions = 16; ///< The maximum number of clips blended in one update.
+
+        AnimationGraphInstance(const Ref<AnimationGraph>& graph);
+
+        /**
+         * @brief Advances the graph, fires transitions and evaluates the final bone matrices.
+         * @param dt The elapsed time in seconds.
+         */
+        void Update(float dt);
+
+        const Ref<AnimationGraph>& GetGraph() const { return m_Graph; }
+
+        void SetParameter(uint32_t parameter, float value);
+        void SetParameter(const std::string& name, float value);
+        float GetParameter(uint32_t parameter) const { return m_Parameters[parameter]; }
+
+        /**
+         * @brief Jumps to a state, optionally fading from the current one.
+         * @param state The index of the state.
+         * @param duration The duration of the crossfade in seconds, 0 to switch immediately.
+         */
+        void TransitionTo(uint32_t state, float duration = 0.0f);
+
+        int GetCurrentState() const { return m_CurrentState; }
+        bool IsTransitioning() const { return m_PreviousState >= 0; }
+
+        /**
+         * @brief Gets the number of clips sampled in the last update.
+         */
+        uint32_t GetSampledClipCount() const { return m_SampledClipCount; }
+
+        /**
+         * @brief Sets how many of the short bone chains (fingers, face) keep their bind pose instead of being sampled.
+         * @param boneReduction The reduction level compared to AnimationNode::reductionLevel, 0 samples every bone.
+         */
+        void SetBoneReduction(int boneReduction) { m_BoneReduction = boneReduction; }
+        int GetBoneReduction() const { return m_BoneReduction; }
+
+        const std::vector<glm::mat4>& GetFinalBoneMatrices() const { return m_FinalBoneMatrices; }
+
+    private:
+        /**
+         * @brief A clip that contributes to the pose of this update.
+         */
+        struct Contribution
+        {
+            uint32_t clip;
+            float weight;
+            float normalizedTime;
+        };
+
+        void EvaluateTransitions();
+        bool IsConditionMet(const AnimationGraphTransition& transition) const;
+
+        /**
+         * @brief Appends the clips of a state scaled by the weight of the state, then advances the state.
+         *
+         * Blend spaces advance at the weighted duration of their clips, so their clips stay in phase.
+         */
+        void CollectState(uint32_t state, float stateWeight, float& normalizedTime, float dt);
+        void AddContribution(uint32_t clip, float weight);
+
+        void CollectBlendSpace1D(const AnimationGraphState& state, float stateWeight);
+        void CollectBlendSpace2D(const AnimationGraphState& state, float stateWeight);
+
+        float GetClipDuration(uint32_t clip) const;
+
+    private:
+        Ref<AnimationGraph> m_Graph;
+        std::vector<Ref<Animation>> m_Clips; ///< The resolved clips, indexed like AnimationGraph::GetClips().
+        std::vector<std::vector<Bone::SamplingCursor>> m_Cursors; ///< The sampling cursors of every clip, indexed like m_Clips.
+        const std::vector<AnimationNode>* m_Nodes = nullptr; ///< The hierarchy shared by every clip.
+
+        std::vector<float> m_Parameters;
+        std::vector<float> m_BlendSpaceWeights; ///< Scratch weights of the samples of a 2D blend space.
+
+        int m_CurrentState = -1;
+        float m_CurrentTime = 0.0f; ///< The normalized time of the current state.
+        int m_PreviousState = -1; ///< The state being faded out, or -1.
+        float m_PreviousTime = 0.0f; ///< The normalized time of the state being faded out.
+        float m_FadeElapsed = 0.0f;
+        float m_FadeDuration = 0.0f;
+
+        std::array<Contribution, kMaxContributions> m_Contributions;
+        uint32_t m_ContributionCount = 0;
+        uint32_t m_SampledClipCount = 0;
+        int m_BoneReduction = 0;
+
+        PosePool m_PosePool; ///< The accumulated pose and the pose being sampled.
+        std::vector<glm::mat4> m_GlobalTransforms;
+        std::vector<glm::mat4> m_FinalBoneMatrices;
+    };
+
+    /** @} */
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    static constexpr uint32_t kMaxAnimationLODs = 4; ///< The maximum number of animation LOD tiers.
+
+    /**
+     * @brief How the animation LOD of an entity is chosen.
+     */
+    enum class AnimationLODMetric
+    {
+        Distance, ///< The distance between the camera and the center of the bounds.
+        ScreenSize, ///< The fraction of the screen height covered by the bounds.
+    };
+
+    /**
+     * @brief The update policy of one animation LOD tier.
+     */
+    struct AnimationLODTier
+    {
+        float maxDistance = std::numeric_limits<float>::max(); ///< Entities up to this distance use the tier (Distance metric).
+        float minScreenSize = 0.0f; ///< Entities covering at least this fraction of the screen use the tier (ScreenSize metric).
+        uint32_t updateInterval = 1; ///< The number of frames between two evaluations of the pose.
+        int boneReduction = 0; ///< The bone reduction level, see AnimationNode::reductionLevel.
+    };
+
+    /**
+     * @brief The animation LOD tiers, from the most detailed to the cheapest.
+     *
+     * An entity uses the first tier it qualifies for, or the last one.
+     */
+    struct AnimationLODSettings
+    {
+        AnimationLODMetric metric = AnimationLODMetric::Distance;
+        bool interpolate = true; ///< Blends the last two evaluated palettes on the frames that skip the evaluation.
+        uint32_t tierCount = 4;
+        // Level 1 drops the single bones of a fan, like the eyes and the head end, level 4 also the fingers of a humanoid hand
+        std::array<AnimationLODTier, kMaxAnimationLODs> tiers = {{
+            {15.0f, 0.25f, 1, 0},
+            {35.0f, 0.10f, 2, 1},
+            {70.0f, 0.04f, 4, 4},
+            {std::numeric_limits<float>::max(), 0.0f, 8, 4},
+        }};
+
+        /**
+         * @brief Picks the tier of an entity.
+         * @param distance The distance between the camera and the entity.
+         * @param screenSize The fraction of the screen height covered by the entity.
+         * @return The index of the tier.
+         */
+        uint32_t SelectTier(float distance, float screenSize) const
+        {
+            for (uint32_t i = 0; i + 1 < tierCount; i++)
+            {
+                const AnimationLODTier& tier = tiers[i];
+                if (metric == AnimationLODMetric::Distance ? distance <= tier.maxDistance : screenSize >= tier.minScreenSize)
+                    return i;
+            }
+            return tierCount > 0 ? tierCount - 1 : 0;
+        }
+    };
+
+    /**
+     * @brief What one animation LOD tier cost in the last update.
+     */
+    struct AnimationLODStats
+    {
+        uint32_t population = 0; ///< The entities using the tier.
+        uint32_t evaluated = 0; ///< The entities whose pose was evaluated, the others were interpolated or held.
+        double updateTimeMs = 0.0; ///< The wall time spent updating the tier.
+    };
+
+    /** @} */
+}
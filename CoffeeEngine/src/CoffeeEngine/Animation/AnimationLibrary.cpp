@@ -0,0 +1,183 @@
+#include "CoffeeEngine/Animation/AnimationLibrary.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Renderer/Model.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    AnimationLibrary::AnimationLibrary(const std::filesystem::path& path, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake)
+        : Resource(ResourceType::AnimationLibrary), m_BoneInfoMap(boneInfoMap)
+    {
+        ZoneScoped;
+
+        m_FilePath = path;
+        m_Name = path.stem().string() + "_Animations";
+
+        for (const auto& [name, info] : boneInfoMap)
+        {
+            m_BoneCounter = std::max(m_BoneCounter, info.id + 1);
+        }
+
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path.string(), aiProcess_Triangulate);
+
+        if (!scene || !scene->mRootNode || scene->mNumAnimations == 0)
+        {
+            COFFEE_CORE_ERROR("ERROR::ASSIMP:: Failed to load animations: {0}", importer.GetErrorString());
+            return;
+        }
+
+        ReadBoneOffsets(scene);
+
+        AnimationCompressionStats totalStats;
+        m_Animations.reserve(scene->mNumAnimations);
+
+        for (uint32_t i = 0; i < scene->mNumAnimations; i++)
+        {
+            const aiAnimation* aiAnim = scene->mAnimations[i];
+
+            Ref<Animation> animation = CreateRef<Animation>();
+            animation->m_Name = aiAnim->mName.length > 0 ? aiAnim->mName.C_Str() : path.stem().string() + "_" + std::to_string(i);
+            animation->m_Duration = aiAnim->mDuration;
+            animation->m_TicksPerSecond = aiAnim->mTicksPerSecond;
+
+            ReadAnimationBones(aiAnim, animation->m_Bones);
+
+            for (uint32_t c = 0; c < aiAnim->mNumMorphMeshChannels; c++)
+            {
+                animation->m_MorphChannels.emplace_back(aiAnim->mMorphMeshChannels[c]);
+            }
+
+            if (compression.enabled)
+            {
+                totalStats.Merge(animation->Compress(compression));
+            }
+
+            m_Animations.push_back(animation);
+        }
+
+        // Built once every clip has added its bones, the hierarchy is read once and shared by every clip of the rig
+        AssimpNodeData rootNode;
+        ReadNodeHierarchy(rootNode, scene->mRootNode);
+        m_Skeleton = Skeleton::Share(CreateRef<Skeleton>(path.stem().string() + "_Skeleton", rootNode, m_BoneInfoMap));
+
+        for (const Ref<Animation>& animation : m_Animations)
+        {
+            animation->SetSkeleton(m_Skeleton);
+        }
+
+        COFFEE_CORE_INFO("Imported {0} animations from {1} ({2} nodes, {3} bones)", m_Animations.size(), m_Name, m_Skeleton->GetNodes().size(), m_Skeleton->GetBoneCount());
+
+        if (compression.enabled)
+        {
+            COFFEE_CORE_INFO("Compressed animations {0}: {1} -> {2} KB, {3} -> {4} keys, max error (position {5}, rotation {6} rad, scale {7})",
+                             m_Name, totalStats.rawBytes / 1024.0f, totalStats.compressedBytes / 1024.0f,
+                             totalStats.rawKeys, totalStats.compressedKeys, totalStats.maxPositionError, totalStats.maxRotationError, totalStats.maxScaleError);
+        }
+
+        // Baked after compression, so the tables match what the Animator would play
+        if (bake.enabled)
+        {
+            Bake(bake);
+        }
+    }
+
+    void AnimationLibrary::Bake(const AnimationBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        m_BakedAnimations.clear();
+        m_BakedAnimations.reserve(m_Animations.size());
+
+        size_t bakedBytes = 0;
+        for (const Ref<Animation>& animation : m_Animations)
+        {
+            m_BakedAnimations.push_back(BakedAnimation::Bake(*animation, settings.frameRate));
+            bakedBytes += m_BakedAnimations.back()->GetSize();
+        }
+
+        COFFEE_CORE_INFO("Baked {0} animations of {1} at {2} fps: {3} KB", m_BakedAnimations.size(), m_Name, settings.frameRate, bakedBytes / 1024.0f);
+    }
+
+    void AnimationLibrary::ShareSkeleton()
+    {
+        // Clips saved before the skeleton was registered, or by another library of the same rig, all end up on one instance
+        m_Skeleton = Skeleton::Share(m_Skeleton);
+        for (const Ref<Animation>& animation : m_Animations)
+        {
+            animation->m_Skeleton = m_Skeleton;
+        }
+    }
+
+    Ref<Animation> AnimationLibrary::GetAnimation(const std::string& name) const
+    {
+        for (const Ref<Animation>& animation : m_Animations)
+        {
+            if (animation->GetName() == name)
+                return animation;
+        }
+        return nullptr;
+    }
+
+    void AnimationLibrary::ReadNodeHierarchy(AssimpNodeData& dest, const aiNode* src)
+    {
+        dest.name = src->mName.data;
+        dest.transformation = aiMatrix4x4ToGLMMat4(src->mTransformation);
+        dest.childrenCount = src->mNumChildren;
+        dest.children.reserve(src->mNumChildren);
+
+        for (uint32_t i = 0; i < src->mNumChildren; i++)
+        {
+            AssimpNodeData newData;
+            ReadNodeHierarchy(newData, src->mChildren[i]);
+            dest.children.push_back(std::move(newData));
+        }
+    }
+
+    void AnimationLibrary::ReadBoneOffsets(const aiScene* scene)
+    {
+        // Animation files exported with their mesh carry the offsets of bones the model may not know yet
+        for (uint32_t m = 0; m < scene->mNumMeshes; m++)
+        {
+            const aiMesh* mesh = scene->mMeshes[m];
+            for (uint32_t b = 0; b < mesh->mNumBones; b++)
+            {
+                std::string boneName = mesh->mBones[b]->mName.C_Str();
+                if (m_BoneInfoMap.find(boneName) == m_BoneInfoMap.end())
+                {
+                    BoneInfo info;
+                    info.id = m_BoneCounter++;
+                    info.offset = aiMatrix4x4ToGLMMat4(mesh->mBones[b]->mOffsetMatrix);
+                    m_BoneInfoMap[boneName] = info;
+                }
+            }
+        }
+    }
+
+    void AnimationLibrary::ReadAnimationBones(const aiAnimation* animation, std::vector<Bone>& bones)
+    {
+        bones.reserve(animation->mNumChannels);
+
+        for (uint32_t i = 0; i < animation->mNumChannels; i++)
+        {
+            auto channel = animation->mChannels[i];
+            std::string boneName = channel->mNodeName.data;
+
+            auto boneInfo = m_BoneInfoMap.find(boneName);
+            if (boneInfo == m_BoneInfoMap.end())
+            {
+                BoneInfo info;
+                info.id = m_BoneCounter++;
+                info.offset = glm::mat4(1.0f);
+                boneInfo = m_BoneInfoMap.emplace(boneName, info).first;
+            }
+
+            bones.push_back(Bone(boneName, boneInfo->second.id, channel));
+        }
+    }
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/AnimationCompression.h"
+#include "CoffeeEngine/Animation/BakedAnimation.h"
+#include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/Skeleton.h"
+
+#include <cereal/access.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief Resource holding every animation clip of a file.
+     *
+     * The file is parsed once at import and all its clips are stored together,
+     * so files with many clips do not need one Assimp parse per clip.
+     */
+    class AnimationLibrary : public Resource
+    {
+    public:
+        /**
+         * @brief Default constructor, used when the library is loaded from the cache.
+         */
+        AnimationLibrary() : Resource(ResourceType::AnimationLibrary) {}
+
+        /**
+         * @brief Imports every animation clip of a file.
+         * @param path The path of the file.
+         * @param boneInfoMap The bones of the model the clips animate. Bones missing from it are appended.
+         * @param compression The compression applied to the keys of the clips.
+         * @param bake Whether the clips are also baked into palette tables.
+         */
+        AnimationLibrary(const std::filesystem::path& path, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake = {});
+
+        /**
+         * @brief Whether the import found clips in the file. Failed imports are neither cached nor registered.
+         */
+        bool IsValid() const { return !m_Animations.empty(); }
+
+        /**
+         * @brief Gets all the clips of the library.
+         * @return The clips in file order.
+         */
+        const std::vector<Ref<Animation>>& GetAnimations() const { return m_Animations; }
+
+        /**
+         * @brief Gets a clip by index.
+         * @param index The index of the clip.
+         * @return The clip, or nullptr if the index is out of range.
+         */
+        Ref<Animation> GetAnimation(size_t index) const { return index < m_Animations.size() ? m_Animations[index] : nullptr; }
+
+        /**
+         * @brief Gets a clip by name.
+         * @param name The name of the clip.
+         * @return The clip, or nullptr if there is no clip with that name.
+         */
+        Ref<Animation> GetAnimation(const std::string& name) const;
+
+        /**
+         * @brief Gets the number of clips of the library.
+         * @return The number of clips.
+         */
+        size_t GetAnimationCount() const { return m_Animations.size(); }
+
+        /**
+         * @brief Gets the skeleton shared by the clips.
+         */
+        const Ref<Skeleton>& GetSkeleton() const { return m_Skeleton; }
+
+        /**
+         * @brief Gets the bones the clips were resolved against.
+         * @return The bone info map, including the bones added by the clips.
+         */
+        std::map<std::string, BoneInfo> GetBoneInfoMap() const { return m_Skeleton ? m_Skeleton->GetBoneInfoMap() : std::map<std::string, BoneInfo>{}; }
+
+        /**
+         * @brief Bakes every clip of the library into palette tables, replacing the previous ones.
+         * @param settings The frame rate of the tables.
+         */
+        void Bake(const AnimationBakeSettings& settings);
+
+        /**
+         * @brief Whether the clips of the library are baked.
+         */
+        bool IsBaked() const { return !m_BakedAnimations.empty(); }
+
+        /**
+         * @brief Gets the baked table of a clip.
+         * @param index The index of the clip.
+         * @return The baked clip, or nullptr if the library is not baked or the index is out of range.
+         */
+        Ref<BakedAnimation> GetBakedAnimation(size_t index) const { return index < m_BakedAnimations.size() ? m_BakedAnimations[index] : nullptr; }
+
+    private:
+        void ReadNodeHierarchy(AssimpNodeData& dest, const aiNode* src);
+        void ReadBoneOffsets(const aiScene* scene);
+        void ReadAnimationBones(const aiAnimation* animation, std::vector<Bone>& bones);
+
+        /**
+         * @brief Replaces the skeleton by the registered one of the same rig, see Skeleton::Share.
+         */
+        void ShareSkeleton();
+
+        friend class cereal::access;
+
+        template<class Archive>
+        void save(Archive& archive) const
+        {
+            archive(m_Skeleton, m_Animations, m_BakedAnimations, cereal::base_class<Resource>(this));
+        }
+
+        template<class Archive>
+        void load(Archive& archive)
+        {
+            archive(m_Skeleton, m_Animations, m_BakedAnimations, cereal::base_class<Resource>(this));
+            ShareSkeleton();
+        }
+
+    private:
+        std::vector<Ref<Animation>> m_Animations; ///< The clips of the library, in file order.
+        std::vector<Ref<BakedAnimation>> m_BakedAnimations; ///< The baked tables of the clips, empty unless baking was requested.
+        Ref<Skeleton> m_Skeleton; ///< The skeleton of the clips.
+        std::map<std::string, BoneInfo> m_BoneInfoMap; ///< The bones the clips are resolved against during the import.
+        int m_BoneCounter = 0; ///< The next free bone index during the import.
+    };
+
+    /** @} */
+}
+
+CEREAL_REGISTER_TYPE(Coffee::AnimationLibrary);
+CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::Resource, Coffee::AnimationLibrary);
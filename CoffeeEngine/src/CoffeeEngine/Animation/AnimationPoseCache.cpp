@@ -0,0 +1,108 @@
+#include "CoffeeEngine/Animation/AnimationPoseCache.h"
+#include "CoffeeEngine/Animation/Animation.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Coffee {
+
+    void AnimationPoseCache::BeginFrame()
+    {
+        ZoneScoped;
+
+        for (size_t i = 0; i < m_EntryCount; i++)
+        {
+            m_EntryStorage[i].palette.reset();
+        }
+        m_Entries.clear();
+        m_EntryCount = 0;
+
+        // Palettes still held by an animator (a held LOD frame, the renderer of this frame) must not be overwritten
+        m_FreePalettes.clear();
+        for (const Ref<std::vector<glm::mat4>>& palette : m_Palettes)
+        {
+            if (palette.use_count() == 1)
+                m_FreePalettes.push_back(palette);
+        }
+
+        m_Requests = 0;
+        m_Hits = 0;
+    }
+
+    uint32_t AnimationPoseCache::QuantizeTime(const Animation& animation, float time) const
+    {
+        float stepTicks = m_TimeStep * animation.GetTicksPerSecond();
+        if (stepTicks <= 0.0f)
+            return 0;
+
+        return static_cast<uint32_t>(std::floor(time / stepTicks + 0.5f));
+    }
+
+    float AnimationPoseCache::GetStepTime(const Animation& animation, uint32_t step) const
+    {
+        float time = static_cast<float>(step) * m_TimeStep * animation.GetTicksPerSecond();
+
+        // Rounding may land on the end of the clip, which is its first frame again
+        if (animation.GetDuration() > 0.0f && time >= animation.GetDuration())
+            time = std::fmod(time, animation.GetDuration());
+        return time;
+    }
+
+    Ref<const std::vector<glm::mat4>> AnimationPoseCache::GetOrEvaluate(const Animation* animation, uint32_t step, int boneReduction, const EvaluateFunction& evaluate)
+    {
+        m_Requests++;
+
+        Entry* entry = nullptr;
+        bool claimed = false;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            auto [it, inserted] = m_Entries.try_emplace(Key{animation, step, boneReduction}, nullptr);
+            if (inserted)
+            {
+                if (m_EntryCount == m_EntryStorage.size())
+                    m_EntryStorage.emplace_back();
+
+                entry = &m_EntryStorage[m_EntryCount++];
+                entry->palette = AcquirePalette();
+                entry->ready = false;
+                it->second = entry;
+                claimed = true;
+            }
+            else
+            {
+                entry = it->second;
+            }
+        }
+
+        if (claimed)
+        {
+            evaluate(*entry->palette);
+            entry->ready.store(true, std::memory_order_release);
+            entry->ready.notify_all();
+        }
+        else
+        {
+            // The instance that claimed the key is evaluating it on another thread
+            entry->ready.wait(false, std::memory_order_acquire);
+            m_Hits++;
+        }
+
+        return entry->palette;
+    }
+
+    Ref<std::vector<glm::mat4>> AnimationPoseCache::AcquirePalette()
+    {
+        if (!m_FreePalettes.empty())
+        {
+            Ref<std::vector<glm::mat4>> palette = std::move(m_FreePalettes.back());
+            m_FreePalettes.pop_back();
+            return palette;
+        }
+
+        return m_Palettes.emplace_back(CreateRef<std::vector<glm::mat4>>());
+    }
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    class Animation;
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief Hit counters of an AnimationPoseCache for the current frame.
+     */
+    struct AnimationPoseCacheStats
+    {
+        uint32_t requests = 0; ///< The palettes requested.
+        uint32_t hits = 0; ///< The requests served by a palette evaluated for another instance.
+
+        float GetHitRate() const { return requests > 0 ? static_cast<float>(hits) / static_cast<float>(requests) : 0.0f; }
+    };
+
+    /**
+     * @brief Per-frame cache of the bone palettes of instances playing the same clip at the same time.
+     *
+     * Requests are keyed by clip, quantized time and bone reduction level. The first request of a key
+     * evaluates the palette, the others wait for it and share it by reference. Palettes stay alive while
+     * an animator holds them and are recycled by the next BeginFrame once nobody does.
+     * Lookups are thread safe, so the cache can be shared by the workers of the AnimationSystem.
+     */
+    class AnimationPoseCache
+    {
+    public:
+        /**
+         * @brief Function evaluating the palette of a key into the cache storage.
+         */
+        using EvaluateFunction = std::function<void(std::vector<glm::mat4>& palette)>;
+
+        /**
+         * @brief Forgets the palettes of the last frame and resets the counters. Not thread safe.
+         */
+        void BeginFrame();
+
+        /**
+         * @brief Quantizes an animation time to the step of the cache.
+         * @param animation The animation being sampled.
+         * @param time The animation time in ticks.
+         * @return The index of the step.
+         */
+        uint32_t QuantizeTime(const Animation& animation, float time) const;
+
+        /**
+         * @brief Gets the animation time of a step.
+         * @param animation The animation being sampled.
+         * @param step The index of the step.
+         * @return The animation time in ticks, always inside the animation.
+         */
+        float GetStepTime(const Animation& animation, uint32_t step) const;
+
+        /**
+         * @brief Gets the palette of a key, evaluating it if no other instance did this frame.
+         * @param animation The animation being sampled.
+         * @param step The quantized time, see QuantizeTime.
+         * @param boneReduction The bone reduction level of the evaluation.
+         * @param evaluate Called on a miss to fill the palette.
+         * @return The shared palette.
+         */
+        Ref<const std::vector<glm::mat4>> GetOrEvaluate(const Animation* animation, uint32_t step, int boneReduction, const EvaluateFunction& evaluate);
+
+        /**
+         * @brief Sets the length of a time step in seconds. Instances closer in time than a step share their pose.
+         */
+        void SetTimeStep(float timeStep) { m_TimeStep = timeStep; }
+        float GetTimeStep() const { return m_TimeStep; }
+
+        void SetEnabled(bool enabled) { m_Enabled = enabled; }
+        bool IsEnabled() const { return m_Enabled; }
+
+        AnimationPoseCacheStats GetStats() const { return {m_Requests.load(), m_Hits.load()}; }
+
+    private:
+        struct Key
+        {
+            const Animation* animation;
+            uint32_t step;
+            int boneReduction;
+
+            bool operator==(const Key& other) const = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                size_t hash = std::hash<const void*>()(key.animation);
+                hash ^= (static_cast<size_t>(key.step) * 0x9E3779B97F4A7C15ull) + (hash << 6) + (hash >> 2);
+                hash ^= static_cast<size_t>(key.boneReduction) + 0x9E3779B9u + (hash << 6) + (hash >> 2);
+                return hash;
+            }
+        };
+
+        struct Entry
+        {
+            Ref<std::vector<glm::mat4>> palette;
+            std::atomic<bool> ready = false; ///< Set once the evaluating instance has filled the palette.
+        };
+
+        Ref<std::vector<glm::mat4>> AcquirePalette();
+
+    private:
+        bool m_Enabled = true;
+        float m_TimeStep = 1.0f / 60.0f;
+
+        std::mutex m_Mutex; ///< Guards the map, the entries and the palette lists.
+        std::unordered_map<Key, Entry*, KeyHash> m_Entries;
+        std::deque<Entry> m_EntryStorage; ///< Stable storage of the entries, reused every frame.
+        size_t m_EntryCount = 0;
+
+        std::vector<Ref<std::vector<glm::mat4>>> m_Palettes; ///< Every palette allocated by the cache.
+        std::vector<Ref<std::vector<glm::mat4>>> m_FreePalettes; ///< The palettes nobody references anymore.
+
+        std::atomic<uint32_t> m_Requests = 0;
+        std::atomic<uint32_t> m_Hits = 0;
+    };
+
+    /** @} */
+}
@@ -0,0 +1,222 @@
+#include "CoffeeEngine/Animation/AnimationSystem.h"
+#include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/Core/ThreadPool.h"
+#include "CoffeeEngine/Scene/Components.h"
+#include "CoffeeEngine/Scene/SceneTree.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace Coffee {
+
+    uint32_t AnimationSystem::s_BatchSize = 32;
+    AnimationLODSettings AnimationSystem::s_LODSettings;
+    std::array<AnimationLODStats, kMaxAnimationLODs> AnimationSystem::s_LODStats;
+    AnimationPoseCache AnimationSystem::s_PoseCache;
+    std::array<std::vector<AnimatorComponent*>, kMaxAnimationLODs> AnimationSystem::s_Animators;
+
+    /**
+     * @brief Advances an entity by one frame of its LOD tier.
+     * @return Whether the pose was evaluated, otherwise the palette was interpolated or held.
+     */
+    static bool UpdateAnimator(AnimatorComponent& animator, const AnimationLODTier& tier, bool interpolate, float dt, AnimationPoseCache& poseCache)
+    {
+        animator.PendingTime += dt;
+        animator.FramesSinceEvaluation++;
+
+        if (!animator.Evaluated || animator.FramesSinceEvaluation >= tier.updateInterval)
+        {
+            // The palette shown until the next evaluation starts from the one evaluated last, so the motion stays continuous
+            if (const std::vector<glm::mat4>* last = animator.GetEvaluatedBoneMatrices(); last && interpolate)
+                animator.PreviousBoneMatrices = *last;
+
+            animator.Evaluate(animator.PendingTime, tier.boneReduction, &poseCache);
+            animator.PendingTime = 0.0f;
+            animator.FramesSinceEvaluation = 0;
+
+            const std::vector<glm::mat4>* evaluated = animator.GetEvaluatedBoneMatrices();
+            if (!animator.Evaluated && evaluated)
+                animator.PreviousBoneMatrices = *evaluated;
+            animator.Evaluated = true;
+        }
+
+        const std::vector<glm::mat4>* evaluated = animator.GetEvaluatedBoneMatrices();
+        animator.Interpolating = interpolate && tier.updateInterval > 1 && evaluated &&
+                                 animator.PreviousBoneMatrices.size() == evaluated->size();
+        if (!animator.Interpolating)
+            return animator.FramesSinceEvaluation == 0;
+
+        // Lags one interval behind the evaluation. A component-wise lerp is fine for the small motion of a few frames.
+        float t = static_cast<float>(animator.FramesSinceEvaluation) / static_cast<float>(tier.updateInterval);
+        animator.InterpolatedBoneMatrices.resize(evaluated->size());
+        for (size_t i = 0; i < evaluated->size(); i++)
+        {
+            const glm::mat4& from = animator.PreviousBoneMatrices[i];
+            animator.InterpolatedBoneMatrices[i] = from + ((*evaluated)[i] - from) * t;
+        }
+
+        return animator.FramesSinceEvaluation == 0;
+    }
+
+    /**
+     * @brief Finds the animator playing clips for an entity: its own or the one of its closest animated ancestor.
+     */
+    static const Animator* FindAnimator(const entt::registry& registry, entt::entity entity)
+    {
+        while (entity != entt::null)
+        {
+            if (const AnimatorComponent* animator = registry.try_get<AnimatorComponent>(entity))
+                return animator->animator.get();
+
+            const HierarchyComponent* hierarchy = registry.try_get<HierarchyComponent>(entity);
+            entity = hierarchy ? hierarchy->m_Parent : entt::null;
+        }
+        return nullptr;
+    }
+
+    void AnimationSystem::Update(entt::registry& registry, float dt, const glm::mat4& cameraTransform, const glm::mat4& projection)
+    {
+        ZoneScopedN("AnimationSystem::Update");
+
+        const AnimationLODSettings& settings = s_LODSettings;
+        uint32_t tierCount = std::clamp(settings.tierCount, 1u, kMaxAnimationLODs);
+
+        s_PoseCache.BeginFrame();
+
+        glm::vec3 cameraPosition = cameraTransform[3];
+        bool orthographic = projection[3][3] == 1.0f;
+
+        // Gather the components and pick their tier first: the registry is not touched from the workers
+        for (auto& animators : s_Animators)
+            animators.clear();
+
+        auto view = registry.view<AnimatorComponent>();
+        for (auto entity : view)
+        {
+            AnimatorComponent& animator = view.get<AnimatorComponent>(entity);
+
+            glm::vec3 center = animator.Bounds.GetCenter();
+            float radius = glm::length(animator.Bounds.GetHalfSize());
+            if (const TransformComponent* transform = registry.try_get<TransformComponent>(entity))
+            {
+                const glm::mat4& world = transform->GetWorldTransform();
+                center = world * glm::vec4(center, 1.0f);
+                radius *= std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+            }
+
+            float distance = glm::length(center - cameraPosition);
+
+            // projection[1][1] is the cotangent of the half vertical field of view, the screen spans 2 in NDC
+            float screenSize = orthographic ? radius * projection[1][1] : radius * projection[1][1] / std::max(distance, 0.001f);
+
+            uint32_t tier = std::min(settings.SelectTier(distance, screenSize), tierCount - 1);
+            animator.LOD = tier;
+            s_Animators[tier].push_back(&animator);
+        }
+
+        // Tiers are updated one after the other so their wall time can be measured
+        uint32_t animatedCount = 0;
+        for (uint32_t tier = 0; tier < kMaxAnimationLODs; tier++)
+        {
+            AnimationLODStats& stats = s_LODStats[tier];
+            std::vector<AnimatorComponent*>& animators = s_Animators[tier];
+
+            stats = AnimationLODStats{};
+            stats.population = static_cast<uint32_t>(animators.size());
+            animatedCount += stats.population;
+            if (animators.empty())
+                continue;
+
+            ZoneScopedN("AnimationSystem::Tier");
+            ZoneValue(tier);
+
+            Stopwatch stopwatch;
+            stopwatch.Start();
+
+            const AnimationLODTier& tierSettings = settings.tiers[tier];
+            std::atomic<uint32_t> evaluated = 0;
+
+            ThreadPool::ParallelFor(stats.population, s_BatchSize, [&](uint32_t begin, uint32_t end) {
+                ZoneScopedN("AnimationSystem::Batch");
+
+                uint32_t batchEvaluated = 0;
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    if (UpdateAnimator(*animators[i], tierSettings, settings.interpolate, dt, s_PoseCache))
+                        batchEvaluated++;
+                }
+                evaluated += batchEvaluated;
+            });
+
+            stopwatch.Stop();
+            stats.evaluated = evaluated;
+            stats.updateTimeMs = stopwatch.GetPreciseElapsedTime() * 1000.0;
+        }
+
+        // Baked crowds only pick their frames, far cheaper than dispatching them to the workers
+        uint32_t bakedCount = 0;
+        auto bakedView = registry.view<BakedAnimatorComponent>();
+        for (auto entity : bakedView)
+        {
+            BakedAnimatorComponent& baked = bakedView.get<BakedAnimatorComponent>(entity);
+            if (!baked.baked)
+                continue;
+
+            baked.Time += dt * baked.Speed;
+            if (baked.baked->GetDuration() > 0.0f)
+                baked.Time = std::fmod(baked.Time, baked.baked->GetDuration());
+            baked.Frame = baked.baked->GetFrame(baked.Time);
+            bakedCount++;
+        }
+
+        // Blend shapes go after the animators, so their weights follow the clip times of this frame
+        uint64_t morphedVertices = 0;
+        auto morphView = registry.view<MorphTargetComponent>();
+        for (auto entity : morphView)
+        {
+            MorphTargetComponent& morph = morphView.get<MorphTargetComponent>(entity);
+            if (!morph.Morphed)
+                continue;
+
+            if (const Animator* animator = FindAnimator(registry, entity))
+                animator->SampleMorphWeights(morph.Morphed->GetMesh()->GetMorphTargets().GetChannelName(), morph.Weights);
+
+            morph.Morphed->Update(morph.Weights, morph.MinWeight);
+            morphedVertices += morph.Morphed->GetUploadedVertexCount();
+        }
+
+        TracyPlot("Animated Entities", static_cast<int64_t>(animatedCount));
+        TracyPlot("Morphed Vertices Uploaded", static_cast<int64_t>(morphedVertices));
+        TracyPlot("Baked Entities", static_cast<int64_t>(bakedCount));
+        TracyPlot("Pose Cache Hit Rate", s_PoseCache.GetStats().GetHitRate());
+    }
+
+    BonePalette AnimationSystem::FindBonePalette(const entt::registry& registry, entt::entity entity)
+    {
+        while (entity != entt::null)
+        {
+            if (const AnimatorComponent* animator = registry.try_get<AnimatorComponent>(entity))
+            {
+                const std::vector<glm::mat4>* boneMatrices = animator->GetBoneMatrices();
+                if (!boneMatrices)
+                    return {};
+                return {boneMatrices->data(), nullptr, static_cast<uint32_t>(boneMatrices->size()), 0.0f};
+            }
+
+            if (const BakedAnimatorComponent* baked = registry.try_get<BakedAnimatorComponent>(entity))
+            {
+                if (!baked->baked || !baked->Frame.from)
+                    return {};
+                return {baked->Frame.from, baked->Frame.to, baked->baked->GetBoneCount(), baked->Frame.lerp};
+            }
+
+            const HierarchyComponent* hierarchy = registry.try_get<HierarchyComponent>(entity);
+            entity = hierarchy ? hierarchy->m_Parent : entt::null;
+        }
+        return {};
+    }
+
+}
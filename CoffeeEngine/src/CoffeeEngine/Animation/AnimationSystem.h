@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoffeeEngine/Animation/AnimationLOD.h"
+#include "CoffeeEngine/Animation/AnimationPoseCache.h"
+#include "CoffeeEngine/Core/Base.h"
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    struct AnimatorComponent;
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief The bone palette an entity is drawn with, optionally blended with a second one.
+     */
+    struct BonePalette
+    {
+        const glm::mat4* matrices = nullptr; ///< The palette, nullptr if the entity is not animated.
+        const glm::mat4* nextMatrices = nullptr; ///< The palette blended in by lerp, nullptr if there is none.
+        uint32_t count = 0; ///< The matrices of each palette.
+        float lerp = 0.0f; ///< The weight of nextMatrices.
+    };
+
+    /**
+     * @brief Updates every AnimatorComponent of a registry, in parallel batches on the thread pool.
+     *
+     * Each component only touches its own animator and palette and clips are read only,
+     * so the entities can be evaluated in any order on any thread.
+     * Entities are grouped by animation LOD tier, distant tiers evaluate their pose less often and with fewer bones.
+     * Entities playing the same clip at the same time share their palette through a per-frame AnimationPoseCache.
+     * Entities with a BakedAnimatorComponent only advance their time, their palettes come from the baked table.
+     * Entities with a MorphTargetComponent then sample their blend shape weights and displace their vertices.
+     */
+    class AnimationSystem
+    {
+    public:
+        /**
+         * @brief Advances every animated entity and evaluates its bone matrices.
+         * @param registry The registry holding the AnimatorComponents.
+         * @param dt The elapsed time in seconds.
+         * @param cameraTransform The world transform of the camera the LOD is chosen for.
+         * @param projection The projection of that camera.
+         */
+        static void Update(entt::registry& registry, float dt, const glm::mat4& cameraTransform, const glm::mat4& projection);
+
+        /**
+         * @brief Finds the animator driving an entity: its own or the one of its closest animated ancestor.
+         * @param registry The registry of the entity.
+         * @param entity The entity.
+         * @return The palette of the animator or of the baked animator, empty if the entity is not animated.
+         */
+        static BonePalette FindBonePalette(const entt::registry& registry, entt::entity entity);
+
+        /**
+         * @brief Sets the number of entities updated by a single batch.
+         */
+        static void SetBatchSize(uint32_t batchSize) { s_BatchSize = batchSize; }
+        static uint32_t GetBatchSize() { return s_BatchSize; }
+
+        static void SetLODSettings(const AnimationLODSettings& settings) { s_LODSettings = settings; }
+        static const AnimationLODSettings& GetLODSettings() { return s_LODSettings; }
+
+        /**
+         * @brief Gets the population and cost of every LOD tier in the last update.
+         */
+        static const std::array<AnimationLODStats, kMaxAnimationLODs>& GetLODStats() { return s_LODStats; }
+
+        /**
+         * @brief Gets the pose cache shared by the animated entities, to configure it or read its hit rate.
+         */
+        static AnimationPoseCache& GetPoseCache() { return s_PoseCache; }
+
+    private:
+        static uint32_t s_BatchSize; ///< Entities per batch, large enough to amortize the dispatch.
+        static AnimationLODSettings s_LODSettings;
+        static std::array<AnimationLODStats, kMaxAnimationLODs> s_LODStats;
+        static AnimationPoseCache s_PoseCache;
+        static std::array<std::vector<AnimatorComponent*>, kMaxAnimationLODs> s_Animators; ///< Scratch lists of the components updated this frame, per tier.
+    };
+
+    /** @} */
+}
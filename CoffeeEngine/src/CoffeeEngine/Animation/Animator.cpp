@@ -0,0 +1,270 @@
+#include "CoffeeEngine/Animation/Animator.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    // Current pose, faded out pose and additive sample, plus one reference pose per layer
+    static constexpr uint32_t kScratchPoses = 3;
+
+    void Animator::PlaybackState::Reset(Animation* newAnimation)
+    {
+        animation = newAnimation;
+        time = 0.0f;
+        cursors.assign(animation ? animation->GetBones().size() : 0, Bone::SamplingCursor{});
+    }
+
+    void Animator::PlaybackState::Advance(float dt)
+    {
+        if (!animation)
+            return;
+
+        time += animation->GetTicksPerSecond() * dt;
+        if (animation->GetDuration() > 0.0f)
+            time = fmod(time, animation->GetDuration());
+    }
+
+    Animator::Animator(Animation* animation)
+        : m_DeltaTime(0.0f)
+    {
+        m_Current.Reset(animation);
+        ResetInstanceData();
+    }
+
+    void Animator::UpdateAnimation(float dt, AnimationPoseCache* poseCache)
+    {
+        ZoneScoped;
+
+        m_DeltaTime = dt;
+        if (!m_Current.animation)
+            return;
+
+        m_Current.Advance(dt);
+
+        if (IsCrossFading())
+        {
+            m_Previous.Advance(dt);
+            m_FadeElapsed += dt;
+        }
+
+        for (AdditiveLayer& layer : m_AdditiveLayers)
+        {
+            layer.state.Advance(dt);
+        }
+
+        m_SharedBoneMatrices.reset();
+
+        if (IsCrossFading() || !m_AdditiveLayers.empty())
+        {
+            CalculateBlendedBoneTransforms();
+        }
+        else if (poseCache && poseCache->IsEnabled() && !GetActiveBoneMask())
+        {
+            // Every instance of the key shows the pose of the quantized time, whichever of them evaluated it
+            const Animation& animation = *m_Current.animation;
+            uint32_t step = poseCache->QuantizeTime(animation, m_Current.time);
+            m_SharedBoneMatrices = poseCache->GetOrEvaluate(&animation, step, m_BoneReduction, [&](std::vector<glm::mat4>& palette) {
+                palette.resize(m_FinalBoneMatrices.size());
+                CalculateBoneTransforms(poseCache->GetStepTime(animation, step), palette.data());
+            });
+        }
+        else
+        {
+            CalculateBoneTransforms(m_Current.time, m_FinalBoneMatrices.data());
+        }
+
+        if (IsCrossFading() && m_FadeElapsed >= m_FadeDuration)
+        {
+            m_Previous.Reset(nullptr);
+        }
+    }
+
+    void Animator::PlayAnimation(Animation* pAnimation)
+    {
+        m_Current.Reset(pAnimation);
+        m_Previous.Reset(nullptr);
+        ResetInstanceData();
+    }
+
+    void Animator::CrossFade(Animation* animation, float duration)
+    {
+        if (!m_Current.animation || duration <= 0.0f || !IsCompatible(animation))
+        {
+            PlayAnimation(animation);
+            return;
+        }
+
+        // Fading again mid-fade continues from the clip that was fading in
+        std::swap(m_Previous, m_Current);
+        m_Current.Reset(animation);
+        m_FadeElapsed = 0.0f;
+        m_FadeDuration = duration;
+    }
+
+    int Animator::AddAdditiveLayer(Animation* animation, float weight)
+    {
+        if (!animation || !IsCompatible(animation))
+        {
+            COFFEE_CORE_ERROR("Animator::AddAdditiveLayer: The layer does not match the hierarchy of the current animation");
+            return -1;
+        }
+
+        if (m_AdditiveLayers.size() >= static_cast<size_t>(kMaxAdditiveLayers))
+        {
+            COFFEE_CORE_ERROR("Animator::AddAdditiveLayer: An animator supports up to {0} additive layers", kMaxAdditiveLayers);
+            return -1;
+        }
+
+        AdditiveLayer& layer = m_AdditiveLayers.emplace_back();
+        layer.state.Reset(animation);
+        layer.weight = weight;
+
+        layer.reference = m_PosePool.Acquire();
+        std::vector<Bone::SamplingCursor> referenceCursors(animation->GetBones().size());
+        SamplePose(*animation, 0.0f, referenceCursors.data(), layer.reference);
+
+        return static_cast<int>(m_AdditiveLayers.size()) - 1;
+    }
+
+    void Animator::SetAdditiveLayerWeight(int layer, float weight)
+    {
+        if (layer >= 0 && layer < static_cast<int>(m_AdditiveLayers.size()))
+            m_AdditiveLayers[layer].weight = weight;
+    }
+
+    void Animator::ClearAdditiveLayers()
+    {
+        for (AdditiveLayer& layer : m_AdditiveLayers)
+        {
+            m_PosePool.Release(layer.reference);
+        }
+        m_AdditiveLayers.clear();
+    }
+
+    void Animator::CalculateBoneTransforms(float time, glm::mat4* finalBoneMatrices)
+    {
+        ZoneScoped;
+
+        // Sampled and composed several bones at a time, see SampleSegments and ComposeTransforms
+        const BoneMask* mask = GetActiveBoneMask();
+
+        Pose pose = m_PosePool.Acquire();
+        SamplePose(*m_Current.animation, time, m_Current.cursors.data(), pose, m_BoneReduction, mask);
+        ComputeBoneMatrices(m_Current.animation->GetNodes(), pose, m_GlobalTransforms.data(), finalBoneMatrices, mask);
+        m_PosePool.Release(pose);
+
+        // The whole palette is drawn, the bones the mask skipped must not keep the pose of older frames
+        if (mask)
+            ComputeBindPoseOutsideMask(m_Current.animation->GetNodes(), *mask, m_GlobalTransforms.data(), finalBoneMatrices);
+    }
+
+    void Animator::CalculateBlendedBoneTransforms()
+    {
+        ZoneScoped;
+
+        const BoneMask* mask = GetActiveBoneMask();
+
+        Pose pose = m_PosePool.Acquire();
+        SamplePose(*m_Current.animation, m_Current.time, m_Current.cursors.data(), pose, m_BoneReduction, mask);
+
+        if (IsCrossFading())
+        {
+            Pose previous = m_PosePool.Acquire();
+            SamplePose(*m_Previous.animation, m_Previous.time, m_Previous.cursors.data(), previous, m_BoneReduction, mask);
+
+            float weight = std::clamp(m_FadeElapsed / m_FadeDuration, 0.0f, 1.0f);
+            BlendPoses(previous, pose, weight, pose, mask);
+
+            m_PosePool.Release(previous);
+        }
+
+        if (!m_AdditiveLayers.empty())
+        {
+            Pose additive = m_PosePool.Acquire();
+            for (AdditiveLayer& layer : m_AdditiveLayers)
+            {
+                if (layer.weight <= 0.0f)
+                    continue;
+
+                // Sampled in full like its reference pose, a reduced node would add a bogus difference
+                SamplePose(*layer.state.animation, layer.state.time, layer.state.cursors.data(), additive, 0, mask);
+                AddPose(pose, additive, layer.reference, layer.weight, mask);
+            }
+            m_PosePool.Release(additive);
+        }
+
+        // A single hierarchy pass, however many clips contributed to the pose
+        ComputeBoneMatrices(m_Current.animation->GetNodes(), pose, m_GlobalTransforms.data(), m_FinalBoneMatrices.data(), mask);
+
+        if (mask)
+            ComputeBindPoseOutsideMask(m_Current.animation->GetNodes(), *mask, m_GlobalTransforms.data(), m_FinalBoneMatrices.data());
+
+        m_PosePool.Release(pose);
+    }
+
+    bool Animator::IsCompatible(const Animation* animation) const
+    {
+        return animation && m_Current.animation &&
+            animation->GetNodes().size() == m_Current.animation->GetNodes().size();
+    }
+
+    bool Animator::SampleMorphWeights(const std::string& channel, std::vector<float>& weights) const
+    {
+        const MorphChannel* current = m_Current.animation ? m_Current.animation->FindMorphChannel(channel) : nullptr;
+        const MorphChannel* previous = IsCrossFading() ? m_Previous.animation->FindMorphChannel(channel) : nullptr;
+        if (!current && !previous)
+            return false;
+
+        uint32_t count = static_cast<uint32_t>(weights.size());
+        if (current)
+            current->Sample(m_Current.time, weights.data(), count);
+        else
+            std::fill(weights.begin(), weights.end(), 0.0f);
+
+        if (IsCrossFading())
+        {
+            // A clip that does not animate the mesh fades its weights from or to zero
+            m_FadedMorphWeights.assign(count, 0.0f);
+            if (previous)
+                previous->Sample(m_Previous.time, m_FadedMorphWeights.data(), count);
+
+            float weight = std::clamp(m_FadeElapsed / m_FadeDuration, 0.0f, 1.0f);
+            for (uint32_t t = 0; t < count; t++)
+                weights[t] = m_FadedMorphWeights[t] + (weights[t] - m_FadedMorphWeights[t]) * weight;
+        }
+
+        return true;
+    }
+
+    const BoneMask* Animator::GetActiveBoneMask() const
+    {
+        if (!m_BoneMask || !m_Current.animation || !m_BoneMask->IsCompatible(m_Current.animation->GetSkeleton()->GetHash()))
+            return nullptr;
+        return m_BoneMask.get();
+    }
+
+    void Animator::ResetInstanceData()
+    {
+        size_t boneCount = 100;
+        size_t nodeCount = 0;
+
+        if (m_Current.animation)
+        {
+            boneCount = std::max(boneCount, static_cast<size_t>(m_Current.animation->GetBoneCount()));
+            nodeCount = m_Current.animation->GetNodes().size();
+        }
+
+        m_FinalBoneMatrices.assign(boneCount, glm::mat4(1.0f));
+        m_SharedBoneMatrices.reset();
+        m_GlobalTransforms.assign(nodeCount, glm::mat4(1.0f));
+
+        if (m_PosePool.GetPoseSize() != nodeCount || m_PosePool.GetCapacity() == 0)
+        {
+            // The reference poses live in the pool, so the layers cannot outlive it
+            m_AdditiveLayers.clear();
+            m_PosePool.Reset(static_cast<uint32_t>(nodeCount), kScratchPoses + kMaxAdditiveLayers);
+        }
+    }
+
+}
@@ -6,8 +6,11 @@
 #include <string>
 #include <map>
 #include <cmath>
+#include <algorithm>
 #include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/AnimationPoseCache.h"
 #include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/Pose.h"
 
 
 namespace Coffee {
@@ -15,62 +18,175 @@ namespace Coffee {
     class Animator
     {
     public:
-        Animator(Animation* animation)
-            : m_CurrentTime(0.0f)
-            , m_DeltaTime(0.0f)
-            , m_CurrentAnimation(animation)
-        {
-            m_FinalBoneMatrices.reserve(100);
-            for (int i = 0; i < 100; i++)
-                m_FinalBoneMatrices.push_back(glm::mat4(1.0f));
-        }
+        static constexpr int kMaxAdditiveLayers = 4; ///< The maximum number of additive layers of an animator.
 
-        void UpdateAnimation(float dt)
-        {
-            m_DeltaTime = dt;
-            if (m_CurrentAnimation)
-            {
-                m_CurrentTime += m_CurrentAnimation->GetTicksPerSecond() * dt;
-                m_CurrentTime = fmod(m_CurrentTime, m_CurrentAnimation->GetDuration());
-                CalculateBoneTransform(&m_CurrentAnimation->GetRootNode(), glm::mat4(1.0f));
-            }
-        }
-
-        void PlayAnimation(Animation* pAnimation)
+        Animator(Animation* animation);
+
+        /**
+         * @brief Advances every playing clip and evaluates the final bone matrices.
+         * @param dt The elapsed time in seconds.
+         * @param poseCache The cache shared with the other instances, or nullptr to always evaluate.
+         *                  Only a single clip without crossfade or additive layers goes through the cache.
+         */
+        void UpdateAnimation(float dt, AnimationPoseCache* poseCache = nullptr);
+
+        /**
+         * @brief Plays an animation immediately, cancelling any crossfade.
+         * @param pAnimation The animation to play.
+         */
+        void PlayAnimation(Animation* pAnimation);
+
+        /**
+         * @brief Blends from the current animation to another one over a period of time.
+         *
+         * Both animations must share the same hierarchy (for example clips of the same library),
+         * otherwise the new animation is played immediately.
+         *
+         * @param animation The animation to fade to.
+         * @param duration The duration of the fade in seconds.
+         */
+        void CrossFade(Animation* animation, float duration);
+
+        /**
+         * @brief Adds a clip on top of the current animation.
+         *
+         * The layer adds the difference between the clip and its first frame, weighted by the layer weight.
+         *
+         * @param animation The additive clip. It must share the hierarchy of the current animation.
+         * @param weight The weight of the layer.
+         * @return The index of the layer, or -1 if the layer could not be added.
+         */
+        int AddAdditiveLayer(Animation* animation, float weight = 1.0f);
+
+        /**
+         * @brief Sets the weight of an additive layer.
+         * @param layer The index of the layer.
+         * @param weight The new weight.
+         */
+        void SetAdditiveLayerWeight(int layer, float weight);
+
+        /**
+         * @brief Removes every additive layer.
+         */
+        void ClearAdditiveLayers();
+
+        bool IsCrossFading() const { return m_Previous.animation != nullptr; }
+
+        /**
+         * @brief Sets how many of the short bone chains (fingers, face) keep their bind pose instead of being sampled.
+         * @param boneReduction The reduction level compared to AnimationNode::reductionLevel, 0 samples every bone.
+         */
+        void SetBoneReduction(int boneReduction) { m_BoneReduction = boneReduction; }
+        int GetBoneReduction() const { return m_BoneReduction; }
+
+        /**
+         * @brief Restricts the evaluation to the nodes of a mask, for instances that only need a few joints.
+         *
+         * Only the masked nodes are sampled, the others are given their bind local transform under their parent so the
+         * drawn palette stays whole. The pose cache is bypassed. A mask compiled for another skeleton than the one of the
+         * current animation is ignored.
+         *
+         * @param mask The mask, see Skeleton::GetBoneMask, or nullptr to evaluate every node.
+         */
+        void SetBoneMask(const Ref<BoneMask>& mask) { m_BoneMask = mask; }
+        const Ref<BoneMask>& GetBoneMask() const { return m_BoneMask; }
+
+        /**
+         * @brief Gets the model space transform of a node after the last update.
+         *
+         * Only valid for the nodes of the bone mask, if any, and when the update did not go through the pose cache.
+         *
+         * @param node The index of the node in the skeleton of the current animation.
+         */
+        const glm::mat4& GetNodeTransform(int node) const { return m_GlobalTransforms[node]; }
+
+        /**
+         * @brief Samples the blend shape weights of a morphed mesh at the current time, following the crossfade.
+         *
+         * Additive layers do not contribute to the weights.
+         *
+         * @param channel The channel name of the mesh, see MorphTargetData::GetChannelName.
+         * @param weights Receives the weight of every target, sized for the targets of the mesh.
+         * @return Whether a playing clip animates the mesh, weights is left as it is otherwise.
+         */
+        bool SampleMorphWeights(const std::string& channel, std::vector<float>& weights) const;
+
+        /**
+         * @brief Gets the bone matrices of the last update, shared with other instances if they came from the pose cache.
+         */
+        const std::vector<glm::mat4>& GetFinalBoneMatrices() const { return m_SharedBoneMatrices ? *m_SharedBoneMatrices : m_FinalBoneMatrices; }
+
+    private:
+        /**
+         * @brief The playback state of one clip: the clip, its time and its sampling cursors.
+         */
+        struct PlaybackState
         {
-            m_CurrentAnimation = pAnimation;
-            m_CurrentTime = 0.0f;
-        }
+            Animation* animation = nullptr;
+            float time = 0.0f;
+            std::vector<Bone::SamplingCursor> cursors; ///< One per animation channel.
+
+            void Reset(Animation* newAnimation);
+            void Advance(float dt);
+        };
 
-        void CalculateBoneTransform(const AssimpNodeData* node, glm::mat4 parentTransform)
+        /**
+         * @brief An additive clip and the reference pose it is relative to.
+         */
+        struct AdditiveLayer
         {
-            std::string nodeName = node->name;
-            glm::mat4 nodeTransform = node->transformation;
-            Bone* bone = m_CurrentAnimation->FindBone(nodeName);
-            if (bone)
-            {
-                bone->Update(m_CurrentTime);
-                nodeTransform = bone->GetLocalTransform();
-            }
-            glm::mat4 globalTransformation = parentTransform * nodeTransform;
-            auto boneInfoMap = m_CurrentAnimation->GetBoneIDMap();
-            if (boneInfoMap.find(nodeName) != boneInfoMap.end())
-            {
-                int index = boneInfoMap[nodeName].id;
-                glm::mat4 offset = boneInfoMap[nodeName].offset;
-                m_FinalBoneMatrices[index] = globalTransformation * offset;
-            }
-            for (int i = 0; i < node->childrenCount; i++)
-                CalculateBoneTransform(&node->children[i], globalTransformation);
-        }
-
-        std::vector<glm::mat4> GetFinalBoneMatrices() const { return m_FinalBoneMatrices; }
+            PlaybackState state;
+            Pose reference; ///< The first frame of the clip, owned by the pose pool.
+            float weight = 1.0f;
+        };
+
+        /**
+         * @brief Evaluates the current animation alone, with a pose buffer and a single pass over the hierarchy.
+         *
+         * Used when a single clip is playing.
+         *
+         * @param time The animation time in ticks.
+         * @param finalBoneMatrices The output bone matrices, sized like m_FinalBoneMatrices.
+         */
+        void CalculateBoneTransforms(float time, glm::mat4* finalBoneMatrices);
+
+        /**
+         * @brief Evaluates the current animation, the crossfade and the additive layers through pose buffers.
+         */
+        void CalculateBlendedBoneTransforms();
+
+        bool IsCompatible(const Animation* animation) const;
+
+        /**
+         * @brief Gets the bone mask if it applies to the current animation.
+         */
+        const BoneMask* GetActiveBoneMask() const;
+
+        /**
+         * @brief Sizes the per-instance buffers for the current animation.
+         *
+         * This is the only place where the Animator allocates, so evaluation stays allocation free.
+         */
+        void ResetInstanceData();
 
     private:
         std::vector<glm::mat4> m_FinalBoneMatrices;
-        Animation* m_CurrentAnimation;
-        float m_CurrentTime;
+        Ref<const std::vector<glm::mat4>> m_SharedBoneMatrices; ///< The palette from the pose cache, replaces m_FinalBoneMatrices when set.
+        std::vector<glm::mat4> m_GlobalTransforms; ///< Global transform of every node, indexed like Animation::GetNodes().
+
+        PlaybackState m_Current; ///< The clip being played.
+        PlaybackState m_Previous; ///< The clip being faded out, if any.
+        float m_FadeElapsed = 0.0f;
+        float m_FadeDuration = 0.0f;
+
+        std::vector<AdditiveLayer> m_AdditiveLayers;
+
+        PosePool m_PosePool; ///< Scratch and reference poses, sized for the current hierarchy.
+        int m_BoneReduction = 0;
+        Ref<BoneMask> m_BoneMask; ///< The nodes to evaluate, every node when nullptr.
+        mutable std::vector<float> m_FadedMorphWeights; ///< Scratch weights of the clip being faded out.
+
         float m_DeltaTime;
     };
 
-}
\ No newline at end of file
+}
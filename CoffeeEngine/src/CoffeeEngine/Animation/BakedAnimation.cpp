@@ -0,0 +1,65 @@
+#include "CoffeeEngine/Animation/BakedAnimation.h"
+#include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/Pose.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Coffee {
+
+    Ref<BakedAnimation> BakedAnimation::Bake(const Animation& animation, float frameRate)
+    {
+        ZoneScoped;
+
+        Ref<BakedAnimation> baked = CreateRef<BakedAnimation>();
+        baked->m_Name = animation.GetName();
+        baked->m_BoneCount = static_cast<uint32_t>(animation.GetBoneCount());
+
+        // Clips without a tick rate do not advance in the Animator either, they bake to their first frame
+        float ticksPerSecond = static_cast<float>(animation.GetTicksPerSecond());
+        float duration = ticksPerSecond > 0.0f ? animation.GetDuration() / ticksPerSecond : 0.0f;
+
+        baked->m_FrameCount = std::max(1u, static_cast<uint32_t>(std::lround(duration * std::max(frameRate, 1.0f))));
+        baked->m_Duration = duration;
+        baked->m_FrameRate = duration > 0.0f ? static_cast<float>(baked->m_FrameCount) / duration : frameRate;
+
+        const std::vector<AnimationNode>& nodes = animation.GetNodes();
+        PosePool pool(static_cast<uint32_t>(nodes.size()), 1);
+        Pose pose = pool.Acquire();
+        std::vector<Bone::SamplingCursor> cursors(animation.GetBones().size());
+        std::vector<glm::mat4> globalTransforms(nodes.size());
+
+        baked->m_Palettes.assign(static_cast<size_t>(baked->m_FrameCount) * baked->m_BoneCount, glm::mat4(1.0f));
+        for (uint32_t frame = 0; frame < baked->m_FrameCount; frame++)
+        {
+            float time = duration > 0.0f ? static_cast<float>(frame) / baked->m_FrameRate * ticksPerSecond : 0.0f;
+            SamplePose(animation, time, cursors.data(), pose);
+            ComputeBoneMatrices(nodes, pose, globalTransforms.data(), baked->m_Palettes.data() + static_cast<size_t>(frame) * baked->m_BoneCount);
+        }
+
+        pool.Release(pose);
+        return baked;
+    }
+
+    BakedFrame BakedAnimation::GetFrame(float time) const
+    {
+        if (m_FrameCount == 0)
+            return {};
+
+        if (m_Duration <= 0.0f)
+            return {GetPalette(0), GetPalette(0), 0.0f};
+
+        time = std::fmod(time, m_Duration);
+        if (time < 0.0f)
+            time += m_Duration;
+
+        float position = time * m_FrameRate;
+        uint32_t frame = std::min(static_cast<uint32_t>(position), m_FrameCount - 1);
+        uint32_t next = (frame + 1) % m_FrameCount;
+
+        return {GetPalette(frame), GetPalette(next), std::clamp(position - static_cast<float>(frame), 0.0f, 1.0f)};
+    }
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+
+#include <cereal/access.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    class Animation;
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief Whether and how the clips of a file are baked at import.
+     */
+    struct AnimationBakeSettings
+    {
+        bool enabled = false; ///< Whether the clips are baked into palette tables.
+        float frameRate = 30.0f; ///< The sampling rate of the tables in frames per second.
+    };
+
+    /**
+     * @brief The two baked palettes surrounding a playback time and the weight of the second one.
+     */
+    struct BakedFrame
+    {
+        const glm::mat4* from = nullptr; ///< The palette of the frame before the time.
+        const glm::mat4* to = nullptr; ///< The palette of the frame after the time.
+        float lerp = 0.0f; ///< The weight of the second palette.
+    };
+
+    /**
+     * @brief A looping clip sampled at a fixed rate into final bone palettes.
+     *
+     * Playing a baked clip needs no sampling and no hierarchy work, only a lookup of two frames
+     * and a lerp, which the standard shader does while skinning. Meant for background crowds, which
+     * do not need blending. The palettes live in the AnimationLibrary and its cache file.
+     */
+    class BakedAnimation
+    {
+    public:
+        BakedAnimation() = default;
+
+        /**
+         * @brief Samples a clip into palettes.
+         * @param animation The clip to bake.
+         * @param frameRate The requested frame rate, adjusted so the frames divide the clip evenly.
+         * @return The baked clip.
+         */
+        static Ref<BakedAnimation> Bake(const Animation& animation, float frameRate);
+
+        /**
+         * @brief Gets the frames to draw at a playback time, wrapping around the end of the clip.
+         * @param time The playback time in seconds.
+         */
+        BakedFrame GetFrame(float time) const;
+
+        /**
+         * @brief Gets the palette of a frame.
+         * @param frame The index of the frame.
+         * @return GetBoneCount matrices.
+         */
+        const glm::mat4* GetPalette(uint32_t frame) const { return m_Palettes.data() + static_cast<size_t>(frame) * m_BoneCount; }
+
+        const std::string& GetName() const { return m_Name; }
+        float GetFrameRate() const { return m_FrameRate; }
+        float GetDuration() const { return m_Duration; } ///< The duration in seconds.
+        uint32_t GetFrameCount() const { return m_FrameCount; }
+        uint32_t GetBoneCount() const { return m_BoneCount; }
+
+        /**
+         * @brief Gets the memory used by the palettes in bytes.
+         */
+        size_t GetSize() const { return m_Palettes.size() * sizeof(glm::mat4); }
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(m_Name, m_FrameRate, m_Duration, m_FrameCount, m_BoneCount, m_Palettes);
+        }
+
+    private:
+        std::string m_Name; ///< The name of the source clip.
+        float m_FrameRate = 0.0f; ///< The frames per second.
+        float m_Duration = 0.0f; ///< The duration of the loop in seconds.
+        uint32_t m_FrameCount = 0; ///< The number of frames, the last one blends back into the first.
+        uint32_t m_BoneCount = 0; ///< The matrices of every palette.
+        std::vector<glm::mat4> m_Palettes; ///< The palettes of every frame, one after the other.
+    };
+
+    /** @} */
+}
@@ -5,28 +5,77 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/matrix_interpolation.hpp>
 #include <assimp/scene.h>
+#include "CoffeeEngine/Animation/AnimationCompression.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include <cereal/access.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
 
 namespace Coffee {
+
+    /**
+     * @brief Binding of a bone to the skinned meshes of a model.
+     */
+    struct BoneInfo
+    {
+        int id; ///< The index of the bone in the final bone matrices.
+        glm::mat4 offset; ///< The offset (inverse bind) matrix of the bone.
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(id, offset);
+        }
+    };
+
     class Bone {
     public:
         struct KeyPosition {
             glm::vec3 position;
             float timeStamp;
+
+            template<class Archive>
+            void serialize(Archive& archive) { archive(position, timeStamp); }
         };
 
         struct KeyRotation {
             glm::quat orientation;
             float timeStamp;
+
+            template<class Archive>
+            void serialize(Archive& archive) { archive(orientation, timeStamp); }
         };
 
         struct KeyScale {
             glm::vec3 scale;
             float timeStamp;
+
+            template<class Archive>
+            void serialize(Archive& archive) { archive(scale, timeStamp); }
+        };
+
+        /**
+         * @brief Per-instance playback state that caches the last sampled key of each track.
+         *
+         * Forward playback advances from the cached key (O(1) amortized), while seeks,
+         * loops and reverse playback fall back to a binary search over the timestamps.
+         */
+        struct SamplingCursor {
+            int position = 0;
+            int rotation = 0;
+            int scale = 0;
         };
 
+        /**
+         * @brief Default constructor, used when the bone is deserialized.
+         */
+        Bone() = default;
+
         Bone(const std::string& name, int ID, const aiNodeAnim* channel)
             : m_Name(name), m_ID(ID), m_LocalTransform(1.0f) {
             // Position keys
@@ -70,98 +119,359 @@ namespace Coffee {
             }
         }
 
+        Bone(const std::string& name, int ID, std::vector<KeyPosition> positions,
+             std::vector<KeyRotation> rotations, std::vector<KeyScale> scales)
+            : m_Positions(std::move(positions)), m_Rotations(std::move(rotations)), m_Scales(std::move(scales)),
+              m_LocalTransform(1.0f), m_Name(name), m_ID(ID) {
+            m_NumPositions = static_cast<int>(m_Positions.size());
+            m_NumRotations = static_cast<int>(m_Rotations.size());
+            m_NumScalings = static_cast<int>(m_Scales.size());
+        }
+
+        /**
+         * @brief Samples the bone using its own cursor.
+         * @param animationTime The animation time in ticks.
+         */
         void Update(float animationTime) {
-            m_LocalTransform = InterpolatePosition(animationTime) *
-                InterpolateRotation(animationTime) *
-                InterpolateScaling(animationTime);
+            Update(animationTime, m_Cursor);
+        }
+
+        /**
+         * @brief Samples the bone using a caller-owned cursor.
+         * @param animationTime The animation time in ticks.
+         * @param cursor The playback state of the instance being sampled.
+         */
+        void Update(float animationTime, SamplingCursor& cursor) {
+            m_LocalTransform = Sample(animationTime, cursor);
+        }
+
+        /**
+         * @brief Samples the bone without modifying it, so a clip can be shared between instances.
+         * @param animationTime The animation time in ticks.
+         * @param cursor The playback state of the instance being sampled.
+         * @return The local transform of the bone at the given time.
+         */
+        glm::mat4 Sample(float animationTime, SamplingCursor& cursor) const {
+            glm::vec3 position, scale;
+            glm::quat rotation;
+            Sample(animationTime, cursor, position, rotation, scale);
+
+            return glm::translate(glm::mat4(1.0f), position) *
+                glm::toMat4(rotation) *
+                glm::scale(glm::mat4(1.0f), scale);
+        }
+
+        /**
+         * @brief Samples the translation, rotation and scale of the bone.
+         * @param animationTime The animation time in ticks.
+         * @param cursor The playback state of the instance being sampled.
+         * @param position The sampled translation.
+         * @param rotation The sampled (normalized) rotation.
+         * @param scale The sampled scale.
+         */
+        void Sample(float animationTime, SamplingCursor& cursor, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) const {
+            if (m_Compressed) {
+                position = SampleTrack(m_CompressedPositions, animationTime, cursor.position);
+                rotation = SampleTrack(m_CompressedRotations, animationTime, cursor.rotation);
+                scale = SampleTrack(m_CompressedScales, animationTime, cursor.scale);
+            }
+            else {
+                position = InterpolatePosition(animationTime, cursor.position);
+                rotation = InterpolateRotation(animationTime, cursor.rotation);
+                scale = InterpolateScaling(animationTime, cursor.scale);
+            }
+        }
+
+        /**
+         * @brief The keys surrounding a sampling time and the interpolation factor of every track.
+         *
+         * Single-key tracks repeat their key with a zero factor. Interpolating the segment gives
+         * the result of Sample, which SampleSegments does for several bones at once.
+         */
+        struct Segment {
+            glm::vec3 position0, position1;
+            float positionFactor;
+            glm::quat rotation0, rotation1;
+            float rotationFactor;
+            glm::vec3 scale0, scale1;
+            float scaleFactor;
+        };
+
+        /**
+         * @brief Finds the keys of every track surrounding a time, without interpolating them.
+         * @param animationTime The animation time in ticks.
+         * @param cursor The playback state of the instance being sampled.
+         * @param segment The keys and interpolation factors.
+         */
+        void GetSegment(float animationTime, SamplingCursor& cursor, Segment& segment) const {
+            if (m_Compressed) {
+                GetTrackSegment(m_CompressedPositions, animationTime, cursor.position, segment.position0, segment.position1, segment.positionFactor);
+                GetTrackSegment(m_CompressedRotations, animationTime, cursor.rotation, segment.rotation0, segment.rotation1, segment.rotationFactor);
+                GetTrackSegment(m_CompressedScales, animationTime, cursor.scale, segment.scale0, segment.scale1, segment.scaleFactor);
+            }
+            else {
+                GetKeySegment(m_Positions, &KeyPosition::position, animationTime, cursor.position, segment.position0, segment.position1, segment.positionFactor);
+                GetKeySegment(m_Rotations, &KeyRotation::orientation, animationTime, cursor.rotation, segment.rotation0, segment.rotation1, segment.rotationFactor);
+                GetKeySegment(m_Scales, &KeyScale::scale, animationTime, cursor.scale, segment.scale0, segment.scale1, segment.scaleFactor);
+            }
+        }
+
+        /**
+         * @brief Replaces the keys of the bone with compressed tracks.
+         *
+         * Keys within the tolerance of their interpolated neighbours are removed, positions and
+         * scales are range-reduced to 16 bits and rotations use smallest-three quantization.
+         * The error is measured against the original keys before they are released.
+         *
+         * @param settings The error tolerances.
+         * @return The memory and error report of this bone.
+         */
+        AnimationCompressionStats Compress(const AnimationCompressionSettings& settings) {
+            AnimationCompressionStats stats;
+            if (m_Compressed)
+                return stats;
+
+            stats.rawBytes = GetMemoryUsage();
+            stats.rawKeys = m_NumPositions + m_NumRotations + m_NumScalings;
+
+            std::vector<float> times;
+            std::vector<glm::vec3> vectors;
+            std::vector<glm::quat> quats;
+
+            for (const auto& key : m_Positions) { times.push_back(key.timeStamp); vectors.push_back(key.position); }
+            m_CompressedPositions = CompressedVec3Track::Compress(times, vectors, settings.positionTolerance);
+            times.clear(); vectors.clear();
+
+            for (const auto& key : m_Rotations) { times.push_back(key.timeStamp); quats.push_back(key.orientation); }
+            m_CompressedRotations = CompressedQuatTrack::Compress(times, quats, settings.rotationTolerance);
+            times.clear();
+
+            for (const auto& key : m_Scales) { times.push_back(key.timeStamp); vectors.push_back(key.scale); }
+            m_CompressedScales = CompressedVec3Track::Compress(times, vectors, settings.scaleTolerance);
+
+            // Measure the error of the compressed tracks at every original key
+            SamplingCursor cursor;
+            for (const auto& key : m_Positions)
+                stats.maxPositionError = std::max(stats.maxPositionError, glm::length(SampleTrack(m_CompressedPositions, key.timeStamp, cursor.position) - key.position));
+            for (const auto& key : m_Rotations)
+                stats.maxRotationError = std::max(stats.maxRotationError, QuatAngularDistance(SampleTrack(m_CompressedRotations, key.timeStamp, cursor.rotation), key.orientation));
+            for (const auto& key : m_Scales)
+                stats.maxScaleError = std::max(stats.maxScaleError, glm::length(SampleTrack(m_CompressedScales, key.timeStamp, cursor.scale) - key.scale));
+
+            m_Positions = {};
+            m_Rotations = {};
+            m_Scales = {};
+            m_Compressed = true;
+
+            stats.compressedBytes = GetMemoryUsage();
+            stats.compressedKeys = m_CompressedPositions.GetKeyCount() + m_CompressedRotations.GetKeyCount() + m_CompressedScales.GetKeyCount();
+            return stats;
         }
 
+        /**
+         * @brief Gets the memory used by the keys of the bone.
+         * @return The size in bytes of the raw or compressed tracks.
+         */
+        size_t GetMemoryUsage() const {
+            if (m_Compressed)
+                return m_CompressedPositions.GetMemoryUsage() + m_CompressedRotations.GetMemoryUsage() + m_CompressedScales.GetMemoryUsage();
+
+            return m_Positions.capacity() * sizeof(KeyPosition) +
+                m_Rotations.capacity() * sizeof(KeyRotation) +
+                m_Scales.capacity() * sizeof(KeyScale);
+        }
+
+        bool IsCompressed() const { return m_Compressed; }
+
         glm::mat4 GetLocalTransform() const { return m_LocalTransform; }
         std::string GetBoneName() const { return m_Name; }
         int GetBoneID() const { return m_ID; }
 
+        const std::vector<KeyPosition>& GetPositionKeys() const { return m_Positions; }
+        const std::vector<KeyRotation>& GetRotationKeys() const { return m_Rotations; }
+        const std::vector<KeyScale>& GetScaleKeys() const { return m_Scales; }
+
     private:
-        int GetPositionIndex(float animationTime) const {
-            for (int index = 0; index < m_NumPositions - 1; ++index) {
-                if (animationTime < m_Positions[index + 1].timeStamp)
-                    return index;
-            }
-            return m_NumPositions - 1;
+        friend class cereal::access;
+
+        template<class Archive>
+        void save(Archive& archive) const
+        {
+            archive(m_Name, m_ID, m_Compressed);
+            if (m_Compressed)
+                archive(m_CompressedPositions, m_CompressedRotations, m_CompressedScales);
+            else
+                archive(m_Positions, m_Rotations, m_Scales);
         }
 
-        int GetRotationIndex(float animationTime) const {
-            for (int index = 0; index < m_NumRotations - 1; ++index) {
-                if (animationTime < m_Rotations[index + 1].timeStamp)
-                    return index;
-            }
-            return m_NumRotations - 1;
+        template<class Archive>
+        void load(Archive& archive)
+        {
+            archive(m_Name, m_ID, m_Compressed);
+            if (m_Compressed)
+                archive(m_CompressedPositions, m_CompressedRotations, m_CompressedScales);
+            else
+                archive(m_Positions, m_Rotations, m_Scales);
+
+            m_NumPositions = static_cast<int>(m_Positions.size());
+            m_NumRotations = static_cast<int>(m_Rotations.size());
+            m_NumScalings = static_cast<int>(m_Scales.size());
+            m_LocalTransform = glm::mat4(1.0f);
         }
 
-        int GetScaleIndex(float animationTime) const {
-            for (int index = 0; index < m_NumScalings - 1; ++index) {
-                if (animationTime < m_Scales[index + 1].timeStamp)
-                    return index;
+        /**
+         * @brief Finds the key segment [index, index + 1] that contains the given time.
+         *
+         * Checks the cached segment and the one after it before falling back to a binary search.
+         * The returned index is always a valid segment start, so index + 1 can be read safely.
+         *
+         * @param keyCount The number of keys of the track. Must be at least two.
+         * @param timeAt Returns the timestamp of a key.
+         * @param animationTime The animation time in ticks.
+         * @param cursor The cached segment, updated with the result.
+         * @return The index of the first key of the segment.
+         */
+        template<typename TimeAt>
+        static int FindKeyIndex(int keyCount, TimeAt timeAt, float animationTime, int& cursor) {
+            const int lastSegment = keyCount - 2;
+            const int index = std::clamp(cursor, 0, lastSegment);
+
+            if (animationTime >= timeAt(index)) {
+                if (index == lastSegment || animationTime < timeAt(index + 1))
+                    return cursor = index;
+                if (index + 1 == lastSegment || animationTime < timeAt(index + 2))
+                    return cursor = index + 1;
             }
-            return m_NumScalings - 1;
+
+            // Last key at or before animationTime, limited to valid segment starts
+            int low = 0;
+            int high = lastSegment;
+            while (low < high) {
+                int mid = (low + high + 1) / 2;
+                if (timeAt(mid) <= animationTime)
+                    low = mid;
+                else
+                    high = mid - 1;
+            }
+            return cursor = low;
+        }
+
+        template<typename Key>
+        static int FindKeyIndex(const std::vector<Key>& keys, float animationTime, int& cursor) {
+            return FindKeyIndex(static_cast<int>(keys.size()), [&](int i) { return keys[i].timeStamp; }, animationTime, cursor);
         }
 
-        float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime) const {
+        static float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime) {
             float midWayLength = animationTime - lastTimeStamp;
             float framesDiff = nextTimeStamp - lastTimeStamp;
-            return midWayLength / framesDiff;
+            if (framesDiff <= 0.0f)
+                return 0.0f;
+            return glm::clamp(midWayLength / framesDiff, 0.0f, 1.0f);
         }
 
-        glm::mat4 InterpolatePosition(float animationTime) const {
+        static glm::vec3 SampleTrack(const CompressedVec3Track& track, float animationTime, int& cursor) {
+            const int keyCount = track.GetKeyCount();
+            if (keyCount == 1)
+                return track.Decode(0);
+
+            int p0Index = FindKeyIndex(keyCount, [&](int i) { return track.times[i]; }, animationTime, cursor);
+            int p1Index = p0Index + 1;
+            float scaleFactor = GetScaleFactor(track.times[p0Index], track.times[p1Index], animationTime);
+            return glm::mix(track.Decode(p0Index), track.Decode(p1Index), scaleFactor);
+        }
+
+        static glm::quat SampleTrack(const CompressedQuatTrack& track, float animationTime, int& cursor) {
+            const int keyCount = track.GetKeyCount();
+            if (keyCount == 1)
+                return track.Decode(0);
+
+            int p0Index = FindKeyIndex(keyCount, [&](int i) { return track.times[i]; }, animationTime, cursor);
+            int p1Index = p0Index + 1;
+            float scaleFactor = GetScaleFactor(track.times[p0Index], track.times[p1Index], animationTime);
+            return glm::normalize(glm::slerp(track.Decode(p0Index), track.Decode(p1Index), scaleFactor));
+        }
+
+        template<typename Key, typename Value>
+        static void GetKeySegment(const std::vector<Key>& keys, Value Key::* value, float animationTime, int& cursor, Value& value0, Value& value1, float& factor) {
+            if (keys.size() == 1) {
+                value0 = value1 = keys[0].*value;
+                factor = 0.0f;
+                return;
+            }
+
+            int p0Index = FindKeyIndex(keys, animationTime, cursor);
+            value0 = keys[p0Index].*value;
+            value1 = keys[p0Index + 1].*value;
+            factor = GetScaleFactor(keys[p0Index].timeStamp, keys[p0Index + 1].timeStamp, animationTime);
+        }
+
+        template<typename Track, typename Value>
+        static void GetTrackSegment(const Track& track, float animationTime, int& cursor, Value& value0, Value& value1, float& factor) {
+            const int keyCount = track.GetKeyCount();
+            if (keyCount == 1) {
+                value0 = value1 = track.Decode(0);
+                factor = 0.0f;
+                return;
+            }
+
+            int p0Index = FindKeyIndex(keyCount, [&](int i) { return track.times[i]; }, animationTime, cursor);
+            value0 = track.Decode(p0Index);
+            value1 = track.Decode(p0Index + 1);
+            factor = GetScaleFactor(track.times[p0Index], track.times[p0Index + 1], animationTime);
+        }
+
+        glm::vec3 InterpolatePosition(float animationTime, int& cursor) const {
             if (m_NumPositions == 1)
-                return glm::translate(glm::mat4(1.0f), m_Positions[0].position);
+                return m_Positions[0].position;
 
-            int p0Index = GetPositionIndex(animationTime);
+            int p0Index = FindKeyIndex(m_Positions, animationTime, cursor);
             int p1Index = p0Index + 1;
             float scaleFactor = GetScaleFactor(m_Positions[p0Index].timeStamp,
                 m_Positions[p1Index].timeStamp, animationTime);
-            glm::vec3 finalPosition = glm::mix(m_Positions[p0Index].position,
+            return glm::mix(m_Positions[p0Index].position,
                 m_Positions[p1Index].position, scaleFactor);
-            return glm::translate(glm::mat4(1.0f), finalPosition);
         }
 
-        glm::mat4 InterpolateRotation(float animationTime) const {
-            if (m_NumRotations == 1) {
-                auto rotation = glm::normalize(m_Rotations[0].orientation);
-                return glm::toMat4(rotation);
-            }
+        glm::quat InterpolateRotation(float animationTime, int& cursor) const {
+            if (m_NumRotations == 1)
+                return glm::normalize(m_Rotations[0].orientation);
 
-            int p0Index = GetRotationIndex(animationTime);
+            int p0Index = FindKeyIndex(m_Rotations, animationTime, cursor);
             int p1Index = p0Index + 1;
             float scaleFactor = GetScaleFactor(m_Rotations[p0Index].timeStamp,
                 m_Rotations[p1Index].timeStamp, animationTime);
             glm::quat finalRotation = glm::slerp(m_Rotations[p0Index].orientation,
                 m_Rotations[p1Index].orientation, scaleFactor);
-            finalRotation = glm::normalize(finalRotation);
-            return glm::toMat4(finalRotation);
+            return glm::normalize(finalRotation);
         }
 
-        glm::mat4 InterpolateScaling(float animationTime) const {
+        glm::vec3 InterpolateScaling(float animationTime, int& cursor) const {
             if (m_NumScalings == 1)
-                return glm::scale(glm::mat4(1.0f), m_Scales[0].scale);
+                return m_Scales[0].scale;
 
-            int p0Index = GetScaleIndex(animationTime);
+            int p0Index = FindKeyIndex(m_Scales, animationTime, cursor);
             int p1Index = p0Index + 1;
             float scaleFactor = GetScaleFactor(m_Scales[p0Index].timeStamp,
                 m_Scales[p1Index].timeStamp, animationTime);
-            glm::vec3 finalScale = glm::mix(m_Scales[p0Index].scale,
+            return glm::mix(m_Scales[p0Index].scale,
                 m_Scales[p1Index].scale, scaleFactor);
-            return glm::scale(glm::mat4(1.0f), finalScale);
         }
 
         std::vector<KeyPosition> m_Positions;
         std::vector<KeyRotation> m_Rotations;
         std::vector<KeyScale> m_Scales;
-        int m_NumPositions;
-        int m_NumRotations;
-        int m_NumScalings;
+        int m_NumPositions = 0;
+        int m_NumRotations = 0;
+        int m_NumScalings = 0;
+
+        bool m_Compressed = false; ///< Whether the keys live in the compressed tracks.
+        CompressedVec3Track m_CompressedPositions; ///< Compressed position track, used when m_Compressed is set.
+        CompressedQuatTrack m_CompressedRotations; ///< Compressed rotation track, used when m_Compressed is set.
+        CompressedVec3Track m_CompressedScales; ///< Compressed scale track, used when m_Compressed is set.
 
-        glm::mat4 m_LocalTransform;
+        glm::mat4 m_LocalTransform = glm::mat4(1.0f);
         std::string m_Name;
-        int m_ID;
+        int m_ID = -1;
+        SamplingCursor m_Cursor; ///< Cursor used by Update(float) when the caller does not own one.
     };
 }
\ No newline at end of file
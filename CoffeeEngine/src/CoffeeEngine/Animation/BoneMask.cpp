@@ -0,0 +1,31 @@
+#include "CoffeeEngine/Animation/BoneMask.h"
+#include "CoffeeEngine/Animation/Skeleton.h"
+
+namespace Coffee {
+
+    BoneMask::BoneMask(const Skeleton& skeleton, const std::vector<int>& nodes)
+    {
+        const std::vector<AnimationNode>& skeletonNodes = skeleton.GetNodes();
+
+        m_NodeCount = static_cast<uint32_t>(skeletonNodes.size());
+        m_Bits.assign((m_NodeCount + 63) / 64, 0);
+        m_SkeletonHash = skeleton.GetHash();
+
+        // Walk up from every requested node, stopping at the first ancestor already added by another one
+        for (int node : nodes)
+        {
+            while (node >= 0 && node < static_cast<int>(m_NodeCount) && !Contains(node))
+            {
+                m_Bits[node / 64] |= uint64_t(1) << (node % 64);
+                node = skeletonNodes[node].parentIndex;
+            }
+        }
+
+        for (uint32_t node = 0; node < m_NodeCount; node++)
+        {
+            if (Contains(node))
+                m_Nodes.push_back(node);
+        }
+    }
+
+}
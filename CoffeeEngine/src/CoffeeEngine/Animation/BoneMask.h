@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    class Skeleton;
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief The nodes of a skeleton needed to evaluate a few of them: the requested nodes and their ancestors.
+     *
+     * Poses evaluated with a mask are only valid for the nodes of the mask, which is enough for sockets,
+     * aiming or hitboxes. Masks are compiled once per request set by Skeleton::GetBoneMask.
+     */
+    class BoneMask
+    {
+    public:
+        BoneMask() = default;
+
+        /**
+         * @brief Compiles a mask.
+         * @param skeleton The skeleton the nodes belong to.
+         * @param nodes The indices of the requested nodes.
+         */
+        BoneMask(const Skeleton& skeleton, const std::vector<int>& nodes);
+
+        /**
+         * @brief Gets the nodes of the mask.
+         * @return The node indices in increasing order, so parents come before their children.
+         */
+        const std::vector<uint32_t>& GetNodes() const { return m_Nodes; }
+
+        /**
+         * @brief Whether a node belongs to the mask.
+         * @param node The index of the node.
+         */
+        bool Contains(uint32_t node) const { return node < m_NodeCount && (m_Bits[node / 64] >> (node % 64)) & 1; }
+
+        /**
+         * @brief Whether the mask was compiled for a skeleton, see Skeleton::GetHash.
+         * @param skeletonHash The hash of the skeleton.
+         */
+        bool IsCompatible(uint64_t skeletonHash) const { return m_SkeletonHash == skeletonHash; }
+
+    private:
+        std::vector<uint32_t> m_Nodes; ///< The requested nodes and their ancestors, in increasing order.
+        std::vector<uint64_t> m_Bits; ///< One bit per node of the skeleton.
+        uint32_t m_NodeCount = 0; ///< The nodes of the skeleton.
+        uint64_t m_SkeletonHash = 0; ///< The hash of the skeleton the mask was compiled for.
+    };
+
+    /** @} */
+}
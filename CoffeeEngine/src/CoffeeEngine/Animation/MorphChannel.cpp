@@ -0,0 +1,61 @@
+#include "CoffeeEngine/Animation/MorphChannel.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Coffee {
+
+    MorphChannel::MorphChannel(const aiMeshMorphAnim* channel)
+        : m_Name(channel->mName.C_Str())
+    {
+        for (uint32_t k = 0; k < channel->mNumKeys; k++)
+        {
+            const aiMeshMorphKey& key = channel->mKeys[k];
+            for (uint32_t i = 0; i < key.mNumValuesAndWeights; i++)
+                m_TargetCount = std::max(m_TargetCount, key.mValues[i] + 1);
+        }
+
+        m_Times.reserve(channel->mNumKeys);
+        m_Weights.assign(static_cast<size_t>(channel->mNumKeys) * m_TargetCount, 0.0f);
+        for (uint32_t k = 0; k < channel->mNumKeys; k++)
+        {
+            const aiMeshMorphKey& key = channel->mKeys[k];
+            m_Times.push_back(static_cast<float>(key.mTime));
+            for (uint32_t i = 0; i < key.mNumValuesAndWeights; i++)
+                m_Weights[static_cast<size_t>(k) * m_TargetCount + key.mValues[i]] = static_cast<float>(key.mWeights[i]);
+        }
+    }
+
+    MorphChannel::MorphChannel(std::string name, uint32_t targetCount, std::vector<float> times, std::vector<float> weights)
+        : m_Name(std::move(name)), m_TargetCount(targetCount), m_Times(std::move(times)), m_Weights(std::move(weights))
+    {
+    }
+
+    void MorphChannel::Sample(float time, float* weights, uint32_t count) const
+    {
+        std::fill(weights, weights + count, 0.0f);
+        if (m_Times.empty())
+            return;
+
+        uint32_t targets = std::min(count, m_TargetCount);
+
+        // Few keys per channel, a binary search is cheaper than keeping a cursor per instance
+        size_t next = std::upper_bound(m_Times.begin(), m_Times.end(), time) - m_Times.begin();
+        if (next == 0 || next == m_Times.size())
+        {
+            const float* key = &m_Weights[(next == 0 ? 0 : next - 1) * m_TargetCount];
+            std::copy(key, key + targets, weights);
+            return;
+        }
+
+        size_t previous = next - 1;
+        float span = m_Times[next] - m_Times[previous];
+        float factor = span > 0.0f ? (time - m_Times[previous]) / span : 0.0f;
+
+        const float* from = &m_Weights[previous * m_TargetCount];
+        const float* to = &m_Weights[next * m_TargetCount];
+        for (uint32_t t = 0; t < targets; t++)
+            weights[t] = from[t] + (to[t] - from[t]) * factor;
+    }
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <assimp/anim.h>
+#include <cereal/access.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief The animated blend shape weights of one morphed mesh in a clip.
+     *
+     * Keys store the weight of every target of the mesh, so sampling is a lerp of two rows.
+     * The channel is bound to the meshes whose MorphTargetData::GetChannelName matches its name.
+     */
+    class MorphChannel
+    {
+    public:
+        MorphChannel() = default;
+
+        /**
+         * @brief Reads the keys of an Assimp morph channel, the targets missing from a key get a zero weight.
+         * @param channel The channel.
+         */
+        MorphChannel(const aiMeshMorphAnim* channel);
+
+        /**
+         * @brief Builds a channel from its keys, for procedural or synthetic clips.
+         * @param name The name of the channel.
+         * @param targetCount The targets of every key.
+         * @param times The time of every key in ticks, in increasing order.
+         * @param weights targetCount weights per key.
+         */
+        MorphChannel(std::string name, uint32_t targetCount, std::vector<float> times, std::vector<float> weights);
+
+        /**
+         * @brief Samples the weights at a time, holding the first and last keys outside of the channel.
+         * @param time The time in ticks.
+         * @param weights Receives the weight of the first count targets, the targets the channel does not have get zero.
+         * @param count The targets of the mesh.
+         */
+        void Sample(float time, float* weights, uint32_t count) const;
+
+        const std::string& GetName() const { return m_Name; }
+        uint32_t GetTargetCount() const { return m_TargetCount; }
+        uint32_t GetKeyCount() const { return static_cast<uint32_t>(m_Times.size()); }
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(m_Name, m_TargetCount, m_Times, m_Weights);
+        }
+
+    private:
+        std::string m_Name; ///< The channel name of the animated meshes.
+        uint32_t m_TargetCount = 0; ///< The weights of a key.
+        std::vector<float> m_Times; ///< The time of every key in ticks.
+        std::vector<float> m_Weights; ///< m_TargetCount weights per key.
+    };
+
+    /** @} */
+}
@@ -0,0 +1,440 @@
+#include "CoffeeEngine/Animation/Pose.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+    #define COFFEE_SAMPLING_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define COFFEE_SAMPLING_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace Coffee {
+
+    namespace {
+
+        // One float of several bones, the width matches the widest instruction set of the build
+#if defined(COFFEE_SAMPLING_AVX2)
+        struct Lanes
+        {
+            static constexpr uint32_t kWidth = 8;
+            __m256 v;
+
+            static Lanes Load(const float* p) { return {_mm256_load_ps(p)}; }
+            static Lanes Set(float x) { return {_mm256_set1_ps(x)}; }
+            void Store(float* p) const { _mm256_store_ps(p, v); }
+        };
+
+        inline Lanes operator+(Lanes a, Lanes b) { return {_mm256_add_ps(a.v, b.v)}; }
+        inline Lanes operator-(Lanes a, Lanes b) { return {_mm256_sub_ps(a.v, b.v)}; }
+        inline Lanes operator*(Lanes a, Lanes b) { return {_mm256_mul_ps(a.v, b.v)}; }
+        inline Lanes SignBits(Lanes a) { return {_mm256_and_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+        inline Lanes Xor(Lanes a, Lanes b) { return {_mm256_xor_ps(a.v, b.v)}; }
+        inline Lanes ApproxRsqrt(Lanes a) { return {_mm256_rsqrt_ps(a.v)}; }
+#elif defined(COFFEE_SAMPLING_SSE2)
+        struct Lanes
+        {
+            static constexpr uint32_t kWidth = 4;
+            __m128 v;
+
+            static Lanes Load(const float* p) { return {_mm_load_ps(p)}; }
+            static Lanes Set(float x) { return {_mm_set1_ps(x)}; }
+            void Store(float* p) const { _mm_store_ps(p, v); }
+        };
+
+        inline Lanes operator+(Lanes a, Lanes b) { return {_mm_add_ps(a.v, b.v)}; }
+        inline Lanes operator-(Lanes a, Lanes b) { return {_mm_sub_ps(a.v, b.v)}; }
+        inline Lanes operator*(Lanes a, Lanes b) { return {_mm_mul_ps(a.v, b.v)}; }
+        inline Lanes SignBits(Lanes a) { return {_mm_and_ps(a.v, _mm_set1_ps(-0.0f))}; }
+        inline Lanes Xor(Lanes a, Lanes b) { return {_mm_xor_ps(a.v, b.v)}; }
+        inline Lanes ApproxRsqrt(Lanes a) { return {_mm_rsqrt_ps(a.v)}; }
+#else
+        // Plain loops over four floats, which compilers vectorize for the instruction set they target
+        struct Lanes
+        {
+            static constexpr uint32_t kWidth = 4;
+            float v[4];
+
+            static Lanes Load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+            static Lanes Set(float x) { return {{x, x, x, x}}; }
+            void Store(float* p) const { std::copy(v, v + 4, p); }
+        };
+
+        template<typename Op>
+        inline Lanes Map(Lanes a, Lanes b, Op op) { return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3])}}; }
+
+        inline Lanes operator+(Lanes a, Lanes b) { return Map(a, b, [](float x, float y) { return x + y; }); }
+        inline Lanes operator-(Lanes a, Lanes b) { return Map(a, b, [](float x, float y) { return x - y; }); }
+        inline Lanes operator*(Lanes a, Lanes b) { return Map(a, b, [](float x, float y) { return x * y; }); }
+        inline Lanes SignBits(Lanes a) { return Map(a, a, [](float x, float) { return std::signbit(x) ? -0.0f : 0.0f; }); }
+        inline Lanes Xor(Lanes a, Lanes b) { return Map(a, b, [](float x, float sign) { return std::signbit(sign) ? -x : x; }); }
+        inline Lanes ApproxRsqrt(Lanes a) { return Map(a, a, [](float x, float) { return 1.0f / std::sqrt(x); }); }
+#endif
+
+        // The hardware estimate has 12 bits, one Newton-Raphson step brings it close to full precision
+        inline Lanes Rsqrt(Lanes a)
+        {
+            Lanes y = ApproxRsqrt(a);
+            return y * (Lanes::Set(1.5f) - Lanes::Set(0.5f) * a * y * y);
+        }
+
+        inline Lanes Mix(Lanes a, Lanes b, Lanes t)
+        {
+            return a + (b - a) * t;
+        }
+
+        constexpr uint32_t kLaneWidth = Lanes::kWidth;
+
+        // cos(22.5 degrees): keys up to 45 degrees apart, where the nlerp error stays under 0.12 degrees
+        constexpr float kNlerpMinDot = 0.9238795f;
+
+        // Every node of a pose, or only those of a mask
+        template<typename Fn>
+        inline void ForEachNode(uint32_t size, const BoneMask* mask, Fn&& fn)
+        {
+            if (!mask)
+            {
+                for (uint32_t i = 0; i < size; i++)
+                    fn(i);
+                return;
+            }
+
+            for (uint32_t i : mask->GetNodes())
+            {
+                if (i < size)
+                    fn(i);
+            }
+        }
+
+    }
+
+    void SampleSegments(const Bone::Segment* segments, uint32_t count, glm::vec3* translations, glm::quat* rotations, glm::vec3* scales)
+    {
+        enum { P0X, P0Y, P0Z, P1X, P1Y, P1Z, PT, R0X, R0Y, R0Z, R0W, R1X, R1Y, R1Z, R1W, RT, S0X, S0Y, S0Z, S1X, S1Y, S1Z, ST, InputCount };
+        enum { TX, TY, TZ, RX, RY, RZ, RW, SX, SY, SZ, Dot, OutputCount };
+
+        alignas(32) float in[InputCount][kLaneWidth];
+        alignas(32) float out[OutputCount][kLaneWidth];
+
+        for (uint32_t first = 0; first < count; first += kLaneWidth)
+        {
+            const uint32_t laneCount = std::min(kLaneWidth, count - first);
+
+            // Transpose to one array per component, the lanes past the end repeat the last segment
+            for (uint32_t lane = 0; lane < kLaneWidth; lane++)
+            {
+                const Bone::Segment& segment = segments[first + std::min(lane, laneCount - 1)];
+                in[P0X][lane] = segment.position0.x; in[P0Y][lane] = segment.position0.y; in[P0Z][lane] = segment.position0.z;
+                in[P1X][lane] = segment.position1.x; in[P1Y][lane] = segment.position1.y; in[P1Z][lane] = segment.position1.z;
+                in[PT][lane] = segment.positionFactor;
+                in[R0X][lane] = segment.rotation0.x; in[R0Y][lane] = segment.rotation0.y; in[R0Z][lane] = segment.rotation0.z; in[R0W][lane] = segment.rotation0.w;
+                in[R1X][lane] = segment.rotation1.x; in[R1Y][lane] = segment.rotation1.y; in[R1Z][lane] = segment.rotation1.z; in[R1W][lane] = segment.rotation1.w;
+                in[RT][lane] = segment.rotationFactor;
+                in[S0X][lane] = segment.scale0.x; in[S0Y][lane] = segment.scale0.y; in[S0Z][lane] = segment.scale0.z;
+                in[S1X][lane] = segment.scale1.x; in[S1Y][lane] = segment.scale1.y; in[S1Z][lane] = segment.scale1.z;
+                in[ST][lane] = segment.scaleFactor;
+            }
+
+            Lanes pt = Lanes::Load(in[PT]);
+            Mix(Lanes::Load(in[P0X]), Lanes::Load(in[P1X]), pt).Store(out[TX]);
+            Mix(Lanes::Load(in[P0Y]), Lanes::Load(in[P1Y]), pt).Store(out[TY]);
+            Mix(Lanes::Load(in[P0Z]), Lanes::Load(in[P1Z]), pt).Store(out[TZ]);
+
+            Lanes st = Lanes::Load(in[ST]);
+            Mix(Lanes::Load(in[S0X]), Lanes::Load(in[S1X]), st).Store(out[SX]);
+            Mix(Lanes::Load(in[S0Y]), Lanes::Load(in[S1Y]), st).Store(out[SY]);
+            Mix(Lanes::Load(in[S0Z]), Lanes::Load(in[S1Z]), st).Store(out[SZ]);
+
+            // Normalized lerp, with the second key flipped to the hemisphere of the first for the shortest path
+            Lanes r0x = Lanes::Load(in[R0X]), r0y = Lanes::Load(in[R0Y]), r0z = Lanes::Load(in[R0Z]), r0w = Lanes::Load(in[R0W]);
+            Lanes r1x = Lanes::Load(in[R1X]), r1y = Lanes::Load(in[R1Y]), r1z = Lanes::Load(in[R1Z]), r1w = Lanes::Load(in[R1W]);
+            Lanes dot = r0x * r1x + r0y * r1y + r0z * r1z + r0w * r1w;
+            Lanes sign = SignBits(dot);
+            Xor(dot, sign).Store(out[Dot]);
+
+            Lanes rt = Lanes::Load(in[RT]);
+            Lanes qx = Mix(r0x, Xor(r1x, sign), rt);
+            Lanes qy = Mix(r0y, Xor(r1y, sign), rt);
+            Lanes qz = Mix(r0z, Xor(r1z, sign), rt);
+            Lanes qw = Mix(r0w, Xor(r1w, sign), rt);
+            Lanes inverseLength = Rsqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+            (qx * inverseLength).Store(out[RX]);
+            (qy * inverseLength).Store(out[RY]);
+            (qz * inverseLength).Store(out[RZ]);
+            (qw * inverseLength).Store(out[RW]);
+
+            for (uint32_t lane = 0; lane < laneCount; lane++)
+            {
+                const uint32_t i = first + lane;
+                translations[i] = glm::vec3(out[TX][lane], out[TY][lane], out[TZ][lane]);
+                scales[i] = glm::vec3(out[SX][lane], out[SY][lane], out[SZ][lane]);
+
+                if (out[Dot][lane] >= kNlerpMinDot)
+                {
+                    rotations[i] = glm::quat(out[RW][lane], out[RX][lane], out[RY][lane], out[RZ][lane]);
+                }
+                else
+                {
+                    const Bone::Segment& segment = segments[i];
+                    rotations[i] = glm::normalize(glm::slerp(segment.rotation0, segment.rotation1, segment.rotationFactor));
+                }
+            }
+        }
+    }
+
+    void ComposeTransforms(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, uint32_t count, glm::mat4* transforms)
+    {
+        enum { TX, TY, TZ, RX, RY, RZ, RW, SX, SY, SZ, InputCount };
+
+        alignas(32) float in[InputCount][kLaneWidth];
+        alignas(32) float out[12][kLaneWidth];
+
+        for (uint32_t first = 0; first < count; first += kLaneWidth)
+        {
+            const uint32_t laneCount = std::min(kLaneWidth, count - first);
+
+            for (uint32_t lane = 0; lane < kLaneWidth; lane++)
+            {
+                const uint32_t i = first + std::min(lane, laneCount - 1);
+                in[TX][lane] = translations[i].x; in[TY][lane] = translations[i].y; in[TZ][lane] = translations[i].z;
+                in[RX][lane] = rotations[i].x; in[RY][lane] = rotations[i].y; in[RZ][lane] = rotations[i].z; in[RW][lane] = rotations[i].w;
+                in[SX][lane] = scales[i].x; in[SY][lane] = scales[i].y; in[SZ][lane] = scales[i].z;
+            }
+
+            Lanes x = Lanes::Load(in[RX]), y = Lanes::Load(in[RY]), z = Lanes::Load(in[RZ]), w = Lanes::Load(in[RW]);
+            Lanes two = Lanes::Set(2.0f), one = Lanes::Set(1.0f);
+            Lanes xx = x * x * two, yy = y * y * two, zz = z * z * two;
+            Lanes xy = x * y * two, xz = x * z * two, yz = y * z * two;
+            Lanes wx = w * x * two, wy = w * y * two, wz = w * z * two;
+
+            // The columns of the rotation, scaled by the scale of their axis
+            Lanes sx = Lanes::Load(in[SX]), sy = Lanes::Load(in[SY]), sz = Lanes::Load(in[SZ]);
+            ((one - yy - zz) * sx).Store(out[0]);
+            ((xy + wz) * sx).Store(out[1]);
+            ((xz - wy) * sx).Store(out[2]);
+            ((xy - wz) * sy).Store(out[3]);
+            ((one - xx - zz) * sy).Store(out[4]);
+            ((yz + wx) * sy).Store(out[5]);
+            ((xz + wy) * sz).Store(out[6]);
+            ((yz - wx) * sz).Store(out[7]);
+            ((one - xx - yy) * sz).Store(out[8]);
+
+            for (uint32_t lane = 0; lane < laneCount; lane++)
+            {
+                glm::mat4& transform = transforms[first + lane];
+                transform[0] = glm::vec4(out[0][lane], out[1][lane], out[2][lane], 0.0f);
+                transform[1] = glm::vec4(out[3][lane], out[4][lane], out[5][lane], 0.0f);
+                transform[2] = glm::vec4(out[6][lane], out[7][lane], out[8][lane], 0.0f);
+                transform[3] = glm::vec4(in[TX][lane], in[TY][lane], in[TZ][lane], 1.0f);
+            }
+        }
+    }
+
+    void PosePool::Reset(uint32_t poseSize, uint32_t capacity)
+    {
+        m_PoseSize = poseSize;
+        m_Capacity = capacity;
+
+        m_Translations.assign(static_cast<size_t>(poseSize) * capacity, glm::vec3(0.0f));
+        m_Rotations.assign(static_cast<size_t>(poseSize) * capacity, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        m_Scales.assign(static_cast<size_t>(poseSize) * capacity, glm::vec3(1.0f));
+
+        m_FreeSlots.clear();
+        m_FreeSlots.reserve(capacity);
+        for (int32_t slot = static_cast<int32_t>(capacity) - 1; slot >= 0; slot--)
+        {
+            m_FreeSlots.push_back(slot);
+        }
+    }
+
+    Pose PosePool::Acquire()
+    {
+        Pose pose;
+        if (m_FreeSlots.empty())
+        {
+            COFFEE_CORE_ERROR("PosePool::Acquire: The pool is exhausted ({0} poses)", m_Capacity);
+            return pose;
+        }
+
+        pose.slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+
+        const size_t offset = static_cast<size_t>(pose.slot) * m_PoseSize;
+        pose.translations = m_Translations.data() + offset;
+        pose.rotations = m_Rotations.data() + offset;
+        pose.scales = m_Scales.data() + offset;
+        pose.size = m_PoseSize;
+        return pose;
+    }
+
+    void PosePool::Release(Pose& pose)
+    {
+        if (!pose.IsValid())
+            return;
+
+        m_FreeSlots.push_back(pose.slot);
+        pose = Pose{};
+    }
+
+    void SamplePose(const Animation& animation, float time, Bone::SamplingCursor* cursors, Pose& pose, int boneReduction, const BoneMask* mask)
+    {
+        ZoneScoped;
+
+        // Small enough for the stack, large enough to fill the lanes of several SampleSegments iterations
+        constexpr uint32_t kBatchSize = 32;
+        Bone::Segment segments[kBatchSize];
+        uint32_t batchNodes[kBatchSize];
+        glm::vec3 translations[kBatchSize];
+        glm::quat rotations[kBatchSize];
+        glm::vec3 scales[kBatchSize];
+        uint32_t batchCount = 0;
+
+        auto flush = [&]() {
+            SampleSegments(segments, batchCount, translations, rotations, scales);
+            for (uint32_t b = 0; b < batchCount; b++)
+            {
+                pose.translations[batchNodes[b]] = translations[b];
+                pose.rotations[batchNodes[b]] = rotations[b];
+                pose.scales[batchNodes[b]] = scales[b];
+            }
+            batchCount = 0;
+        };
+
+        const std::vector<AnimationNode>& nodes = animation.GetNodes();
+        const std::vector<int>& channels = animation.GetNodeChannels();
+        const std::vector<Bone>& bones = animation.GetBones();
+
+        ForEachNode(pose.size, mask, [&](uint32_t i) {
+            const AnimationNode& node = nodes[i];
+            const int channel = channels[i];
+            if (channel >= 0 && node.reductionLevel > boneReduction)
+            {
+                bones[channel].GetSegment(time, cursors[channel], segments[batchCount]);
+                batchNodes[batchCount++] = i;
+                if (batchCount == kBatchSize)
+                    flush();
+            }
+            else
+            {
+                pose.translations[i] = node.bindTranslation;
+                pose.rotations[i] = node.bindRotation;
+                pose.scales[i] = node.bindScale;
+            }
+        });
+
+        if (batchCount > 0)
+            flush();
+    }
+
+    void SamplePoseReference(const Animation& animation, float time, Bone::SamplingCursor* cursors, Pose& pose, int boneReduction)
+    {
+        ZoneScoped;
+
+        const std::vector<AnimationNode>& nodes = animation.GetNodes();
+        const std::vector<int>& channels = animation.GetNodeChannels();
+        const std::vector<Bone>& bones = animation.GetBones();
+
+        for (uint32_t i = 0; i < pose.size; i++)
+        {
+            const AnimationNode& node = nodes[i];
+            const int channel = channels[i];
+            if (channel >= 0 && node.reductionLevel > boneReduction)
+            {
+                bones[channel].Sample(time, cursors[channel], pose.translations[i], pose.rotations[i], pose.scales[i]);
+            }
+            else
+            {
+                pose.translations[i] = node.bindTranslation;
+                pose.rotations[i] = node.bindRotation;
+                pose.scales[i] = node.bindScale;
+            }
+        }
+    }
+
+    void BlendPoses(const Pose& from, const Pose& to, float weight, Pose& pose, const BoneMask* mask)
+    {
+        ZoneScoped;
+
+        ForEachNode(pose.size, mask, [&](uint32_t i) {
+            pose.translations[i] = glm::mix(from.translations[i], to.translations[i], weight);
+            pose.scales[i] = glm::mix(from.scales[i], to.scales[i], weight);
+
+            // Normalized lerp along the shortest path
+            glm::quat target = to.rotations[i];
+            if (glm::dot(from.rotations[i], target) < 0.0f)
+                target = -target;
+            pose.rotations[i] = glm::normalize(from.rotations[i] * (1.0f - weight) + target * weight);
+        });
+    }
+
+    void AddPose(Pose& pose, const Pose& additive, const Pose& reference, float weight, const BoneMask* mask)
+    {
+        ZoneScoped;
+
+        const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+
+        ForEachNode(pose.size, mask, [&](uint32_t i) {
+            pose.translations[i] += (additive.translations[i] - reference.translations[i]) * weight;
+
+            glm::vec3 scaleDelta = additive.scales[i] / glm::max(reference.scales[i], glm::vec3(1e-6f));
+            pose.scales[i] *= glm::mix(glm::vec3(1.0f), scaleDelta, weight);
+
+            glm::quat delta = glm::inverse(reference.rotations[i]) * additive.rotations[i];
+            if (delta.w < 0.0f)
+                delta = -delta;
+            pose.rotations[i] = glm::normalize(pose.rotations[i] * glm::normalize(identity * (1.0f - weight) + delta * weight));
+        });
+    }
+
+    void ComputeBoneMatrices(const std::vector<AnimationNode>& nodes, const Pose& pose, glm::mat4* globalTransforms, glm::mat4* finalBoneMatrices, const BoneMask* mask)
+    {
+        ZoneScoped;
+
+        // A mask usually holds a few scattered nodes, which are not worth gathering into lanes
+        if (mask)
+        {
+            ForEachNode(pose.size, mask, [&](uint32_t i) {
+                globalTransforms[i] = ComposeTransform(pose.translations[i], pose.rotations[i], pose.scales[i]);
+            });
+        }
+        else
+        {
+            ComposeTransforms(pose.translations, pose.rotations, pose.scales, pose.size, globalTransforms);
+        }
+
+        // Parents come first, so their transform is already global when a child reads it. A mask holds the ancestors of its nodes.
+        ForEachNode(pose.size, mask, [&](uint32_t i) {
+            const AnimationNode& node = nodes[i];
+
+            if (node.parentIndex >= 0)
+                globalTransforms[i] = globalTransforms[node.parentIndex] * globalTransforms[i];
+
+            if (node.boneIndex >= 0 && finalBoneMatrices)
+                finalBoneMatrices[node.boneIndex] = globalTransforms[i] * node.offset;
+        });
+    }
+
+    void ComputeBindPoseOutsideMask(const std::vector<AnimationNode>& nodes, const BoneMask& mask, glm::mat4* globalTransforms, glm::mat4* finalBoneMatrices)
+    {
+        ZoneScoped;
+
+        // Parents come first, whether they were evaluated by the mask or filled here
+        for (uint32_t i = 0; i < nodes.size(); i++)
+        {
+            if (mask.Contains(i))
+                continue;
+
+            const AnimationNode& node = nodes[i];
+            globalTransforms[i] = node.parentIndex >= 0 ? globalTransforms[node.parentIndex] * node.transformation : node.transformation;
+
+            if (node.boneIndex >= 0)
+                finalBoneMatrices[node.boneIndex] = globalTransforms[i] * node.offset;
+        }
+    }
+
+}
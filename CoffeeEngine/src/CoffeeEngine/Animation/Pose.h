@@ -0,0 +1,196 @@
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/BoneMask.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief A local-space pose, stored as separate translation, rotation and scale arrays.
+     *
+     * Entries are indexed like Skeleton::GetNodes(). The arrays are owned by a PosePool,
+     * a Pose is only a view over one of its slots.
+     */
+    struct Pose
+    {
+        glm::vec3* translations = nullptr; ///< The local translation of every node.
+        glm::quat* rotations = nullptr; ///< The local rotation of every node.
+        glm::vec3* scales = nullptr; ///< The local scale of every node.
+        uint32_t size = 0; ///< The number of nodes of the pose.
+        int32_t slot = -1; ///< The slot of the pool the pose belongs to, or -1 if the pose is not valid.
+
+        bool IsValid() const { return slot >= 0; }
+    };
+
+    /**
+     * @brief Preallocated storage for the poses of an animator.
+     *
+     * All the poses are allocated when the pool is reset, so acquiring and releasing poses
+     * during evaluation never allocates.
+     */
+    class PosePool
+    {
+    public:
+        PosePool() = default;
+
+        /**
+         * @brief Allocates the storage for a number of poses.
+         * @param poseSize The number of nodes of each pose.
+         * @param capacity The number of poses of the pool.
+         */
+        PosePool(uint32_t poseSize, uint32_t capacity) { Reset(poseSize, capacity); }
+
+        /**
+         * @brief Reallocates the storage. Every pose acquired before is invalidated.
+         * @param poseSize The number of nodes of each pose.
+         * @param capacity The number of poses of the pool.
+         */
+        void Reset(uint32_t poseSize, uint32_t capacity);
+
+        /**
+         * @brief Takes a free pose from the pool.
+         * @return The pose, or an invalid pose if the pool is exhausted.
+         */
+        Pose Acquire();
+
+        /**
+         * @brief Returns a pose to the pool.
+         * @param pose The pose to release. It is invalidated.
+         */
+        void Release(Pose& pose);
+
+        uint32_t GetPoseSize() const { return m_PoseSize; }
+        uint32_t GetCapacity() const { return m_Capacity; }
+        uint32_t GetAvailable() const { return static_cast<uint32_t>(m_FreeSlots.size()); }
+
+    private:
+        std::vector<glm::vec3> m_Translations;
+        std::vector<glm::quat> m_Rotations;
+        std::vector<glm::vec3> m_Scales;
+        std::vector<int32_t> m_FreeSlots; ///< The slots that can be acquired.
+        uint32_t m_PoseSize = 0;
+        uint32_t m_Capacity = 0;
+    };
+
+    /**
+     * @brief Samples an animation into a pose. Nodes without a channel, or skipped by bone reduction, get their bind transform.
+     *
+     * Keys are looked up per channel, then interpolated by SampleSegments several channels at a time.
+     *
+     * @param animation The animation to sample.
+     * @param time The animation time in ticks.
+     * @param cursors The sampling cursors of the instance, one per animation channel.
+     * @param pose The output pose.
+     * @param boneReduction Nodes whose reduction level is not above this value keep their bind transform, 0 samples every node.
+     * @param mask The nodes to sample, the others are left as they are. nullptr samples every node.
+     */
+    void SamplePose(const Animation& animation, float time, Bone::SamplingCursor* cursors, Pose& pose, int boneReduction = 0, const BoneMask* mask = nullptr);
+
+    /**
+     * @brief Scalar implementation of SamplePose with Bone::Sample, used as the accuracy and performance reference.
+     */
+    void SamplePoseReference(const Animation& animation, float time, Bone::SamplingCursor* cursors, Pose& pose, int boneReduction = 0);
+
+    /**
+     * @brief Interpolates key segments in SIMD lanes, 8 at a time with AVX2 and 4 otherwise.
+     *
+     * Rotations use a normalized lerp along the shortest path, which stays within 0.12 degrees of
+     * a slerp for keys up to 45 degrees apart. Segments with keys further apart fall back to a slerp.
+     *
+     * @param segments The segments, as returned by Bone::GetSegment.
+     * @param count The number of segments.
+     * @param translations The output translations, one per segment.
+     * @param rotations The output normalized rotations, one per segment.
+     * @param scales The output scales, one per segment.
+     */
+    void SampleSegments(const Bone::Segment* segments, uint32_t count, glm::vec3* translations, glm::quat* rotations, glm::vec3* scales);
+
+    /**
+     * @brief Builds affine transforms from translations, rotations and scales in SIMD lanes.
+     *
+     * Only the 3x4 affine part is computed, the last row of every transform is set to (0, 0, 0, 1).
+     * Gives the result of ComposeTransform.
+     *
+     * @param translations The translations.
+     * @param rotations The normalized rotations.
+     * @param scales The scales.
+     * @param count The number of transforms.
+     * @param transforms The output transforms.
+     */
+    void ComposeTransforms(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, uint32_t count, glm::mat4* transforms);
+
+    /**
+     * @brief Blends two poses. The output may alias either input.
+     * @param from The pose returned when weight is 0.
+     * @param to The pose returned when weight is 1.
+     * @param weight The blend weight.
+     * @param pose The output pose.
+     * @param mask The nodes to blend, the others are left as they are. nullptr blends every node.
+     */
+    void BlendPoses(const Pose& from, const Pose& to, float weight, Pose& pose, const BoneMask* mask = nullptr);
+
+    /**
+     * @brief Adds the difference between an additive pose and its reference pose on top of a pose.
+     * @param pose The pose to modify.
+     * @param additive The additive pose.
+     * @param reference The pose the additive pose is relative to.
+     * @param weight The weight of the additive pose.
+     * @param mask The nodes to modify, nullptr modifies every node.
+     */
+    void AddPose(Pose& pose, const Pose& additive, const Pose& reference, float weight, const BoneMask* mask = nullptr);
+
+    /**
+     * @brief Converts a local pose to the final bone matrices in a single pass over the hierarchy.
+     *
+     * The local transforms are composed by ComposeTransforms into globalTransforms, which the pass
+     * then turns into global transforms in place.
+     *
+     * @param nodes The flattened hierarchy the pose is indexed by.
+     * @param pose The local pose.
+     * @param globalTransforms The output global transforms, one per node.
+     * @param finalBoneMatrices The output bone matrices, or nullptr when only the global transforms are needed.
+     * @param mask The nodes to evaluate, the transforms and bone matrices of the others are left as they are. nullptr evaluates every node.
+     */
+    void ComputeBoneMatrices(const std::vector<AnimationNode>& nodes, const Pose& pose, glm::mat4* globalTransforms, glm::mat4* finalBoneMatrices, const BoneMask* mask = nullptr);
+
+    /**
+     * @brief Gives the nodes outside a mask their bind local transform, under parents that may be animated.
+     *
+     * Called after ComputeBoneMatrices with the same mask when the whole palette is drawn, so the bones the mask skipped
+     * do not keep the matrices of older frames. Costs one matrix product per skipped node, nothing is sampled.
+     *
+     * @param nodes The flattened hierarchy.
+     * @param mask The nodes already evaluated.
+     * @param globalTransforms The global transforms, those of the mask already computed.
+     * @param finalBoneMatrices The bone matrices, those of the mask already computed.
+     */
+    void ComputeBindPoseOutsideMask(const std::vector<AnimationNode>& nodes, const BoneMask& mask, glm::mat4* globalTransforms, glm::mat4* finalBoneMatrices);
+
+    /**
+     * @brief Builds a transform matrix from its translation, rotation and scale.
+     */
+    inline glm::mat4 ComposeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        glm::mat4 transform = glm::mat4_cast(rotation);
+        transform[0] *= scale.x;
+        transform[1] *= scale.y;
+        transform[2] *= scale.z;
+        transform[3] = glm::vec4(translation, 1.0f);
+        return transform;
+    }
+
+    /** @} */
+}
@@ -0,0 +1,224 @@
+#include "CoffeeEngine/Animation/Skeleton.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceRegistry.h"
+
+#include <glm/gtx/matrix_decompose.hpp>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+namespace Coffee {
+
+    // FNV-1a, stable across runs so the same rig always maps to the same UUID
+    static void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    Skeleton::Skeleton(const std::string& name, const AssimpNodeData& rootNode, const std::map<std::string, BoneInfo>& boneInfoMap)
+        : Resource(ResourceType::Skeleton)
+    {
+        ZoneScoped;
+
+        m_Name = name;
+        CompileNode(rootNode, -1, boneInfoMap);
+        Finalize();
+    }
+
+    Ref<Skeleton> Skeleton::Share(const Ref<Skeleton>& skeleton)
+    {
+        if (!skeleton)
+            return nullptr;
+
+        UUID uuid = skeleton->GetUUID();
+        if (ResourceRegistry::Exists(uuid))
+        {
+            Ref<Resource> resource = ResourceRegistry::Get<Resource>(uuid);
+            if (resource->GetType() == ResourceType::Skeleton)
+            {
+                Ref<Skeleton> registered = std::static_pointer_cast<Skeleton>(resource);
+                if (registered == skeleton || registered->IsCompatible(*skeleton))
+                    return registered;
+            }
+
+            // A hash collision with another rig, the skeleton is used unshared
+            COFFEE_CORE_WARN("Skeleton::Share: {0} collides with another resource, it is not shared", skeleton->GetName());
+            return skeleton;
+        }
+
+        ResourceRegistry::Add(uuid, skeleton);
+        return skeleton;
+    }
+
+    int Skeleton::FindNode(const std::string& name) const
+    {
+        auto it = m_NodeIndices.find(name);
+        return it != m_NodeIndices.end() ? it->second : -1;
+    }
+
+    Ref<BoneMask> Skeleton::GetBoneMask(const std::vector<std::string>& nodeNames) const
+    {
+        std::vector<int> nodes;
+        nodes.reserve(nodeNames.size());
+        for (const std::string& name : nodeNames)
+        {
+            int node = FindNode(name);
+            if (node >= 0)
+                nodes.push_back(node);
+            else
+                COFFEE_CORE_WARN("Skeleton::GetBoneMask: {0} has no node named {1}", m_Name, name);
+        }
+
+        // The same set requested in another order or with duplicates gets the same mask
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+        std::lock_guard<std::mutex> lock(m_BoneMaskMutex);
+        Ref<BoneMask>& mask = m_BoneMasks[nodes];
+        if (!mask)
+            mask = CreateRef<BoneMask>(*this, nodes);
+        return mask;
+    }
+
+    std::map<std::string, BoneInfo> Skeleton::GetBoneInfoMap() const
+    {
+        std::map<std::string, BoneInfo> boneInfoMap;
+        for (size_t i = 0; i < m_Nodes.size(); i++)
+        {
+            if (m_Nodes[i].boneIndex >= 0)
+                boneInfoMap[m_NodeNames[i]] = {m_Nodes[i].boneIndex, m_Nodes[i].offset};
+        }
+        return boneInfoMap;
+    }
+
+    bool Skeleton::IsCompatible(const Skeleton& other) const
+    {
+        if (m_Hash != other.m_Hash || m_Nodes.size() != other.m_Nodes.size() || m_NodeNames != other.m_NodeNames)
+            return false;
+
+        for (size_t i = 0; i < m_Nodes.size(); i++)
+        {
+            const AnimationNode& a = m_Nodes[i];
+            const AnimationNode& b = other.m_Nodes[i];
+            if (a.parentIndex != b.parentIndex || a.boneIndex != b.boneIndex ||
+                a.transformation != b.transformation || a.offset != b.offset)
+                return false;
+        }
+        return true;
+    }
+
+    void Skeleton::SetBindTransform(AnimationNode& node, const glm::mat4& transformation)
+    {
+        node.transformation = transformation;
+
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        if (!glm::decompose(transformation, node.bindScale, node.bindRotation, node.bindTranslation, skew, perspective))
+        {
+            node.bindTranslation = glm::vec3(transformation[3]);
+            node.bindRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+            node.bindScale = glm::vec3(1.0f);
+        }
+    }
+
+    void Skeleton::CompileNode(const AssimpNodeData& node, int parentIndex, const std::map<std::string, BoneInfo>& boneInfoMap)
+    {
+        AnimationNode compiled;
+        SetBindTransform(compiled, node.transformation);
+        compiled.offset = glm::mat4(1.0f);
+        compiled.parentIndex = parentIndex;
+        compiled.boneIndex = -1;
+        compiled.reductionLevel = AnimationNode::kNeverReduced;
+
+        auto boneInfo = boneInfoMap.find(node.name);
+        if (boneInfo != boneInfoMap.end())
+        {
+            compiled.boneIndex = boneInfo->second.id;
+            compiled.offset = boneInfo->second.offset;
+        }
+
+        // Depth-first pre-order keeps every parent ahead of its children
+        int index = static_cast<int>(m_Nodes.size());
+        m_Nodes.push_back(compiled);
+        m_NodeNames.push_back(node.name);
+
+        for (int i = 0; i < node.childrenCount; i++)
+        {
+            CompileNode(node.children[i], index, boneInfoMap);
+        }
+    }
+
+    void Skeleton::Finalize()
+    {
+        m_NodeIndices.clear();
+        m_NodeIndices.reserve(m_Nodes.size());
+        m_BoneCount = 0;
+        m_Hash = 14695981039346656037ull;
+
+        for (size_t i = 0; i < m_Nodes.size(); i++)
+        {
+            const AnimationNode& node = m_Nodes[i];
+
+            // The first node of a name wins, like the name lookups of the importer
+            m_NodeIndices.emplace(m_NodeNames[i], static_cast<int>(i));
+            m_BoneCount = std::max(m_BoneCount, node.boneIndex + 1);
+
+            HashBytes(m_Hash, m_NodeNames[i].data(), m_NodeNames[i].size() + 1);
+            HashBytes(m_Hash, &node.parentIndex, sizeof(node.parentIndex));
+            HashBytes(m_Hash, &node.boneIndex, sizeof(node.boneIndex));
+            HashBytes(m_Hash, &node.transformation, sizeof(node.transformation));
+            HashBytes(m_Hash, &node.offset, sizeof(node.offset));
+        }
+
+        ComputeReductionLevels();
+
+        // Skeletons of the same rig get the same UUID, which is how Share finds them
+        SetUUID(UUID(m_Hash));
+    }
+
+    void Skeleton::ComputeReductionLevels()
+    {
+        // Height of every node above its deepest leaf, number of children, and whether its subtree is a single
+        // chain ending in a leaf. Children come after their parent, so a node is complete when the walk reaches it.
+        const size_t nodeCount = m_Nodes.size();
+        std::vector<int> heights(nodeCount, 0);
+        std::vector<int> childCounts(nodeCount, 0);
+        std::vector<int> leafChainCounts(nodeCount, 0);
+        std::vector<uint8_t> leafChains(nodeCount, 1);
+        for (int i = static_cast<int>(nodeCount) - 1; i > 0; i--)
+        {
+            leafChains[i] = leafChains[i] && childCounts[i] <= 1;
+
+            int parent = m_Nodes[i].parentIndex;
+            if (parent < 0)
+                continue;
+
+            heights[parent] = std::max(heights[parent], heights[i] + 1);
+            childCounts[parent]++;
+            if (leafChains[i])
+                leafChainCounts[parent]++;
+            else
+                leafChains[parent] = 0;
+        }
+
+        // A fan of short chains out of the same bone (fingers off a hand, face bones off a head) is dropped chain by chain,
+        // each once the reduction level reaches its own length. Limbs and necks branch alone or in pairs and are never dropped.
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            AnimationNode& node = m_Nodes[i];
+            node.reductionLevel = AnimationNode::kNeverReduced;
+            if (node.parentIndex < 0)
+                continue;
+
+            node.reductionLevel = m_Nodes[node.parentIndex].reductionLevel;
+            if (leafChains[i] && leafChainCounts[node.parentIndex] >= kMinReducedFanSize)
+                node.reductionLevel = std::min(node.reductionLevel, heights[i] + 1);
+        }
+    }
+
+}
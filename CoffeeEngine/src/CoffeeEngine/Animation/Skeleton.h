@@ -0,0 +1,215 @@
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include "CoffeeEngine/Animation/Bone.h"
+#include "CoffeeEngine/Animation/BoneMask.h"
+
+#include <cereal/access.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief A node of the hierarchy as read from the file, only used to build a Skeleton.
+     */
+    struct AssimpNodeData
+    {
+        glm::mat4 transformation;
+        std::string name;
+        int childrenCount;
+        std::vector<AssimpNodeData> children;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(transformation, name, childrenCount, children);
+        }
+    };
+
+    /**
+     * @brief A node of the skeleton, flattened and resolved at load time.
+     *
+     * Nodes are stored in topological order (a parent always comes before its children),
+     * so the whole hierarchy can be evaluated in a single linear pass.
+     */
+    struct AnimationNode
+    {
+        static constexpr int kNeverReduced = std::numeric_limits<int>::max(); ///< The reduction level of nodes that are always sampled.
+
+        glm::mat4 transformation; ///< The local transform used when the node has no channel.
+        glm::vec3 bindTranslation; ///< The translation of the local transform, used by pose sampling.
+        glm::quat bindRotation; ///< The rotation of the local transform, used by pose sampling.
+        glm::vec3 bindScale; ///< The scale of the local transform, used by pose sampling.
+        glm::mat4 offset; ///< The offset (inverse bind) matrix of the bone.
+        int parentIndex; ///< The index of the parent node, or -1 for the root.
+        int boneIndex; ///< The index in the final bone matrices, or -1 if the node is not a bone.
+        int reductionLevel; ///< The lowest bone reduction level at which the node keeps its bind transform instead of being sampled.
+    };
+
+    /**
+     * @brief Resource holding the hierarchy, bind pose and offsets of a rig.
+     *
+     * Clips only store their channels and the node each channel drives, so every clip of a rig
+     * shares one Skeleton. Skeletons built from the same rig, even by different models or files,
+     * are merged by Share.
+     */
+    class Skeleton : public Resource
+    {
+    public:
+        /**
+         * @brief Default constructor, used when the skeleton is loaded from the cache.
+         */
+        Skeleton() : Resource(ResourceType::Skeleton) {}
+
+        /**
+         * @brief Flattens a node hierarchy and resolves the bones of its nodes.
+         * @param name The name of the skeleton.
+         * @param rootNode The root of the hierarchy.
+         * @param boneInfoMap The palette index and offset matrix of every skinned node.
+         */
+        Skeleton(const std::string& name, const AssimpNodeData& rootNode, const std::map<std::string, BoneInfo>& boneInfoMap);
+
+        /**
+         * @brief Gets the skeleton registered for the same rig, registering this one if there is none.
+         * @param skeleton The skeleton to share.
+         * @return The registered skeleton, or the given one if it is the first of its rig.
+         */
+        static Ref<Skeleton> Share(const Ref<Skeleton>& skeleton);
+
+        /**
+         * @brief Gets the flattened hierarchy.
+         * @return The nodes in topological order.
+         */
+        const std::vector<AnimationNode>& GetNodes() const { return m_Nodes; }
+
+        /**
+         * @brief Gets the name of a node.
+         * @param node The index of the node.
+         */
+        const std::string& GetNodeName(int node) const { return m_NodeNames[node]; }
+
+        /**
+         * @brief Finds a node by name.
+         * @param name The name of the node.
+         * @return The index of the node, or -1 if there is no node with that name.
+         */
+        int FindNode(const std::string& name) const;
+
+        /**
+         * @brief Gets the number of final bone matrices written by this skeleton.
+         * @return The highest bone index plus one.
+         */
+        int GetBoneCount() const { return m_BoneCount; }
+
+        /**
+         * @brief Gets the palette index and offset matrix of every bone, as used by the meshes of a model.
+         */
+        std::map<std::string, BoneInfo> GetBoneInfoMap() const;
+
+        /**
+         * @brief Gets the mask evaluating a set of nodes, compiled on the first request of the set.
+         * @param nodeNames The names of the requested nodes, names missing from the skeleton are ignored.
+         * @return The mask, shared by every request of the same set.
+         */
+        Ref<BoneMask> GetBoneMask(const std::vector<std::string>& nodeNames) const;
+
+        /**
+         * @brief Gets a hash of the hierarchy, bind pose and bones, equal for skeletons of the same rig.
+         */
+        uint64_t GetHash() const { return m_Hash; }
+
+        /**
+         * @brief Whether another skeleton has the same hierarchy, bind pose and bones.
+         * @param other The skeleton to compare with.
+         */
+        bool IsCompatible(const Skeleton& other) const;
+
+    private:
+        void CompileNode(const AssimpNodeData& node, int parentIndex, const std::map<std::string, BoneInfo>& boneInfoMap);
+
+        /**
+         * @brief Tags the nodes that bone reduction may skip, see AnimationNode::reductionLevel.
+         */
+        void ComputeReductionLevels();
+
+        static constexpr int kMinReducedFanSize = 3; ///< The leaf chains a bone needs to fan out into before bone reduction drops them.
+
+        /**
+         * @brief Builds the derived data after the nodes are read.
+         */
+        void Finalize();
+
+        friend class cereal::access;
+
+        template<class Archive>
+        void save(Archive& archive) const
+        {
+            std::vector<glm::mat4> transformations, offsets;
+            std::vector<int> parents, bones;
+            for (const AnimationNode& node : m_Nodes)
+            {
+                transformations.push_back(node.transformation);
+                offsets.push_back(node.offset);
+                parents.push_back(node.parentIndex);
+                bones.push_back(node.boneIndex);
+            }
+            archive(m_NodeNames, transformations, offsets, parents, bones, cereal::base_class<Resource>(this));
+        }
+
+        template<class Archive>
+        void load(Archive& archive)
+        {
+            std::vector<glm::mat4> transformations, offsets;
+            std::vector<int> parents, bones;
+            archive(m_NodeNames, transformations, offsets, parents, bones, cereal::base_class<Resource>(this));
+
+            m_Nodes.resize(m_NodeNames.size());
+            for (size_t i = 0; i < m_Nodes.size(); i++)
+            {
+                SetBindTransform(m_Nodes[i], transformations[i]);
+                m_Nodes[i].offset = offsets[i];
+                m_Nodes[i].parentIndex = parents[i];
+                m_Nodes[i].boneIndex = bones[i];
+            }
+            Finalize();
+        }
+
+        static void SetBindTransform(AnimationNode& node, const glm::mat4& transformation);
+
+    private:
+        std::vector<AnimationNode> m_Nodes; ///< The hierarchy in topological order.
+        std::vector<std::string> m_NodeNames; ///< The name of every node.
+        std::unordered_map<std::string, int> m_NodeIndices; ///< The index of every node by name.
+        int m_BoneCount = 0; ///< The highest bone index plus one.
+        uint64_t m_Hash = 0; ///< See GetHash.
+
+        mutable std::map<std::vector<int>, Ref<BoneMask>> m_BoneMasks; ///< The compiled masks, by sorted requested nodes.
+        mutable std::mutex m_BoneMaskMutex; ///< Guards m_BoneMasks, masks may be requested from the animation workers.
+    };
+
+    /** @} */
+}
+
+CEREAL_REGISTER_TYPE(Coffee::Skeleton);
+CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::Resource, Coffee::Skeleton);
@@ -0,0 +1,217 @@
+#include "CoffeeEngine/Animation/Skinning.h"
+#include "CoffeeEngine/Core/ThreadPool.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/SkinData.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <cmath>
+
+#if defined(__AVX2__)
+    #define COFFEE_SKINNING_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define COFFEE_SKINNING_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace Coffee {
+
+    static inline glm::vec3 NormalizeSkinnedNormal(float x, float y, float z)
+    {
+        // Degenerate normals are kept as they are instead of turning into NaNs
+        float lengthSquared = x * x + y * y + z * z;
+        if (lengthSquared <= 0.0f)
+            return glm::vec3(x, y, z);
+
+        float inverseLength = 1.0f / std::sqrt(lengthSquared);
+        return glm::vec3(x * inverseLength, y * inverseLength, z * inverseLength);
+    }
+
+    static inline uint32_t DecodeInfluences(const SkinData& skin, uint32_t vertex, uint32_t* boneIDs, float* weights)
+    {
+        // Vertices of a mesh without skin have no influences and keep their bind pose
+        return skin.IsEmpty() ? 0 : skin.Decode(vertex, boneIDs, weights);
+    }
+
+    void SkinVerticesReference(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals)
+    {
+        uint32_t boneIDs[VertexInfluences::kCapacity];
+        float weights[VertexInfluences::kCapacity];
+
+        for (uint32_t v = first; v < first + count; v++)
+        {
+            const Vertex& vertex = vertices[v];
+            uint32_t influenceCount = DecodeInfluences(skin, v, boneIDs, weights);
+
+            glm::mat4 blendedMatrix(0.0f);
+            float totalWeight = 0.0f;
+            for (uint32_t i = 0; i < influenceCount; i++)
+            {
+                uint32_t boneID = boneIDs[i];
+                if (weights[i] <= 0.0f || boneID >= boneCount)
+                    continue;
+
+                blendedMatrix += boneMatrices[boneID] * weights[i];
+                totalWeight += weights[i];
+            }
+
+            glm::mat4 skinMatrix = totalWeight > 0.0f ? blendedMatrix : glm::mat4(1.0f);
+
+            positions[v] = glm::vec3(skinMatrix * glm::vec4(vertex.Position, 1.0f));
+            if (normals)
+            {
+                glm::vec3 normal = glm::mat3(skinMatrix) * vertex.Normals;
+                normals[v] = NormalizeSkinnedNormal(normal.x, normal.y, normal.z);
+            }
+        }
+    }
+
+#if defined(COFFEE_SKINNING_AVX2)
+
+    // The columns of a matrix are contiguous, so two 256 bit registers hold columns 0-1 and 2-3
+    static void SkinVerticesAVX2(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals)
+    {
+        alignas(16) float result[4];
+
+        uint32_t boneIDs[VertexInfluences::kCapacity];
+        float weights[VertexInfluences::kCapacity];
+
+        for (uint32_t v = first; v < first + count; v++)
+        {
+            const Vertex& vertex = vertices[v];
+            uint32_t influenceCount = DecodeInfluences(skin, v, boneIDs, weights);
+
+            __m256 columns01 = _mm256_setzero_ps();
+            __m256 columns23 = _mm256_setzero_ps();
+            float totalWeight = 0.0f;
+            for (uint32_t i = 0; i < influenceCount; i++)
+            {
+                uint32_t boneID = boneIDs[i];
+                if (weights[i] <= 0.0f || boneID >= boneCount)
+                    continue;
+
+                const float* matrix = &boneMatrices[boneID][0][0];
+                __m256 weight = _mm256_set1_ps(weights[i]);
+                columns01 = _mm256_add_ps(columns01, _mm256_mul_ps(_mm256_loadu_ps(matrix), weight));
+                columns23 = _mm256_add_ps(columns23, _mm256_mul_ps(_mm256_loadu_ps(matrix + 8), weight));
+                totalWeight += weights[i];
+            }
+
+            if (totalWeight <= 0.0f)
+            {
+                columns01 = _mm256_setr_ps(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+                columns23 = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+            }
+
+            const glm::vec3& p = vertex.Position;
+            __m256 xy = _mm256_setr_ps(p.x, p.x, p.x, p.x, p.y, p.y, p.y, p.y);
+            __m256 zw = _mm256_setr_ps(p.z, p.z, p.z, p.z, 1.0f, 1.0f, 1.0f, 1.0f);
+            __m256 sum = _mm256_add_ps(_mm256_mul_ps(columns01, xy), _mm256_mul_ps(columns23, zw));
+            _mm_store_ps(result, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+            positions[v] = glm::vec3(result[0], result[1], result[2]);
+
+            if (normals)
+            {
+                const glm::vec3& n = vertex.Normals;
+                xy = _mm256_setr_ps(n.x, n.x, n.x, n.x, n.y, n.y, n.y, n.y);
+                zw = _mm256_setr_ps(n.z, n.z, n.z, n.z, 0.0f, 0.0f, 0.0f, 0.0f);
+                sum = _mm256_add_ps(_mm256_mul_ps(columns01, xy), _mm256_mul_ps(columns23, zw));
+                _mm_store_ps(result, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+                normals[v] = NormalizeSkinnedNormal(result[0], result[1], result[2]);
+            }
+        }
+    }
+
+#elif defined(COFFEE_SKINNING_SSE2)
+
+    static void SkinVerticesSSE2(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals)
+    {
+        alignas(16) float result[4];
+
+        uint32_t boneIDs[VertexInfluences::kCapacity];
+        float weights[VertexInfluences::kCapacity];
+
+        for (uint32_t v = first; v < first + count; v++)
+        {
+            const Vertex& vertex = vertices[v];
+            uint32_t influenceCount = DecodeInfluences(skin, v, boneIDs, weights);
+
+            __m128 column0 = _mm_setzero_ps();
+            __m128 column1 = _mm_setzero_ps();
+            __m128 column2 = _mm_setzero_ps();
+            __m128 column3 = _mm_setzero_ps();
+            float totalWeight = 0.0f;
+            for (uint32_t i = 0; i < influenceCount; i++)
+            {
+                uint32_t boneID = boneIDs[i];
+                if (weights[i] <= 0.0f || boneID >= boneCount)
+                    continue;
+
+                const float* matrix = &boneMatrices[boneID][0][0];
+                __m128 weight = _mm_set1_ps(weights[i]);
+                column0 = _mm_add_ps(column0, _mm_mul_ps(_mm_loadu_ps(matrix), weight));
+                column1 = _mm_add_ps(column1, _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight));
+                column2 = _mm_add_ps(column2, _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight));
+                column3 = _mm_add_ps(column3, _mm_mul_ps(_mm_loadu_ps(matrix + 12), weight));
+                totalWeight += weights[i];
+            }
+
+            if (totalWeight <= 0.0f)
+            {
+                column0 = _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f);
+                column1 = _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f);
+                column2 = _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f);
+                column3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+
+            const glm::vec3& p = vertex.Position;
+            __m128 position = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(p.x)), _mm_mul_ps(column1, _mm_set1_ps(p.y))),
+                _mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(p.z)), column3));
+            _mm_store_ps(result, position);
+            positions[v] = glm::vec3(result[0], result[1], result[2]);
+
+            if (normals)
+            {
+                const glm::vec3& n = vertex.Normals;
+                __m128 normal = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(n.x)), _mm_mul_ps(column1, _mm_set1_ps(n.y))),
+                    _mm_mul_ps(column2, _mm_set1_ps(n.z)));
+                _mm_store_ps(result, normal);
+                normals[v] = NormalizeSkinnedNormal(result[0], result[1], result[2]);
+            }
+        }
+    }
+
+#endif
+
+    void SkinVertices(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals)
+    {
+#if defined(COFFEE_SKINNING_AVX2)
+        SkinVerticesAVX2(vertices, skin, first, count, boneMatrices, boneCount, positions, normals);
+#elif defined(COFFEE_SKINNING_SSE2)
+        SkinVerticesSSE2(vertices, skin, first, count, boneMatrices, boneCount, positions, normals);
+#else
+        SkinVerticesReference(vertices, skin, first, count, boneMatrices, boneCount, positions, normals);
+#endif
+    }
+
+    void SkinVerticesParallel(const Vertex* vertices, const SkinData& skin, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals, uint32_t batchSize)
+    {
+        ZoneScoped;
+
+        ThreadPool::ParallelFor(count, batchSize, [&](uint32_t begin, uint32_t end) {
+            ZoneScopedN("SkinVertices::Batch");
+
+            SkinVertices(vertices, skin, begin, end - begin, boneMatrices, boneCount, positions, normals);
+        });
+    }
+
+    void SkinMesh(const Mesh& mesh, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals, uint32_t batchSize)
+    {
+        const std::vector<Vertex>& vertices = mesh.GetVertices();
+        SkinVerticesParallel(vertices.data(), mesh.GetSkin(), static_cast<uint32_t>(vertices.size()), boneMatrices, boneCount, positions, normals, batchSize);
+    }
+
+}
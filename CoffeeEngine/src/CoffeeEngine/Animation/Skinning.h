@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace Coffee {
+
+    struct Vertex;
+    class Mesh;
+    class SkinData;
+
+    /**
+     * @addtogroup animation
+     * @{
+     */
+
+    /**
+     * @brief Skins vertices on the CPU, matching the skinning of the standard shader.
+     *
+     * Uses AVX2 when the engine is built with COFFEE_ENABLE_AVX2, SSE2 on other x86-64 builds and
+     * SkinVerticesReference elsewhere. Vertices whose influences all fall outside the palette keep their bind pose.
+     *
+     * @param vertices The vertices of the mesh.
+     * @param skin The bone influences of the vertices.
+     * @param first The index of the first vertex to skin.
+     * @param count The number of vertices to skin.
+     * @param boneMatrices The bone palette, as evaluated by an Animator.
+     * @param boneCount The number of matrices of the palette.
+     * @param positions The output skinned positions, written at the indices of their vertex.
+     * @param normals The output normalized skinned normals, written at the indices of their vertex, or nullptr to skip them.
+     */
+    void SkinVertices(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals);
+
+    /**
+     * @brief Scalar implementation of SkinVertices, used as the accuracy and performance reference.
+     */
+    void SkinVerticesReference(const Vertex* vertices, const SkinData& skin, uint32_t first, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals);
+
+    /**
+     * @brief SkinVertices split in batches over the thread pool, for large meshes.
+     * @param batchSize The number of vertices skinned by a single batch.
+     */
+    void SkinVerticesParallel(const Vertex* vertices, const SkinData& skin, uint32_t count, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals, uint32_t batchSize = 4096);
+
+    /**
+     * @brief Skins every vertex of a mesh, split in batches over the thread pool.
+     * @param mesh The mesh, its vertices and influences are read from Mesh::GetVertices and Mesh::GetSkin.
+     * @param boneMatrices The bone palette.
+     * @param boneCount The number of matrices of the palette.
+     * @param positions The output skinned positions, sized for every vertex of the mesh.
+     * @param normals The output skinned normals, or nullptr to skip them.
+     * @param batchSize The number of vertices skinned by a single batch.
+     */
+    void SkinMesh(const Mesh& mesh, const glm::mat4* boneMatrices, uint32_t boneCount, glm::vec3* positions, glm::vec3* normals, uint32_t batchSize = 4096);
+
+    /** @} */
+}
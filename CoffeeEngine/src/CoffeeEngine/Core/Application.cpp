@@ -1,6 +1,7 @@
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Layer.h"
 #include "CoffeeEngine/Core/Stopwatch.h"
+#include "CoffeeEngine/Core/ThreadPool.h"
 #include "CoffeeEngine/Events/KeyEvent.h"
 #include "CoffeeEngine/Renderer/Renderer.h"
 
@@ -22,6 +23,7 @@ namespace Coffee
         m_Window = Window::Create(WindowProps("Coffee Engine"));
         SetEventCallback(COFFEE_BIND_EVENT_FN(OnEvent));
 
+        ThreadPool::Init();
         Renderer::Init();
 
         m_ImGuiLayer = new ImGuiLayer();
@@ -30,6 +32,7 @@ namespace Coffee
 
     Application::~Application()
     {
+        ThreadPool::Shutdown();
     }
 
     void Application::PushLayer(Layer* layer)
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup core
+     * @{
+     */
+
+    /**
+     * @brief Sorts items by a 64-bit key with a stable least significant digit radix sort.
+     *
+     * The keys are read one byte per pass. The histograms of every pass are built in a single walk over the items,
+     * and a pass is skipped when all the keys share its byte, so keys using only some of their bits cost fewer passes.
+     *
+     * @tparam T The type of the items, copied between the two buffers.
+     * @tparam KeyFunc A callable returning the uint64_t key of an item.
+     * @param items The items to sort, sorted in place.
+     * @param scratch A buffer reused between calls to avoid allocating, resized to the size of items.
+     * @param key The key of an item.
+     */
+    template<typename T, typename KeyFunc>
+    void RadixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFunc&& key)
+    {
+        constexpr int kPasses = 8;
+        constexpr int kBuckets = 256;
+
+        size_t count = items.size();
+        if(count < 2)
+            return;
+
+        std::array<std::array<uint32_t, kBuckets>, kPasses> histograms = {};
+        for(const T& item : items)
+        {
+            uint64_t value = key(item);
+            for(int pass = 0; pass < kPasses; pass++)
+                histograms[pass][(value >> (pass * 8)) & 0xFF]++;
+        }
+
+        scratch.resize(count);
+        std::vector<T>* source = &items;
+        std::vector<T>* destination = &scratch;
+
+        for(int pass = 0; pass < kPasses; pass++)
+        {
+            std::array<uint32_t, kBuckets>& histogram = histograms[pass];
+
+            uint32_t firstByte = (key((*source)[0]) >> (pass * 8)) & 0xFF;
+            if(histogram[firstByte] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for(uint32_t& bucket : histogram)
+            {
+                uint32_t bucketCount = bucket;
+                bucket = offset;
+                offset += bucketCount;
+            }
+
+            for(const T& item : *source)
+                (*destination)[histogram[(key(item) >> (pass * 8)) & 0xFF]++] = item;
+
+            std::swap(source, destination);
+        }
+
+        if(source != &items)
+            items.swap(scratch);
+    }
+
+    /** @} */
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup core
+     * @{
+     */
+
+    /**
+     * @brief Hands out ranges of a linear space, like the elements of a large buffer, with a first fit free list.
+     *
+     * The free ranges are kept sorted by offset and merged with their neighbours when a range is freed,
+     * so freeing and allocating meshes of similar sizes does not fragment the space.
+     */
+    class RangeAllocator
+    {
+    public:
+        static constexpr uint32_t InvalidOffset = 0xFFFFFFFF; ///< Returned when no free range is large enough.
+
+        /**
+         * @brief Constructs an allocator with every element free.
+         * @param capacity The number of elements of the space.
+         */
+        explicit RangeAllocator(uint32_t capacity = 0) { Grow(capacity); }
+
+        /**
+         * @brief Allocates a range.
+         * @param size The number of elements.
+         * @return The offset of the range, or InvalidOffset if no free range is large enough.
+         */
+        uint32_t Allocate(uint32_t size)
+        {
+            if(size == 0)
+                return InvalidOffset;
+
+            for(size_t i = 0; i < m_Free.size(); i++)
+            {
+                Range& range = m_Free[i];
+                if(range.size < size)
+                    continue;
+
+                uint32_t offset = range.offset;
+                range.offset += size;
+                range.size -= size;
+                if(range.size == 0)
+                    m_Free.erase(m_Free.begin() + i);
+
+                m_Used += size;
+                return offset;
+            }
+            return InvalidOffset;
+        }
+
+        /**
+         * @brief Frees a range returned by Allocate.
+         * @param offset The offset of the range.
+         * @param size The number of elements given to Allocate.
+         */
+        void Free(uint32_t offset, uint32_t size)
+        {
+            if(offset == InvalidOffset || size == 0)
+                return;
+
+            auto next = std::lower_bound(m_Free.begin(), m_Free.end(), offset, [](const Range& range, uint32_t offset) { return range.offset < offset; });
+            next = m_Free.insert(next, {offset, size});
+            m_Used -= size;
+
+            // Merge with the following range first, so the iterator stays valid when merging with the previous one
+            if(next + 1 != m_Free.end() && next->offset + next->size == (next + 1)->offset)
+            {
+                next->size += (next + 1)->size;
+                m_Free.erase(next + 1);
+            }
+            if(next != m_Free.begin() && (next - 1)->offset + (next - 1)->size == next->offset)
+            {
+                (next - 1)->size += next->size;
+                m_Free.erase(next);
+            }
+        }
+
+        /**
+         * @brief Adds free elements at the end of the space.
+         * @param capacity The new number of elements, smaller values are ignored.
+         */
+        void Grow(uint32_t capacity)
+        {
+            if(capacity <= m_Capacity)
+                return;
+
+            uint32_t added = capacity - m_Capacity;
+            if(!m_Free.empty() && m_Free.back().offset + m_Free.back().size == m_Capacity)
+                m_Free.back().size += added;
+            else
+                m_Free.push_back({m_Capacity, added});
+
+            m_Capacity = capacity;
+        }
+
+        uint32_t GetCapacity() const { return m_Capacity; }
+        uint32_t GetUsed() const { return m_Used; }
+
+        /**
+         * @brief Gets the number of free elements at the end of the space, which a range larger than the free ones can extend.
+         */
+        uint32_t GetFreeTail() const
+        {
+            if(!m_Free.empty() && m_Free.back().offset + m_Free.back().size == m_Capacity)
+                return m_Free.back().size;
+            return 0;
+        }
+
+    private:
+        struct Range
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        std::vector<Range> m_Free; ///< The free ranges, sorted by offset and never adjacent.
+        uint32_t m_Capacity = 0;
+        uint32_t m_Used = 0;
+    };
+
+    /** @} */
+}
@@ -0,0 +1,178 @@
+#include "CoffeeEngine/Core/ThreadPool.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    /**
+     * @brief A ParallelFor in flight. It lives on the stack of the calling thread.
+     */
+    struct ParallelJob
+    {
+        const ThreadPool::BatchFunction* function = nullptr;
+        uint32_t count = 0;
+        uint32_t batchSize = 1;
+        uint32_t batchCount = 0;
+        std::atomic<uint32_t> nextBatch{0};
+    };
+
+    struct ThreadPoolData
+    {
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake; ///< Signaled when a job is published or the pool stops.
+        std::condition_variable done; ///< Signaled when the last worker leaves the job.
+        ParallelJob* job = nullptr; ///< The published job, nullptr once the calling thread has finished its share.
+        uint64_t generation = 0; ///< Incremented for every published job so a worker joins each job once.
+        uint32_t activeWorkers = 0; ///< The workers still processing the current job.
+        bool running = false;
+
+        std::mutex dispatchMutex; ///< Serializes the ParallelFor calls of different threads.
+    };
+
+    static ThreadPoolData s_ThreadPoolData;
+    static thread_local bool s_IsWorkerThread = false;
+
+    static void RunBatches(ParallelJob& job)
+    {
+        for (;;)
+        {
+            uint32_t batch = job.nextBatch.fetch_add(1, std::memory_order_relaxed);
+            if (batch >= job.batchCount)
+                return;
+
+            uint32_t begin = batch * job.batchSize;
+            uint32_t end = std::min(begin + job.batchSize, job.count);
+            (*job.function)(begin, end);
+        }
+    }
+
+    static void WorkerLoop(uint32_t index)
+    {
+        s_IsWorkerThread = true;
+
+        std::string name = "Worker " + std::to_string(index);
+        tracy::SetThreadName(name.c_str());
+
+        ThreadPoolData& data = s_ThreadPoolData;
+        uint64_t seenGeneration = 0;
+
+        for (;;)
+        {
+            ParallelJob* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(data.mutex);
+                data.wake.wait(lock, [&] { return !data.running || (data.job && data.generation != seenGeneration); });
+
+                if (!data.running)
+                    return;
+
+                seenGeneration = data.generation;
+                job = data.job;
+                data.activeWorkers++;
+            }
+
+            RunBatches(*job);
+
+            {
+                std::lock_guard<std::mutex> lock(data.mutex);
+                if (--data.activeWorkers == 0)
+                    data.done.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::Init(uint32_t workerCount)
+    {
+        ZoneScoped;
+
+        ThreadPoolData& data = s_ThreadPoolData;
+        if (data.running)
+            return;
+
+        if (workerCount == 0)
+        {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        data.running = true;
+        data.workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            data.workers.emplace_back(WorkerLoop, i);
+        }
+
+        COFFEE_CORE_INFO("ThreadPool: Started {0} worker threads", workerCount);
+    }
+
+    void ThreadPool::Shutdown()
+    {
+        ThreadPoolData& data = s_ThreadPoolData;
+        {
+            std::lock_guard<std::mutex> lock(data.mutex);
+            if (!data.running)
+                return;
+            data.running = false;
+        }
+        data.wake.notify_all();
+
+        for (std::thread& worker : data.workers)
+        {
+            worker.join();
+        }
+        data.workers.clear();
+    }
+
+    void ThreadPool::ParallelFor(uint32_t count, uint32_t batchSize, const BatchFunction& function)
+    {
+        if (count == 0)
+            return;
+
+        ThreadPoolData& data = s_ThreadPoolData;
+
+        ParallelJob job;
+        job.function = &function;
+        job.count = count;
+        job.batchSize = std::max(batchSize, 1u);
+        job.batchCount = (count + job.batchSize - 1) / job.batchSize;
+
+        // Nothing to share, or a worker asking for help: run on the calling thread
+        if (data.workers.empty() || s_IsWorkerThread || job.batchCount == 1)
+        {
+            RunBatches(job);
+            return;
+        }
+
+        std::lock_guard<std::mutex> dispatchLock(data.dispatchMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(data.mutex);
+            data.job = &job;
+            data.generation++;
+        }
+        data.wake.notify_all();
+
+        RunBatches(job);
+
+        // Every batch has been claimed, wait for the workers still running theirs
+        std::unique_lock<std::mutex> lock(data.mutex);
+        data.job = nullptr;
+        data.done.wait(lock, [&] { return data.activeWorkers == 0; });
+    }
+
+    uint32_t ThreadPool::GetWorkerCount()
+    {
+        return static_cast<uint32_t>(s_ThreadPoolData.workers.size());
+    }
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup core
+     * @{
+     */
+
+    /**
+     * @brief A fixed set of worker threads used to split per-frame work into batches.
+     *
+     * The calling thread takes part in the work, so a ParallelFor returns once every batch is done.
+     * Calls made from a worker run inline instead of waiting on the pool.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief Function processing the items in the range [begin, end).
+         */
+        using BatchFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+        /**
+         * @brief Starts the worker threads.
+         * @param workerCount The number of workers, 0 to use one per hardware thread minus the calling thread.
+         */
+        static void Init(uint32_t workerCount = 0);
+
+        /**
+         * @brief Stops and joins the worker threads.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Processes count items in batches spread over the workers and the calling thread.
+         * @param count The number of items.
+         * @param batchSize The number of items processed by a single call of the function.
+         * @param function The function called for every batch.
+         */
+        static void ParallelFor(uint32_t count, uint32_t batchSize, const BatchFunction& function);
+
+        /**
+         * @brief Gets the number of worker threads, not counting the calling thread.
+         */
+        static uint32_t GetWorkerCount();
+    };
+
+    /** @} */
+}
@@ -10,8 +10,13 @@ layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormals;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
-layout(location = 5) in ivec4 boneIds; 
-layout(location = 6) in vec4 weights;
+// Skin attributes, only bound for skinned meshes (see SkinData), the second set only with 8 influences
+layout (location = 5) in uvec4 boneIds;
+layout (location = 6) in vec4 weights;
+layout (location = 7) in uvec4 boneIds1;
+layout (location = 8) in vec4 weights1;
+// The first instance of a multi-draw, only bound by the vertex array of the geometry arena (see GeometryArena)
+layout (location = 9) in float aBaseInstance;
 
 layout (std140, binding = 0) uniform camera
 {
@@ -31,32 +36,86 @@ struct VertexData
 
 layout (location = 2) out VertexData Output;
 
+layout (location = 0) flat out vec3 OutEntityID;
+
 uniform mat4 model;
 uniform mat3 normalMatrix;
+uniform vec3 entityID;
+
+// The transforms of every instanced draw of the frame, instanceOffset is where the instances of this draw start
+struct InstanceData
+{
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 entityID;
+};
+
+layout (std430, binding = 4) readonly buffer instances
+{
+    InstanceData instanceData[];
+};
+
+uniform int instanceOffset = -1;
 
-const int MAX_BONES = 100;
-const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 finalBonesMatrices[MAX_BONES];
+// The palettes of every skinned draw of the frame, boneOffset is where the palette of this draw starts
+layout (std430, binding = 2) readonly buffer bonePalettes
+{
+    mat4 boneMatrices[];
+};
+
+uniform int boneOffset = -1;
+uniform int boneInfluences = 4;
+// Baked animations blend two palettes of the same skeleton, nextBoneOffset is -1 otherwise
+uniform int nextBoneOffset = -1;
+uniform float boneLerp = 0.0f;
+
+mat4 GetBoneMatrix(uint bone)
+{
+    mat4 boneMatrix = boneMatrices[boneOffset + int(bone)];
+    if(nextBoneOffset >= 0)
+        boneMatrix += (boneMatrices[nextBoneOffset + int(bone)] - boneMatrix) * boneLerp;
+    return boneMatrix;
+}
 
 void main()
 {
-    vec4 totalPosition = vec4(0.0f);
-    for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
+    mat4 modelMatrix = model;
+    mat3 normalModelMatrix = normalMatrix;
+    OutEntityID = entityID;
+    if(instanceOffset >= 0)
+    {
+        InstanceData instance = instanceData[instanceOffset + int(aBaseInstance) + gl_InstanceID];
+        modelMatrix = instance.model;
+        normalModelMatrix = instance.normalMatrix;
+        OutEntityID = instance.entityID.rgb;
+    }
+
+    // Static meshes, and skinned meshes without an animator, are drawn in their bind pose
+    mat4 skinMatrix = mat4(1.0f);
+    if(boneOffset >= 0)
     {
-        if(boneIds[i] == -1) 
-            continue;
-        if(boneIds[i] >=MAX_BONES) 
+        // Unused influences have a zero weight, weights of influenced vertices add up to one
+        mat4 blendedMatrix = mat4(0.0f);
+        for(int i = 0 ; i < 4 ; i++)
+            blendedMatrix += GetBoneMatrix(boneIds[i]) * weights[i];
+        float totalWeight = dot(weights, vec4(1.0f));
+
+        if(boneInfluences > 4)
         {
-            totalPosition = vec4(aPosition,1.0f);
-            break;
+            for(int i = 0 ; i < 4 ; i++)
+                blendedMatrix += GetBoneMatrix(boneIds1[i]) * weights1[i];
+            totalWeight += dot(weights1, vec4(1.0f));
         }
-        vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(aPosition,1.0f);
-        totalPosition += localPosition * weights[i];
-        vec3 localNormal = mat3(finalBonesMatrices[boneIds[i]]) * aNormals;
+
+        if(totalWeight > 0.0f)
+            skinMatrix = blendedMatrix;
     }
 
-    Output.WorldPos = vec3(model * totalPosition);
-    Output.Normal = normalMatrix * aNormals;
+    vec4 totalPosition = skinMatrix * vec4(aPosition, 1.0f);
+    vec3 skinnedNormal = mat3(skinMatrix) * aNormals;
+
+    Output.WorldPos = vec3(modelMatrix * totalPosition);
+    Output.Normal = normalModelMatrix * skinnedNormal;
     Output.camPos = cameraPos;
     Output.TexCoords = aTexCoord;
 
@@ -68,9 +127,9 @@ void main()
     //and then pass them to the fragment shader. But this way is more simple and easy to understand + for PBR is better to transform
     //the normal map to view space + im lazy to move the lights to the vertex shader
 
-    vec3 T = normalize(vec3(model * vec4(aTangent, 0.0)));
-    vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0)));
-    vec3 N = normalize(vec3(model * vec4(aNormals, 0.0)));
+    vec3 T = normalize(vec3(modelMatrix * skinMatrix * vec4(aTangent, 0.0)));
+    vec3 B = normalize(vec3(modelMatrix * skinMatrix * vec4(aBitangent, 0.0)));
+    vec3 N = normalize(vec3(modelMatrix * vec4(skinnedNormal, 0.0)));
 
     Output.TBN = mat3(T, B, N);
 }
@@ -81,7 +140,7 @@ void main()
 layout(location = 0) out vec4 FragColor;
 layout(location = 1) out vec4 EntityID;
 
-uniform vec3 entityID;
+layout (location = 0) flat in vec3 InEntityID;
 
 struct VertexData
 {
@@ -94,23 +153,22 @@ struct VertexData
 
 layout (location = 2) in VertexData VertexInput;
 
-/*Todo: Think if we should use a struct for the material or mimmic the Material
-        structs in the C++ code.
-*/
-struct Material
-{
-    sampler2D albedoMap;
-    sampler2D normalMap;
-    sampler2D metallicMap;
-    sampler2D roughnessMap;
-    sampler2D aoMap;
-    sampler2D emissiveMap;
+// The textures of the material, bound by Material::Use to these units
+layout (binding = 0) uniform sampler2D albedoMap;
+layout (binding = 1) uniform sampler2D normalMap;
+layout (binding = 2) uniform sampler2D metallicMap;
+layout (binding = 3) uniform sampler2D roughnessMap;
+layout (binding = 4) uniform sampler2D aoMap;
+layout (binding = 5) uniform sampler2D emissiveMap;
 
+// The properties of the material, one buffer per material only uploaded when they change (see MaterialUniformData)
+layout (std140, binding = 3) uniform MaterialData
+{
     vec4 color;
+    vec3 emissive;
     float metallic;
     float roughness;
     float ao;
-    vec3 emissive;
 
     int hasAlbedo;
     int hasNormal;
@@ -118,9 +176,7 @@ struct Material
     int hasRoughness;
     int hasAO;
     int hasEmissive;
-};
-
-uniform Material material;
+} material;
 
 #define MAX_LIGHTS 32
 
@@ -192,19 +248,19 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
 
 void main()
 {
-    vec3 albedo = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).rgb * material.color.rgb) + (1 - material.hasAlbedo) * material.color.rgb;
+    vec3 albedo = material.hasAlbedo * (texture(albedoMap, VertexInput.TexCoords).rgb * material.color.rgb) + (1 - material.hasAlbedo) * material.color.rgb;
 
     // Revise this type of conditional assignment (the commented one) because i think can lead to some undefined behavior in the shader!!!!!
-    vec3 normal/*  = material.hasNormal * (VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0)) + (1 - material.hasNormal) * VertexInput.Normal */;
+    vec3 normal/*  = material.hasNormal * (VertexInput.TBN * (texture(normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0)) + (1 - material.hasNormal) * VertexInput.Normal */;
     if (material.hasNormal == 1) {
-        normal = VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0);
+        normal = VertexInput.TBN * (texture(normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0);
     } else {
         normal = VertexInput.Normal;
     }
-    float metallic = material.hasMetallic * (texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic) + (1 - material.hasMetallic) * material.metallic;
-    float roughness = material.hasRoughness * (texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness) + (1 - material.hasRoughness) * material.roughness;
-    float ao = material.hasAO * (texture(material.aoMap, VertexInput.TexCoords).r * material.ao) + (1 - material.hasAO) * material.ao;
-    vec3 emissive = material.hasEmissive * (texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive) + (1 - material.hasEmissive) * material.emissive;
+    float metallic = material.hasMetallic * (texture(metallicMap, VertexInput.TexCoords).b * material.metallic) + (1 - material.hasMetallic) * material.metallic;
+    float roughness = material.hasRoughness * (texture(roughnessMap, VertexInput.TexCoords).g * material.roughness) + (1 - material.hasRoughness) * material.roughness;
+    float ao = material.hasAO * (texture(aoMap, VertexInput.TexCoords).r * material.ao) + (1 - material.hasAO) * material.ao;
+    vec3 emissive = material.hasEmissive * (texture(emissiveMap, VertexInput.TexCoords).rgb * material.emissive) + (1 - material.hasEmissive) * material.emissive;
 
     vec3 N = normalize(normal);
     vec3 V = normalize(VertexInput.camPos - VertexInput.WorldPos);
@@ -263,7 +319,7 @@ void main()
     vec3 color = ambient + Lo + emissive;
 
     FragColor = vec4(vec3(color), 1.0);
-    EntityID = vec4(entityID, 1.0f); //set the alpha to 0
+    EntityID = vec4(InEntityID, 1.0f); //set the alpha to 0
 
     //REMOVE: This is for the first release of the engine it should be handled differently
     if(showNormals)
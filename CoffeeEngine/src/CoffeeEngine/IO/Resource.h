@@ -29,6 +29,9 @@ namespace Coffee {
         Mesh,   ///< Mesh resource type
         Shader,   ///< Shader resource type
         Material, ///< Material resource type
+        AnimationLibrary, ///< Animation library resource type
+        AnimationGraph, ///< Animation graph resource type
+        Skeleton, ///< Skeleton resource type
     };
 
     /**
@@ -1,4 +1,6 @@
 #include "ResourceImporter.h"
+#include "CoffeeEngine/Animation/AnimationGraph.h"
+#include "CoffeeEngine/Animation/AnimationLibrary.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "ResourceSaver.h"
@@ -90,30 +92,42 @@ namespace Coffee {
         }
     }
 
-    Ref<Model> ResourceImporter::ImportModel(const std::filesystem::path& path, bool cache)
+    Ref<Model> ResourceImporter::ImportModel(const std::filesystem::path& path, const UUID& uuid, const SkinImportSettings& skinSettings, bool cache)
     {
         if (!cache)
         {
-            return CreateRef<Model>(path);
+            return CreateRef<Model>(path, skinSettings);
         }
 
-        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(path.filename().string());
+        // The UUID depends on the skin settings, so models imported with other settings have their own cache
+        std::string uuidString = std::to_string(uuid);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(uuidString);
 
         if (std::filesystem::exists(cachedFilePath))
         {
-            const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
-            return std::static_pointer_cast<Model>(resource);
+            try
+            {
+                const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+                return std::static_pointer_cast<Model>(resource);
+            }
+            catch (const cereal::Exception& e)
+            {
+                COFFEE_WARN("ResourceImporter::ImportModel: Cache of model {0} is out of date ({1}). Creating new model.", path.string(), e.what());
+            }
         }
         else
         {
             COFFEE_WARN("ResourceImporter::ImportModel: Model {0} not found in cache. Creating new model.", path.string());
-            Ref<Model> model = CreateRef<Model>(path);
-            ResourceSaver::SaveToCache(model->GetName(), model);
-            return model;
         }
+
+        Ref<Model> model = CreateRef<Model>(path, skinSettings);
+        model->SetUUID(uuid);
+        ResourceSaver::SaveToCache(uuidString, model);
+        return model;
     }
 
-    Ref<Mesh> ResourceImporter::ImportMesh(const std::string& name, const UUID& uuid, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Ref<Material>& material, const AABB& aabb)
+    Ref<Mesh> ResourceImporter::ImportMesh(const std::string& name, const UUID& uuid, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin, const MorphTargetData& morphTargets, Ref<Material>& material, const AABB& aabb)
     {
         // TODO: Think about adding a cache parameter.
 
@@ -123,20 +137,28 @@ namespace Coffee {
 
         if(std::filesystem::exists(cachedFilePath))
         {
-            const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
-            return std::static_pointer_cast<Mesh>(resource);
+            try
+            {
+                const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+                return std::static_pointer_cast<Mesh>(resource);
+            }
+            catch (const cereal::Exception& e)
+            {
+                COFFEE_WARN("ResourceImporter::ImportMesh: Cache of mesh {0} is out of date ({1}). Creating new mesh.", (uint64_t)uuid, e.what());
+            }
         }
         else
         {
             COFFEE_WARN("ResourceImporter::ImportMesh: Mesh {0} not found in cache. Creating new mesh.", (uint64_t)uuid);
-            Ref<Mesh> mesh = CreateRef<Mesh>(vertices, indices);
-            mesh->SetUUID(uuid);
-            mesh->SetName(name);
-            mesh->SetMaterial(material);
-            mesh->SetAABB(aabb);
-            ResourceSaver::SaveToCache(uuidString, mesh);
-            return mesh;
         }
+
+        Ref<Mesh> mesh = CreateRef<Mesh>(vertices, indices, skin, morphTargets);
+        mesh->SetUUID(uuid);
+        mesh->SetName(name);
+        mesh->SetMaterial(material);
+        mesh->SetAABB(aabb);
+        ResourceSaver::SaveToCache(uuidString, mesh);
+        return mesh;
     }
 
     Ref<Mesh> ResourceImporter::ImportMesh(const UUID& uuid)
@@ -147,8 +169,17 @@ namespace Coffee {
 
         if(std::filesystem::exists(cachedFilePath))
         {
-            const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
-            return std::static_pointer_cast<Mesh>(resource);
+            try
+            {
+                const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+                return std::static_pointer_cast<Mesh>(resource);
+            }
+            catch (const cereal::Exception& e)
+            {
+                // Without the source data the mesh can only be rebuilt by importing its model again
+                COFFEE_WARN("ResourceImporter::ImportMesh: Cache of mesh {0} is out of date ({1}).", (uint64_t)uuid, e.what());
+                return nullptr;
+            }
         }
         else
         {
@@ -219,6 +250,106 @@ namespace Coffee {
         }
     }
 
+    Ref<AnimationLibrary> ResourceImporter::ImportAnimationLibrary(const std::filesystem::path& path, const UUID& uuid, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake)
+    {
+        std::string uuidString = std::to_string(uuid);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(uuidString);
+
+        if(std::filesystem::exists(cachedFilePath))
+        {
+            try
+            {
+                // The UUID covers the bone map and the settings, so the cached library was imported with the same ones
+                const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+                return std::static_pointer_cast<AnimationLibrary>(resource);
+            }
+            catch (const cereal::Exception& e)
+            {
+                COFFEE_WARN("ResourceImporter::ImportAnimationLibrary: Cache of the animations of {0} is out of date ({1}). Importing animations.", path.string(), e.what());
+            }
+        }
+        else
+        {
+            COFFEE_WARN("ResourceImporter::ImportAnimationLibrary: Animations of {0} not found in cache. Importing animations.", path.string());
+        }
+
+        // A failed import is not cached, so the file is imported again once it is fixed
+        Ref<AnimationLibrary> library = CreateRef<AnimationLibrary>(path, boneInfoMap, compression, bake);
+        if(!library->IsValid())
+            return nullptr;
+
+        library->SetUUID(uuid);
+        ResourceSaver::SaveToCache(uuidString, library);
+        return library;
+    }
+
+    Ref<AnimationLibrary> ResourceImporter::ImportAnimationLibrary(const UUID& uuid)
+    {
+        std::string uuidString = std::to_string(uuid);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(uuidString);
+
+        if(std::filesystem::exists(cachedFilePath))
+        {
+            try
+            {
+                const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+                return std::static_pointer_cast<AnimationLibrary>(resource);
+            }
+            catch (const cereal::Exception& e)
+            {
+                COFFEE_WARN("ResourceImporter::ImportAnimationLibrary: Cache of AnimationLibrary {0} is out of date ({1}).", (uint64_t)uuid, e.what());
+                return nullptr;
+            }
+        }
+        else
+        {
+            COFFEE_WARN("ResourceImporter::ImportAnimationLibrary: AnimationLibrary {0} not found in cache.", (uint64_t)uuid);
+            return nullptr;
+        }
+    }
+
+    Ref<AnimationGraph> ResourceImporter::ImportAnimationGraph(const std::string& name, const UUID& uuid)
+    {
+        std::string uuidString = std::to_string(uuid);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(uuidString);
+
+        if(std::filesystem::exists(cachedFilePath))
+        {
+            const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+            return std::static_pointer_cast<AnimationGraph>(resource);
+        }
+        else
+        {
+            COFFEE_WARN("ResourceImporter::ImportAnimationGraph: AnimationGraph {0} not found in cache. Creating new animation graph.", (uint64_t)uuid);
+            Ref<AnimationGraph> graph = CreateRef<AnimationGraph>();
+            graph->SetUUID(uuid);
+            graph->SetName(name);
+            ResourceSaver::SaveToCache(uuidString, graph);
+            return graph;
+        }
+    }
+
+    Ref<AnimationGraph> ResourceImporter::ImportAnimationGraph(const UUID& uuid)
+    {
+        std::string uuidString = std::to_string(uuid);
+
+        std::filesystem::path cachedFilePath = CacheManager::GetCachedFilePath(uuidString);
+
+        if(std::filesystem::exists(cachedFilePath))
+        {
+            const Ref<Resource>& resource = LoadFromCache(cachedFilePath, ResourceFormat::Binary);
+            return std::static_pointer_cast<AnimationGraph>(resource);
+        }
+        else
+        {
+            COFFEE_WARN("ResourceImporter::ImportAnimationGraph: AnimationGraph {0} not found in cache.", (uint64_t)uuid);
+            return nullptr;
+        }
+    }
+
     Ref<Resource> ResourceImporter::LoadFromCache(const std::filesystem::path& path, ResourceFormat format)
         {
             COFFEE_INFO("Loading resource from cache: {0}", path.string());
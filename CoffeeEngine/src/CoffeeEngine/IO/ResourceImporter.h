@@ -6,13 +6,17 @@
 
 #pragma once
 
+#include "CoffeeEngine/Animation/AnimationCompression.h"
+#include "CoffeeEngine/Animation/BakedAnimation.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceFormat.h"
 #include "CoffeeEngine/Math/BoundingBox.h"
+#include "CoffeeEngine/Renderer/SkinData.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
+#include <map>
 #include <string>
 
 namespace Coffee {
@@ -20,12 +24,17 @@ namespace Coffee {
     class Model;
     class Mesh;
     struct Vertex;
+    class MorphTargetData;
 
     class Material;
     struct MaterialTextures;
     class Texture;
     class Texture2D;
 
+    class AnimationLibrary;
+    class AnimationGraph;
+    struct BoneInfo;
+
     /**
      * @class ResourceImporter
      * @brief Handles the import of resources such as textures.
@@ -44,13 +53,35 @@ namespace Coffee {
         Ref<Texture2D> ImportTexture2D(const UUID& uuid);
         Ref<Cubemap> ImportCubemap(const std::filesystem::path& path, const UUID& uuid);
         Ref<Cubemap> ImportCubemap(const UUID& uuid);
-        Ref<Model> ImportModel(const std::filesystem::path& path, bool cache);
-        Ref<Mesh> ImportMesh(const std::string& name, const UUID& uuid, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Ref<Material>& material, const AABB& aabb);
+        /**
+         * @brief Imports a model, or loads it from the cache.
+         * @param path The file path of the model.
+         * @param uuid The UUID of the model, which names its cache file.
+         * @param skinSettings How the bone weights of the skinned meshes are compacted.
+         * @param cache Whether the model should be cached.
+         * @return The imported model.
+         */
+        Ref<Model> ImportModel(const std::filesystem::path& path, const UUID& uuid, const SkinImportSettings& skinSettings, bool cache);
+        Ref<Mesh> ImportMesh(const std::string& name, const UUID& uuid, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin, const MorphTargetData& morphTargets, Ref<Material>& material, const AABB& aabb);
         Ref<Mesh> ImportMesh(const UUID& uuid);
 
         Ref<Material> ImportMaterial(const std::string& name, const UUID& uuid);
         Ref<Material> ImportMaterial(const std::string& name, const UUID& uuid, MaterialTextures& materialTextures);
         Ref<Material> ImportMaterial(const UUID& uuid);
+
+        /**
+         * @brief Imports every animation clip of a file, or loads them from the cache.
+         * @param path The file path of the animations to import.
+         * @param uuid The UUID of the animation library.
+         * @param boneInfoMap The bones of the model the clips animate.
+         * @param compression The compression applied to the keys of the clips.
+         * @return A reference to the imported animation library.
+         */
+        Ref<AnimationLibrary> ImportAnimationLibrary(const std::filesystem::path& path, const UUID& uuid, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake);
+        Ref<AnimationLibrary> ImportAnimationLibrary(const UUID& uuid);
+
+        Ref<AnimationGraph> ImportAnimationGraph(const std::string& name, const UUID& uuid);
+        Ref<AnimationGraph> ImportAnimationGraph(const UUID& uuid);
     private:
         /**
          * @brief Loads a resource from the cache.
@@ -1,4 +1,6 @@
 #include "ResourceLoader.h"
+#include "CoffeeEngine/Animation/AnimationGraph.h"
+#include "CoffeeEngine/Animation/AnimationLibrary.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/IO/CacheManager.h"
@@ -9,6 +11,7 @@
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/IO/ResourceImporter.h"
+#include "CoffeeEngine/IO/ResourceSaver.h"
 #include "CoffeeEngine/IO/ResourceUtils.h"
 #include <filesystem>
 #include <fstream>
@@ -163,7 +166,26 @@ namespace Coffee {
         return nullptr;
     }
 
-    Ref<Model> ResourceLoader::LoadModel(const std::filesystem::path& path, bool cache)
+    // FNV-1a over the skin settings of a model import, stable across runs so the cache can be found again
+    static uint64_t HashSkinImport(const SkinImportSettings& skinSettings)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto hashBytes = [&hash](const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        hashBytes(&skinSettings.maxInfluences, sizeof(skinSettings.maxInfluences));
+        hashBytes(&skinSettings.weightFormat, sizeof(skinSettings.weightFormat));
+
+        return hash;
+    }
+
+    Ref<Model> ResourceLoader::LoadModel(const std::filesystem::path& path, bool cache, const SkinImportSettings& skinSettings)
     {
         if(GetResourceTypeFromExtension(path) != ResourceType::Model)
         {
@@ -171,30 +193,37 @@ namespace Coffee {
             return nullptr;
         }
 
-        UUID uuid = GetUUIDFromImportFile(path);
+        UUID uuid = GetModelUUID(path, skinSettings);
 
         if(ResourceRegistry::Exists(uuid))
         {
             return ResourceRegistry::Get<Model>(uuid);
         }
 
-        const Ref<Model>& model = s_Importer.ImportModel(path, cache);
+        const Ref<Model>& model = s_Importer.ImportModel(path, uuid, skinSettings, cache);
         model->SetUUID(uuid);
 
         ResourceRegistry::Add(uuid, model);
         return model;
     }
 
-    Ref<Mesh> ResourceLoader::LoadMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Ref<Material>& material, const AABB& aabb)
+    Ref<Mesh> ResourceLoader::LoadMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin, const MorphTargetData& morphTargets, Ref<Material>& material, const AABB& aabb)
     {
+        // A mesh of the same name is only shared when its skin was compacted the same way, the models of
+        // another import of the file get their own
+        bool sameSkin = true;
         if(ResourceRegistry::Exists(name))
         {
-            return ResourceRegistry::Get<Mesh>(name);
+            const Ref<Mesh>& registered = ResourceRegistry::Get<Mesh>(name);
+            const SkinData& registeredSkin = registered->GetSkin();
+            sameSkin = registeredSkin.GetInfluenceCount() == skin.GetInfluenceCount() && registeredSkin.GetWeightFormat() == skin.GetWeightFormat();
+            if(sameSkin)
+                return registered;
         }
-        
-        UUID uuid = ResourceRegistry::GetUUIDByName(name);
 
-        const Ref<Mesh>& mesh = s_Importer.ImportMesh(name, uuid, vertices, indices, material, aabb);
+        UUID uuid = sameSkin ? ResourceRegistry::GetUUIDByName(name) : UUID();
+
+        const Ref<Mesh>& mesh = s_Importer.ImportMesh(name, uuid, vertices, indices, skin, morphTargets, material, aabb);
         mesh->SetName(name);
 
         ResourceRegistry::Add(uuid, mesh);
@@ -209,6 +238,8 @@ namespace Coffee {
         }
 
         const Ref<Mesh>& mesh = s_Importer.ImportMesh(uuid);
+        if(!mesh)
+            return nullptr;
 
         ResourceRegistry::Add(uuid, mesh);
         return mesh;
@@ -295,6 +326,123 @@ namespace Coffee {
         return material;
     }
 
+    // FNV-1a over the inputs of an animation import besides the file, stable across runs so the cache can be found again
+    static uint64_t HashAnimationImport(const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto hashBytes = [&hash](const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        // The bone ids and offsets end up in the clips, the skeleton and the baked palettes
+        for (const auto& [name, info] : boneInfoMap)
+        {
+            hashBytes(name.data(), name.size() + 1);
+            hashBytes(&info.id, sizeof(info.id));
+            hashBytes(&info.offset, sizeof(info.offset));
+        }
+
+        hashBytes(&compression.enabled, sizeof(compression.enabled));
+        if (compression.enabled)
+        {
+            hashBytes(&compression.positionTolerance, sizeof(compression.positionTolerance));
+            hashBytes(&compression.rotationTolerance, sizeof(compression.rotationTolerance));
+            hashBytes(&compression.scaleTolerance, sizeof(compression.scaleTolerance));
+        }
+
+        hashBytes(&bake.enabled, sizeof(bake.enabled));
+        if (bake.enabled)
+            hashBytes(&bake.frameRate, sizeof(bake.frameRate));
+
+        return hash;
+    }
+
+    Ref<AnimationLibrary> ResourceLoader::LoadAnimationLibrary(const std::filesystem::path& path, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake)
+    {
+        if(GetResourceTypeFromExtension(path) != ResourceType::Model)
+        {
+            COFFEE_CORE_ERROR("ResourceLoader::Load<AnimationLibrary>: Resource is not a model!");
+            return nullptr;
+        }
+
+        GenerateImportFile(path);
+
+        // The library shares the .import file with the model of the same file, so it needs its own UUID. Imports of the same file
+        // with another bone map or other settings get another UUID, and so another cache file, instead of the first result
+        constexpr uint64_t animationLibraryTag = 0x9E3779B97F4A7C15ull;
+        UUID uuid = UUID(static_cast<uint64_t>(GetUUIDFromImportFile(path)) ^ animationLibraryTag ^ HashAnimationImport(boneInfoMap, compression, bake));
+
+        if(ResourceRegistry::Exists(uuid))
+        {
+            return ResourceRegistry::Get<AnimationLibrary>(uuid);
+        }
+
+        const Ref<AnimationLibrary>& library = s_Importer.ImportAnimationLibrary(path, uuid, boneInfoMap, compression, bake);
+        if(!library)
+            return nullptr;
+
+        library->SetUUID(uuid);
+
+        ResourceRegistry::Add(uuid, library);
+        return library;
+    }
+
+    Ref<AnimationLibrary> ResourceLoader::LoadAnimationLibrary(UUID uuid)
+    {
+        if(uuid == UUID::null)
+            return nullptr;
+
+        if(ResourceRegistry::Exists(uuid))
+        {
+            return ResourceRegistry::Get<AnimationLibrary>(uuid);
+        }
+
+        const Ref<AnimationLibrary>& library = s_Importer.ImportAnimationLibrary(uuid);
+        if(!library)
+            return nullptr;
+
+        ResourceRegistry::Add(uuid, library);
+        return library;
+    }
+
+    Ref<AnimationGraph> ResourceLoader::LoadAnimationGraph(const std::string& name)
+    {
+        if(ResourceRegistry::Exists(name))
+        {
+            return ResourceRegistry::Get<AnimationGraph>(name);
+        }
+
+        UUID uuid;
+
+        Ref<AnimationGraph> graph = s_Importer.ImportAnimationGraph(name, uuid);
+        graph->SetUUID(uuid);
+        ResourceRegistry::Add(uuid, graph);
+        return graph;
+    }
+
+    Ref<AnimationGraph> ResourceLoader::LoadAnimationGraph(UUID uuid)
+    {
+        if(uuid == UUID::null)
+            return nullptr;
+
+        if(ResourceRegistry::Exists(uuid))
+        {
+            return ResourceRegistry::Get<AnimationGraph>(uuid);
+        }
+
+        const Ref<AnimationGraph>& graph = s_Importer.ImportAnimationGraph(uuid);
+        if(!graph)
+            return nullptr;
+
+        ResourceRegistry::Add(uuid, graph);
+        return graph;
+    }
+
     void ResourceLoader::RemoveResource(UUID uuid) // Think if would be better to pass the Resource as parameter
     {
         if(!ResourceRegistry::Exists(uuid))
@@ -331,7 +479,8 @@ namespace Coffee {
 
     void ResourceLoader::RemoveResource(const std::filesystem::path& path)
     {
-        UUID uuid = GetUUIDFromImportFile(path);
+        // Models are registered under the UUID LoadModel derives, the ones of the editor use the default skin settings
+        UUID uuid = GetResourceTypeFromExtension(path) == ResourceType::Model ? GetModelUUID(path, {}) : GetUUIDFromImportFile(path);
         
         // Remove the Cache file and all dependencies(TODO)
         std::filesystem::path cacheFilePath = CacheManager::GetCachePath() / (std::to_string(uuid) + ".res");
@@ -340,9 +489,9 @@ namespace Coffee {
             std::filesystem::remove(cacheFilePath);
         }
 
-        const Ref<Resource>& resource = ResourceRegistry::Get<Resource>(uuid);
-
-        const std::filesystem::path& resourcePath = resource->GetPath();
+        // Files that were never loaded have no registered resource, their own path is removed instead
+        bool registered = ResourceRegistry::Exists(uuid);
+        std::filesystem::path resourcePath = registered ? ResourceRegistry::Get<Resource>(uuid)->GetPath() : path;
         std::filesystem::path importFilePath = resourcePath;
         importFilePath.replace_extension(".import");
 
@@ -356,7 +505,7 @@ namespace Coffee {
             std::filesystem::remove(resourcePath);
         }
 
-        if(ResourceRegistry::Exists(uuid))
+        if(registered)
         {
             ResourceRegistry::Remove(uuid);
         }
@@ -409,6 +558,12 @@ namespace Coffee {
         return importData;
     }
 
+    UUID ResourceLoader::GetModelUUID(const std::filesystem::path& path, const SkinImportSettings& skinSettings)
+    {
+        // Imports of the same file with other skin settings get another UUID, and so another cache file, instead of the first result
+        return UUID(static_cast<uint64_t>(GetUUIDFromImportFile(path)) ^ HashSkinImport(skinSettings));
+    }
+
     UUID ResourceLoader::GetUUIDFromImportFile(const std::filesystem::path& path)
     {
         ImportData importData = GetImportData(path);
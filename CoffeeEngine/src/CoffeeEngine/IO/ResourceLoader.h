@@ -17,10 +17,15 @@ namespace Coffee {
 
     class Model;
     class Mesh;
+    class MorphTargetData;
     class Material;
     class Texture;
     class Texture2D;
 
+    class AnimationLibrary;
+    class AnimationGraph;
+    struct BoneInfo;
+
     /**
      * @class ResourceLoader
      * @brief Loads resources such as textures and models for the CoffeeEngine.
@@ -57,11 +62,12 @@ namespace Coffee {
          * @brief Loads a model from a file.
          * @param path The file path of the model to load.
          * @param cache Whether the model should be cached.
+         * @param skinSettings How the bone weights of the skinned meshes are compacted, part of the cache key.
          * @return A reference to the loaded model.
          */
-        static Ref<Model> LoadModel(const std::filesystem::path& path, bool cache = true);
+        static Ref<Model> LoadModel(const std::filesystem::path& path, bool cache = true, const SkinImportSettings& skinSettings = {});
 
-        static Ref<Mesh> LoadMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Ref<Material>& material, const AABB& aabb);
+        static Ref<Mesh> LoadMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin, const MorphTargetData& morphTargets, Ref<Material>& material, const AABB& aabb);
         static Ref<Mesh> LoadMesh(UUID uuid);
 
         static Ref<Shader> LoadShader(const std::filesystem::path& shaderPath);
@@ -71,6 +77,31 @@ namespace Coffee {
         static Ref<Material> LoadMaterial(const std::string& name, MaterialTextures& materialTextures);
         static Ref<Material> LoadMaterial(UUID uuid);
 
+        /**
+         * @brief Loads every animation clip of a file.
+         *
+         * The clips are imported with a single parse of the file and cached, later runs load them from the cache.
+         *
+         * @param path The file path of the animations to load.
+         * @param boneInfoMap The bones of the model the clips animate.
+         * @param compression The compression applied to the keys of the clips.
+         * @param bake Whether the clips are also baked into palette tables for crowds.
+         * @return A reference to the loaded animation library, or nullptr if the file has no animations.
+         */
+        static Ref<AnimationLibrary> LoadAnimationLibrary(const std::filesystem::path& path, const std::map<std::string, BoneInfo>& boneInfoMap, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake = {});
+        static Ref<AnimationLibrary> LoadAnimationLibrary(UUID uuid);
+
+        /**
+         * @brief Loads an animation graph by name, creating an empty one if it does not exist.
+         *
+         * Graphs edited after loading are persisted with ResourceSaver::SaveToCache.
+         *
+         * @param name The name of the animation graph.
+         * @return A reference to the loaded animation graph.
+         */
+        static Ref<AnimationGraph> LoadAnimationGraph(const std::string& name);
+        static Ref<AnimationGraph> LoadAnimationGraph(UUID uuid);
+
         static void RemoveResource(UUID uuid);
         static void RemoveResource(const std::filesystem::path& path);
 
@@ -92,6 +123,11 @@ namespace Coffee {
         static ImportData GetImportData(const std::filesystem::path& path);
 
         static UUID GetUUIDFromImportFile(const std::filesystem::path& path);
+
+        /**
+         * @brief Gets the UUID a model is registered and cached under, the one of its import file mixed with the skin settings.
+         */
+        static UUID GetModelUUID(const std::filesystem::path& path, const SkinImportSettings& skinSettings);
         static std::filesystem::path GetPathFromImportFile(const std::filesystem::path& path);
     private:
         static std::filesystem::path s_WorkingDirectory; ///< The working directory of the resource loader.
@@ -28,6 +28,12 @@ namespace Coffee
             break;
         case Coffee::ResourceType::Shader:
             break;
+        case Coffee::ResourceType::AnimationLibrary:
+            return ResourceFormat::Binary;
+            break;
+        case Coffee::ResourceType::AnimationGraph:
+            return ResourceFormat::Binary;
+            break;
         default:
             return ResourceFormat::Binary;
             break;
@@ -45,6 +45,12 @@ namespace Coffee {
             return "Shader";
         case ResourceType::Material:
             return "Material";
+        case ResourceType::AnimationLibrary:
+            return "AnimationLibrary";
+        case ResourceType::AnimationGraph:
+            return "AnimationGraph";
+        case ResourceType::Skeleton:
+            return "Skeleton";
         default:
             return "Unknown";
         }
@@ -44,10 +44,10 @@ namespace Coffee {
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void VertexBuffer::SetData(void* data, uint32_t size)
+    void VertexBuffer::SetData(void* data, uint32_t size, uint32_t offset)
     {
         glBindBuffer(GL_ARRAY_BUFFER, m_vboID);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
     }
 
     Ref<VertexBuffer> VertexBuffer::Create(uint32_t size)
@@ -64,9 +64,9 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glGenBuffers(1, &m_eboID);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_eboID);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+        // Binding it would attach it to whichever vertex array is bound, which the state cache leaves bound between draws
+        glCreateBuffers(1, &m_eboID);
+        glNamedBufferData(m_eboID, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
     }
 
     IndexBuffer::~IndexBuffer()
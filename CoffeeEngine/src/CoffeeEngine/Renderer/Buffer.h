@@ -16,7 +16,7 @@ namespace Coffee {
      */
     enum class ShaderDataType
     {
-        None = 0, Bool, Int, Float, Vec2, Vec3, Vec4, Mat2, Mat3, Mat4
+        None = 0, Bool, Int, IVec4, UByte4, UShort4, Float, Vec2, Vec3, Vec4, Mat2, Mat3, Mat4
     };
 
     /**
@@ -30,6 +30,9 @@ namespace Coffee {
         {
             case ShaderDataType::Bool:     return 1;
             case ShaderDataType::Int:      return 4;
+            case ShaderDataType::IVec4:    return 4 * 4;
+            case ShaderDataType::UByte4:   return 1 * 4;
+            case ShaderDataType::UShort4:  return 2 * 4;
             case ShaderDataType::Float:    return 4;
             case ShaderDataType::Vec2:     return 4 * 2;
             case ShaderDataType::Vec3:     return 4 * 3;
@@ -80,6 +83,9 @@ namespace Coffee {
             {
                 case ShaderDataType::Bool:    return 1;
                 case ShaderDataType::Int:     return 1;
+                case ShaderDataType::IVec4:   return 4;
+                case ShaderDataType::UByte4:  return 4;
+                case ShaderDataType::UShort4: return 4;
                 case ShaderDataType::Float:   return 1;
                 case ShaderDataType::Vec2:    return 2;
                 case ShaderDataType::Vec3:    return 3;
@@ -210,8 +216,9 @@ namespace Coffee {
          * @brief Sets the data of the vertex buffer.
          * @param data The data to set.
          * @param size The size of the data.
+         * @param offset The offset in bytes at which the data is written.
          */
-        void SetData(void* data, uint32_t size);
+        void SetData(void* data, uint32_t size, uint32_t offset = 0);
 
         /**
          * @brief Returns the layout of the vertex buffer.
@@ -0,0 +1,207 @@
+#include "CoffeeEngine/Renderer/GeometryArena.h"
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
+
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <numeric>
+
+namespace Coffee {
+
+    static constexpr uint32_t s_InitialVertexCapacity = 1 << 16;
+    static constexpr uint32_t s_InitialIndexCapacity = 1 << 18;
+    static constexpr uint32_t s_InitialInstanceCapacity = 1024;
+    static constexpr uint32_t s_InitialDrawCommandCapacity = 256;
+
+    uint32_t GeometryArena::s_VertexArray = 0;
+    uint32_t GeometryArena::s_VertexBuffer = 0;
+    uint32_t GeometryArena::s_IndexBuffer = 0;
+    uint32_t GeometryArena::s_BaseInstanceBuffer = 0;
+    uint32_t GeometryArena::s_BaseInstanceCapacity = 0;
+    uint32_t GeometryArena::s_DrawCommandBuffer = 0;
+    uint32_t GeometryArena::s_DrawCommandCapacity = 0;
+    uint32_t GeometryArena::s_DrawCommandSegment = 0;
+    RangeAllocator GeometryArena::s_Vertices;
+    RangeAllocator GeometryArena::s_Indices;
+
+    // Creates a buffer of the new size holding the content of the old one, which is deleted
+    static uint32_t ResizeBuffer(uint32_t buffer, uint32_t oldSize, uint32_t newSize, GLenum usage)
+    {
+        uint32_t resized;
+        glCreateBuffers(1, &resized);
+        glNamedBufferData(resized, newSize, nullptr, usage);
+
+        if(buffer != 0)
+        {
+            glCopyNamedBufferSubData(buffer, resized, 0, 0, oldSize);
+            glDeleteBuffers(1, &buffer);
+        }
+        return resized;
+    }
+
+    void GeometryArena::Init()
+    {
+        ZoneScoped;
+
+        glCreateVertexArrays(1, &s_VertexArray);
+
+        // The attributes of Vertex, at the locations of the standard shader
+        glEnableVertexArrayAttrib(s_VertexArray, 0);
+        glVertexArrayAttribFormat(s_VertexArray, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position));
+        glEnableVertexArrayAttrib(s_VertexArray, 1);
+        glVertexArrayAttribFormat(s_VertexArray, 1, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, TexCoords));
+        glEnableVertexArrayAttrib(s_VertexArray, 2);
+        glVertexArrayAttribFormat(s_VertexArray, 2, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Normals));
+        glEnableVertexArrayAttrib(s_VertexArray, 3);
+        glVertexArrayAttribFormat(s_VertexArray, 3, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Tangent));
+        glEnableVertexArrayAttrib(s_VertexArray, 4);
+        glVertexArrayAttribFormat(s_VertexArray, 4, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Bitangent));
+        for(uint32_t location = 0; location < 5; location++)
+            glVertexArrayAttribBinding(s_VertexArray, location, 0);
+
+        // Instanced attributes read element baseInstance + gl_InstanceID / divisor, with the largest divisor that is baseInstance
+        glEnableVertexArrayAttrib(s_VertexArray, BaseInstanceLocation);
+        glVertexArrayAttribFormat(s_VertexArray, BaseInstanceLocation, 1, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(s_VertexArray, BaseInstanceLocation, 1);
+        glVertexArrayBindingDivisor(s_VertexArray, 1, 0xFFFFFFFF);
+
+        s_Vertices = RangeAllocator();
+        s_Indices = RangeAllocator();
+        GrowVertices(s_InitialVertexCapacity);
+        GrowIndices(s_InitialIndexCapacity);
+        ReserveInstances(s_InitialInstanceCapacity);
+
+        s_DrawCommandCapacity = s_InitialDrawCommandCapacity;
+        glCreateBuffers(1, &s_DrawCommandBuffer);
+        glNamedBufferData(s_DrawCommandBuffer, s_DrawCommandCapacity * sizeof(DrawElementsIndirectCommand) * DrawCommandFrames, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    void GeometryArena::Shutdown()
+    {
+        if(!IsInitialized())
+            return;
+
+        glDeleteVertexArrays(1, &s_VertexArray);
+        RenderState::OnVertexArrayDeleted(s_VertexArray);
+
+        uint32_t buffers[] = { s_VertexBuffer, s_IndexBuffer, s_BaseInstanceBuffer, s_DrawCommandBuffer };
+        glDeleteBuffers(4, buffers);
+
+        s_VertexArray = s_VertexBuffer = s_IndexBuffer = s_BaseInstanceBuffer = s_DrawCommandBuffer = 0;
+        s_BaseInstanceCapacity = s_DrawCommandCapacity = s_DrawCommandSegment = 0;
+    }
+
+    GeometryArenaAllocation GeometryArena::Allocate(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+    {
+        ZoneScoped;
+
+        if(!IsInitialized() || vertexCount == 0 || indexCount == 0)
+            return {};
+
+        GeometryArenaAllocation allocation;
+        allocation.vertexCount = vertexCount;
+        allocation.indexCount = indexCount;
+
+        allocation.baseVertex = s_Vertices.Allocate(vertexCount);
+        if(allocation.baseVertex == RangeAllocator::InvalidOffset)
+        {
+            GrowVertices(std::bit_ceil(s_Vertices.GetCapacity() + vertexCount - s_Vertices.GetFreeTail()));
+            allocation.baseVertex = s_Vertices.Allocate(vertexCount);
+        }
+
+        allocation.firstIndex = s_Indices.Allocate(indexCount);
+        if(allocation.firstIndex == RangeAllocator::InvalidOffset)
+        {
+            GrowIndices(std::bit_ceil(s_Indices.GetCapacity() + indexCount - s_Indices.GetFreeTail()));
+            allocation.firstIndex = s_Indices.Allocate(indexCount);
+        }
+
+        COFFEE_CORE_ASSERT(allocation.baseVertex != RangeAllocator::InvalidOffset && allocation.firstIndex != RangeAllocator::InvalidOffset,
+                           "GeometryArena: the arena could not grow!");
+
+        // The indices stay relative to the mesh, the draws add baseVertex
+        glNamedBufferSubData(s_VertexBuffer, allocation.baseVertex * sizeof(Vertex), vertexCount * sizeof(Vertex), vertices);
+        glNamedBufferSubData(s_IndexBuffer, allocation.firstIndex * sizeof(uint32_t), indexCount * sizeof(uint32_t), indices);
+
+        return allocation;
+    }
+
+    void GeometryArena::Free(const GeometryArenaAllocation& allocation)
+    {
+        // Meshes released after the renderer shut down have nothing left to free
+        if(!IsInitialized() || !allocation.IsValid())
+            return;
+
+        s_Vertices.Free(allocation.baseVertex, allocation.vertexCount);
+        s_Indices.Free(allocation.firstIndex, allocation.indexCount);
+    }
+
+    uint32_t GeometryArena::UploadDrawCommands(const std::vector<DrawElementsIndirectCommand>& commands)
+    {
+        ZoneScoped;
+
+        uint32_t count = static_cast<uint32_t>(commands.size());
+        if(count > s_DrawCommandCapacity)
+        {
+            s_DrawCommandCapacity = std::bit_ceil(count);
+            glNamedBufferData(s_DrawCommandBuffer, s_DrawCommandCapacity * sizeof(DrawElementsIndirectCommand) * DrawCommandFrames, nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        // Rotates through the segments like a ShaderStorageRingBuffer, the indirect buffer is not a storage buffer
+        s_DrawCommandSegment = (s_DrawCommandSegment + 1) % DrawCommandFrames;
+
+        uint32_t offset = s_DrawCommandSegment * s_DrawCommandCapacity * sizeof(DrawElementsIndirectCommand);
+        glNamedBufferSubData(s_DrawCommandBuffer, offset, count * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_DrawCommandBuffer);
+
+        return offset;
+    }
+
+    void GeometryArena::ReserveInstances(uint32_t instanceCount)
+    {
+        if(instanceCount <= s_BaseInstanceCapacity)
+            return;
+
+        ZoneScoped;
+
+        uint32_t capacity = std::bit_ceil(instanceCount);
+        std::vector<float> baseInstances(capacity);
+        std::iota(baseInstances.begin(), baseInstances.end(), 0.0f);
+
+        if(s_BaseInstanceBuffer == 0)
+            glCreateBuffers(1, &s_BaseInstanceBuffer);
+        glNamedBufferData(s_BaseInstanceBuffer, capacity * sizeof(float), baseInstances.data(), GL_STATIC_DRAW);
+        glVertexArrayVertexBuffer(s_VertexArray, 1, s_BaseInstanceBuffer, 0, sizeof(float));
+
+        s_BaseInstanceCapacity = capacity;
+    }
+
+    void GeometryArena::Bind()
+    {
+        RenderState::BindVertexArray(s_VertexArray);
+    }
+
+    void GeometryArena::GrowVertices(uint32_t capacity)
+    {
+        ZoneScoped;
+
+        s_VertexBuffer = ResizeBuffer(s_VertexBuffer, s_Vertices.GetCapacity() * sizeof(Vertex), capacity * sizeof(Vertex), GL_STATIC_DRAW);
+        glVertexArrayVertexBuffer(s_VertexArray, 0, s_VertexBuffer, 0, sizeof(Vertex));
+        s_Vertices.Grow(capacity);
+    }
+
+    void GeometryArena::GrowIndices(uint32_t capacity)
+    {
+        ZoneScoped;
+
+        s_IndexBuffer = ResizeBuffer(s_IndexBuffer, s_Indices.GetCapacity() * sizeof(uint32_t), capacity * sizeof(uint32_t), GL_STATIC_DRAW);
+        glVertexArrayElementBuffer(s_VertexArray, s_IndexBuffer);
+        s_Indices.Grow(capacity);
+    }
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoffeeEngine/Core/DataStructures/RangeAllocator.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    struct Vertex;
+
+    /**
+     * @brief The vertices and indices of a mesh inside the geometry arena.
+     */
+    struct GeometryArenaAllocation
+    {
+        uint32_t baseVertex = 0; ///< The index of the first vertex in the arena vertex buffer.
+        uint32_t vertexCount = 0; ///< The number of vertices.
+        uint32_t firstIndex = 0; ///< The index of the first index in the arena index buffer.
+        uint32_t indexCount = 0; ///< The number of indices, relative to baseVertex.
+
+        bool IsValid() const { return indexCount > 0; }
+    };
+
+    /**
+     * @brief A draw of glMultiDrawElementsIndirect, laid out as GL reads it from the indirect buffer.
+     */
+    struct DrawElementsIndirectCommand
+    {
+        uint32_t count; ///< The number of indices.
+        uint32_t instanceCount; ///< The number of instances.
+        uint32_t firstIndex; ///< The first index in the index buffer.
+        int32_t baseVertex; ///< Added to every index.
+        uint32_t baseInstance; ///< The first instance, read by the shader through the base instance attribute.
+    };
+
+    /**
+     * @brief Shared vertex and index buffers holding the geometry of static meshes.
+     *
+     * Every mesh of the arena is drawn with the same vertex array, so the meshes of a material can be drawn by a single
+     * glMultiDrawElementsIndirect. The ranges are suballocated with a RangeAllocator and the buffers double when full.
+     *
+     * GL 4.5 has no gl_BaseInstance, so the vertex array also reads a base instance attribute at location 9 from a buffer
+     * holding 0, 1, 2... with a divisor no instance reaches. Vertex arrays without the attribute read 0.
+     */
+    class GeometryArena
+    {
+    public:
+        static constexpr uint32_t BaseInstanceLocation = 9; ///< The attribute location of the base instance in the standard shader.
+
+        /**
+         * @brief Creates the buffers and the vertex array of the arena.
+         */
+        static void Init();
+
+        /**
+         * @brief Destroys the buffers of the arena. Allocations freed afterwards are ignored.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Copies the geometry of a mesh into the arena.
+         * @param vertices The vertices.
+         * @param vertexCount The number of vertices.
+         * @param indices The indices, relative to the first vertex.
+         * @param indexCount The number of indices.
+         * @return The allocation, invalid if the arena is not initialized or the mesh is empty.
+         */
+        static GeometryArenaAllocation Allocate(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+        /**
+         * @brief Returns the ranges of an allocation to the arena.
+         */
+        static void Free(const GeometryArenaAllocation& allocation);
+
+        /**
+         * @brief Writes the draws of the frame into the next segment of the indirect buffer ring and binds it.
+         * @param commands The draws.
+         * @return The byte offset of the first draw in the indirect buffer.
+         */
+        static uint32_t UploadDrawCommands(const std::vector<DrawElementsIndirectCommand>& commands);
+
+        /**
+         * @brief Makes sure the base instance attribute covers the instances of the frame.
+         * @param instanceCount The number of instances.
+         */
+        static void ReserveInstances(uint32_t instanceCount);
+
+        /**
+         * @brief Binds the vertex array of the arena.
+         */
+        static void Bind();
+
+        static bool IsInitialized() { return s_VertexArray != 0; }
+        static uint32_t GetVertexCount() { return s_Vertices.GetUsed(); }
+        static uint32_t GetIndexCount() { return s_Indices.GetUsed(); }
+
+    private:
+        static void GrowVertices(uint32_t capacity);
+        static void GrowIndices(uint32_t capacity);
+
+    private:
+        static constexpr uint32_t DrawCommandFrames = 3; ///< Number of frames in flight of the indirect buffer ring.
+
+        static uint32_t s_VertexArray;
+        static uint32_t s_VertexBuffer;
+        static uint32_t s_IndexBuffer;
+        static uint32_t s_BaseInstanceBuffer;
+        static uint32_t s_BaseInstanceCapacity; ///< Number of values of the base instance buffer.
+        static uint32_t s_DrawCommandBuffer;
+        static uint32_t s_DrawCommandCapacity; ///< Number of draws of a segment of the indirect buffer.
+        static uint32_t s_DrawCommandSegment; ///< Segment written by the current frame.
+        static RangeAllocator s_Vertices;
+        static RangeAllocator s_Indices;
+    };
+
+    /** @} */
+}
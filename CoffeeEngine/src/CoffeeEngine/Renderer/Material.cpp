@@ -6,6 +6,7 @@
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "CoffeeEngine/Embedded/StandardShader.inl"
 #include <cstdint>
+#include <cstring>
 #include <glm/fwd.hpp>
 #include <tracy/Tracy.hpp>
 
@@ -35,11 +36,6 @@ namespace Coffee {
         m_MaterialTextureFlags.hasAlbedo = true;
 
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_MaterialTextures.albedo->Bind(0);
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->Unbind();
     }
 
     Material::Material(const std::string& name, Ref<Shader> shader) : m_Shader(shader), Resource(ResourceType::Material) {}
@@ -70,16 +66,8 @@ namespace Coffee {
         if(m_MaterialTextureFlags.hasMetallic)m_MaterialProperties.metallic = 1.0f;
         if(m_MaterialTextureFlags.hasEmissive)m_MaterialProperties.emissive = glm::vec3(1.0f);
 
+        // The samplers of the standard shader are bound to the texture units of Use in GLSL
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->setInt("material.normalMap", 1);
-        m_Shader->setInt("material.metallicMap", 2);
-        m_Shader->setInt("material.roughnessMap", 3);
-        m_Shader->setInt("material.aoMap", 4);
-        m_Shader->setInt("material.emissiveMap", 5);
-        m_Shader->Unbind();
     }
 
     void Material::Use()
@@ -104,20 +92,54 @@ namespace Coffee {
         if(m_MaterialTextureFlags.hasAO)m_MaterialTextures.ao->Bind(4);
         if(m_MaterialTextureFlags.hasEmissive)m_MaterialTextures.emissive->Bind(5);
 
+        if(!m_UniformBuffer && m_Shader->GetReflection().FindUniformBlock("MaterialData"))
+        {
+            m_UniformBuffer = UniformBuffer::Create(sizeof(MaterialUniformData), UniformBufferBinding);
+            m_UniformBufferValid = false;
+        }
+
+        if(m_UniformBuffer)
+        {
+            MaterialUniformData data;
+            data.color = m_MaterialProperties.color;
+            data.emissive = m_MaterialProperties.emissive;
+            data.metallic = m_MaterialProperties.metallic;
+            data.roughness = m_MaterialProperties.roughness;
+            data.ao = m_MaterialProperties.ao;
+            data.hasAlbedo = m_MaterialTextureFlags.hasAlbedo;
+            data.hasNormal = m_MaterialTextureFlags.hasNormal;
+            data.hasMetallic = m_MaterialTextureFlags.hasMetallic;
+            data.hasRoughness = m_MaterialTextureFlags.hasRoughness;
+            data.hasAO = m_MaterialTextureFlags.hasAO;
+            data.hasEmissive = m_MaterialTextureFlags.hasEmissive;
+
+            // The properties are edited in place through GetMaterialProperties, so a change is found by comparing with the last upload
+            if(!m_UniformBufferValid || std::memcmp(&data, &m_UploadedData, sizeof(MaterialUniformData)) != 0)
+            {
+                m_UniformBuffer->SetData(&data, sizeof(MaterialUniformData));
+                m_UploadedData = data;
+                m_UniformBufferValid = true;
+            }
+
+            m_UniformBuffer->Bind();
+            return;
+        }
+
         // Set Material Properties
-        m_Shader->setVec4("material.color", m_MaterialProperties.color);
-        m_Shader->setFloat("material.metallic", m_MaterialProperties.metallic);
-        m_Shader->setFloat("material.roughness", m_MaterialProperties.roughness);
-        m_Shader->setFloat("material.ao", m_MaterialProperties.ao);
-        m_Shader->setVec3("material.emissive", m_MaterialProperties.emissive);
+        const ShaderStandardUniforms& uniforms = m_Shader->GetStandardUniforms();
+        m_Shader->setUniform(uniforms.materialColor, m_MaterialProperties.color);
+        m_Shader->setUniform(uniforms.materialMetallic, m_MaterialProperties.metallic);
+        m_Shader->setUniform(uniforms.materialRoughness, m_MaterialProperties.roughness);
+        m_Shader->setUniform(uniforms.materialAO, m_MaterialProperties.ao);
+        m_Shader->setUniform(uniforms.materialEmissive, m_MaterialProperties.emissive);
 
         // Set Material Texture Flags
-        m_Shader->setInt("material.hasAlbedo", m_MaterialTextureFlags.hasAlbedo);
-        m_Shader->setInt("material.hasNormal", m_MaterialTextureFlags.hasNormal);
-        m_Shader->setInt("material.hasMetallic", m_MaterialTextureFlags.hasMetallic);
-        m_Shader->setInt("material.hasRoughness", m_MaterialTextureFlags.hasRoughness);
-        m_Shader->setInt("material.hasAO", m_MaterialTextureFlags.hasAO);
-        m_Shader->setInt("material.hasEmissive", m_MaterialTextureFlags.hasEmissive);
+        m_Shader->setUniform(uniforms.materialHasAlbedo, (int)m_MaterialTextureFlags.hasAlbedo);
+        m_Shader->setUniform(uniforms.materialHasNormal, (int)m_MaterialTextureFlags.hasNormal);
+        m_Shader->setUniform(uniforms.materialHasMetallic, (int)m_MaterialTextureFlags.hasMetallic);
+        m_Shader->setUniform(uniforms.materialHasRoughness, (int)m_MaterialTextureFlags.hasRoughness);
+        m_Shader->setUniform(uniforms.materialHasAO, (int)m_MaterialTextureFlags.hasAO);
+        m_Shader->setUniform(uniforms.materialHasEmissive, (int)m_MaterialTextureFlags.hasEmissive);
     }
 
     Ref<Material> Material::Create(const std::string& name, MaterialTextures* materialTextures)
@@ -4,6 +4,7 @@
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/UniformBuffer.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
 #include <cereal/types/polymorphic.hpp>
@@ -120,6 +121,26 @@ namespace Coffee {
             }
     };
 
+    /**
+     * @brief The properties and texture flags of a material, laid out like the std140 MaterialData block of the standard shader.
+     */
+    struct MaterialUniformData
+    {
+        glm::vec4 color = glm::vec4(0.0f);
+        glm::vec3 emissive = glm::vec3(0.0f);
+        float metallic = 0.0f;
+        float roughness = 0.0f;
+        float ao = 0.0f;
+
+        int32_t hasAlbedo = 0;
+        int32_t hasNormal = 0;
+        int32_t hasMetallic = 0;
+        int32_t hasRoughness = 0;
+        int32_t hasAO = 0;
+        int32_t hasEmissive = 0;
+    };
+    static_assert(sizeof(MaterialUniformData) == 64, "MaterialUniformData must match the std140 layout of MaterialData");
+
     /**
      * @brief Class representing a material.
      */
@@ -158,7 +179,10 @@ namespace Coffee {
         ~Material() = default;
 
         /**
-         * @brief Uses the material by binding its shader and textures.
+         * @brief Uses the material by binding its shader, textures and properties.
+         *
+         * With a shader declaring the MaterialData block the properties live in a uniform buffer of the material,
+         * uploaded only when they changed since the last use. Other shaders get them as plain uniforms.
          */
         void Use();
 
@@ -168,6 +192,11 @@ namespace Coffee {
          */
         Ref<Shader> GetShader() { return m_Shader; }
 
+        /**
+         * @brief Whether the material blends with what is behind it, which draws it after the opaque materials.
+         */
+        bool IsTransparent() const { return m_MaterialProperties.color.a < 1.0f; }
+
         MaterialTextures& GetMaterialTextures() { return m_MaterialTextures; }
         MaterialProperties& GetMaterialProperties() { return m_MaterialProperties; }
 
@@ -217,6 +246,10 @@ namespace Coffee {
         MaterialProperties m_MaterialProperties; ///< The properties of the material.
         MaterialRenderSettings m_MaterialRenderSettings; ///< The render settings of the material.
         Ref<Shader> m_Shader; ///< The shader used with the material.
+        Ref<UniformBuffer> m_UniformBuffer; ///< The MaterialData block of the material, created on first use.
+        MaterialUniformData m_UploadedData; ///< The contents of m_UniformBuffer.
+        bool m_UniformBufferValid = false; ///< Whether m_UploadedData was uploaded.
+        static constexpr uint32_t UniformBufferBinding = 3; ///< The binding point of the MaterialData block.
         static Ref<Texture2D> s_MissingTexture; ///< The texture to use when a texture is missing.
         static Ref<Shader> s_StandardShader; ///< The standard shader to use with the material. (When the material be a base class of PBRMaterial and ShaderMaterial this should be moved to PBRMaterial)
     };
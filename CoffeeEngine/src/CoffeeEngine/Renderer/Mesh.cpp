@@ -3,15 +3,21 @@
 #include "CoffeeEngine/Renderer/VertexArray.h"
 #include <tracy/Tracy.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
 namespace Coffee {
 
-    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin, const MorphTargetData& morphTargets)
         : Resource(ResourceType::Mesh)
     {
         ZoneScoped;
 
         m_Vertices = vertices;
         m_Indices = indices;
+        m_Skin = skin;
+        m_MorphTargets = morphTargets;
 
         m_VertexBuffer = VertexBuffer::Create((float*)m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
         m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), m_Indices.size());
@@ -21,15 +27,7 @@ namespace Coffee {
             {ShaderDataType::Vec2, "a_TexCoords"},
             {ShaderDataType::Vec3, "a_Normals"},
             {ShaderDataType::Vec3, "a_Tangent"},
-            {ShaderDataType::Vec3, "a_Bitangent"},
-            {ShaderDataType::Int, "a_BoneId"},
-            {ShaderDataType::Int, "a_BoneId"},
-            {ShaderDataType::Int, "a_BoneId"},
-            {ShaderDataType::Int, "a_BoneId"},
-            {ShaderDataType::Float, "a_BoneWeight"},
-            {ShaderDataType::Float, "a_BoneWeight"},
-            {ShaderDataType::Float, "a_BoneWeight"},
-            {ShaderDataType::Float, "a_BoneWeight"}
+            {ShaderDataType::Vec3, "a_Bitangent"}
         };
 
         m_VertexBuffer->SetLayout(layout);
@@ -37,6 +35,110 @@ namespace Coffee {
         m_VertexArray = VertexArray::Create();
         m_VertexArray->AddVertexBuffer(m_VertexBuffer);
         m_VertexArray->SetIndexBuffer(m_IndexBuffer);
+
+        // The influences follow the vertex attributes, at the locations the standard shader expects them
+        if (IsSkinned())
+        {
+            COFFEE_CORE_ASSERT(m_Skin.GetVertexCount() == m_Vertices.size(), "Mesh: the skin does not match the vertices!");
+
+            m_SkinBuffer = VertexBuffer::Create((float*)m_Skin.GetData().data(), m_Skin.GetData().size());
+            m_SkinBuffer->SetLayout(m_Skin.GetLayout());
+            m_VertexArray->AddVertexBuffer(m_SkinBuffer);
+        }
+
+        ComputeBoneBounds();
+    }
+
+    Mesh::~Mesh()
+    {
+        GeometryArena::Free(m_ArenaAllocation);
+    }
+
+    bool Mesh::AddToGeometryArena()
+    {
+        if (m_ArenaAllocation.IsValid())
+            return true;
+
+        if (!CanUseGeometryArena())
+            return false;
+
+        m_ArenaAllocation = GeometryArena::Allocate(m_Vertices.data(), static_cast<uint32_t>(m_Vertices.size()),
+                                                    m_Indices.data(), static_cast<uint32_t>(m_Indices.size()));
+        return m_ArenaAllocation.IsValid();
+    }
+
+    void Mesh::ComputeBoneBounds()
+    {
+        ZoneScoped;
+
+        m_BoneBounds.clear();
+
+        if (!IsSkinned())
+            return;
+
+        std::unordered_map<int, size_t> boundsIndices;
+        auto grow = [&](int boneID, const glm::vec3& position) {
+            auto [it, inserted] = boundsIndices.try_emplace(boneID, m_BoneBounds.size());
+            if (inserted)
+            {
+                m_BoneBounds.push_back({boneID, AABB(position, position)});
+                return;
+            }
+
+            AABB& aabb = m_BoneBounds[it->second].aabb;
+            aabb.min = glm::min(aabb.min, position);
+            aabb.max = glm::max(aabb.max, position);
+        };
+
+        bool skinned = false;
+        uint32_t boneIDs[VertexInfluences::kCapacity];
+        float weights[VertexInfluences::kCapacity];
+        for (uint32_t v = 0; v < m_Vertices.size(); v++)
+        {
+            const Vertex& vertex = m_Vertices[v];
+
+            bool influenced = false;
+            uint32_t count = m_Skin.Decode(v, boneIDs, weights);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (weights[i] <= 0.0f)
+                    continue;
+
+                grow(static_cast<int>(boneIDs[i]), vertex.Position);
+                influenced = true;
+            }
+
+            // Unweighted vertices are drawn in the bind pose, see the standard shader
+            if (!influenced)
+                grow(-1, vertex.Position);
+
+            skinned |= influenced;
+        }
+
+        if (!skinned)
+            m_BoneBounds.clear();
+
+        std::sort(m_BoneBounds.begin(), m_BoneBounds.end(), [](const BoneBounds& a, const BoneBounds& b) { return a.boneID < b.boneID; });
+    }
+
+    AABB Mesh::GetAnimatedAABB(const glm::mat4* boneMatrices, uint32_t boneCount) const
+    {
+        if (m_BoneBounds.empty() || !boneMatrices)
+            return m_AABB;
+
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        for (const BoneBounds& bounds : m_BoneBounds)
+        {
+            AABB animated = bounds.boneID >= 0 && static_cast<uint32_t>(bounds.boneID) < boneCount
+                ? bounds.aabb.CalculateTransformedAABB(boneMatrices[bounds.boneID])
+                : bounds.aabb;
+
+            min = glm::min(min, animated.min);
+            max = glm::max(max, animated.max);
+        }
+
+        return AABB(min, max);
     }
 
 }
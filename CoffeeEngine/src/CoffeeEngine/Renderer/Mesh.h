@@ -4,7 +4,10 @@
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/Renderer/Buffer.h"
+#include "CoffeeEngine/Renderer/GeometryArena.h"
 #include "CoffeeEngine/Renderer/Material.h"
+#include "CoffeeEngine/Renderer/MorphTargets.h"
+#include "CoffeeEngine/Renderer/SkinData.h"
 #include "CoffeeEngine/Renderer/VertexArray.h"
 #include "CoffeeEngine/Math/BoundingBox.h"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
@@ -29,6 +32,8 @@ namespace Coffee {
 
     /**
      * @brief Structure representing a vertex in a mesh.
+     *
+     * Bone influences live in the SkinData of the mesh, so static meshes do not pay for them.
      */
     struct Vertex {
         glm::vec3 Position = glm::vec3(0.0f); ///< The position of the vertex.
@@ -36,8 +41,6 @@ namespace Coffee {
         glm::vec3 Normals = glm::vec3(0.0f); ///< The normal vector of the vertex.
         glm::vec3 Tangent = glm::vec3(0.0f); ///< The tangent vector of the vertex.
         glm::vec3 Bitangent = glm::vec3(0.0f); ///< The bitangent vector of the vertex.
-        int m_BoneIDs[4] = {-1, -1, -1, -1};
-        float m_Weights[4]= {0.0, 0.0,0.0 ,0.0 };
 
         private:
             friend class cereal::access;
@@ -49,6 +52,15 @@ namespace Coffee {
             }
     };
 
+    /**
+     * @brief The bind pose bounds of the vertices influenced by one bone.
+     */
+    struct BoneBounds
+    {
+        int boneID; ///< The index in the bone palette, or -1 for the vertices without influences.
+        AABB aabb; ///< The bounds of the vertices in the space of the mesh.
+    };
+
     /**
      * @brief Class representing a mesh.
      */
@@ -59,8 +71,19 @@ namespace Coffee {
          * @brief Constructs a Mesh with the specified indices and vertices.
          * @param indices The indices of the mesh.
          * @param vertices The vertices of the mesh.
+         * @param skin The bone influences of the vertices, empty for static meshes.
+         * @param morphTargets The blend shapes of the mesh, empty if it has none.
          */
-        Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const SkinData& skin = {}, const MorphTargetData& morphTargets = {});
+
+        /**
+         * @brief Destroys the Mesh and returns its geometry arena ranges.
+         */
+        ~Mesh();
+
+        // A copy would return the same geometry arena ranges twice
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
 
         /**
          * @brief Gets the vertex array of the mesh.
@@ -80,6 +103,29 @@ namespace Coffee {
          */
         const Ref<IndexBuffer>& GetIndexBuffer() const { return m_IndexBuffer; }
 
+        /**
+         * @brief Gets the buffer of the bone influences, so morphed instances can draw them with their own vertices.
+         * @return A reference to the skin buffer, nullptr if the mesh is not skinned.
+         */
+        const Ref<VertexBuffer>& GetSkinBuffer() const { return m_SkinBuffer; }
+
+        /**
+         * @brief Whether the mesh can be drawn from the geometry arena. Skinned and morphed meshes need their own vertex arrays.
+         */
+        bool CanUseGeometryArena() const { return !IsSkinned() && !HasMorphTargets(); }
+
+        /**
+         * @brief Copies the vertices and indices into the geometry arena, once.
+         * @return True if the mesh is in the arena.
+         */
+        bool AddToGeometryArena();
+
+        /**
+         * @brief Gets the ranges of the mesh in the geometry arena.
+         * @return The allocation, invalid if the mesh is not in the arena.
+         */
+        const GeometryArenaAllocation& GetArenaAllocation() const { return m_ArenaAllocation; }
+
         /**
          * @brief Sets the material of the mesh.
          * @param material A reference to the material.
@@ -105,6 +151,24 @@ namespace Coffee {
          */
         OBB GetOBB(const glm::mat4& transform) { return {transform, GetAABB()}; }
 
+        /**
+         * @brief Gets the bounds of the mesh deformed by a bone palette.
+         *
+         * Skinned positions are weighted averages of the vertex moved by each of its bones, so they stay
+         * inside the union of the per-bone bounds moved by their bone. The cost scales with the bones, not the vertices.
+         *
+         * @param boneMatrices The bone palette.
+         * @param boneCount The number of matrices of the palette.
+         * @return The animated AABB in the space of the mesh, or the bind pose AABB if the mesh is not skinned.
+         */
+        AABB GetAnimatedAABB(const glm::mat4* boneMatrices, uint32_t boneCount) const;
+
+        /**
+         * @brief Gets the per-bone bounds of the mesh.
+         * @return The bounds, empty if the mesh is not skinned.
+         */
+        const std::vector<BoneBounds>& GetBoneBounds() const { return m_BoneBounds; }
+
         /**
          * @brief Gets the material of the mesh.
          * @return A reference to the material.
@@ -123,21 +187,64 @@ namespace Coffee {
          */
         const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
 
+        /**
+         * @brief Gets the bone influences of the vertices.
+         * @return The skin, empty if the mesh is not skinned.
+         */
+        const SkinData& GetSkin() const { return m_Skin; }
+
+        /**
+         * @brief Whether the vertices carry bone influences.
+         */
+        bool IsSkinned() const { return !m_Skin.IsEmpty(); }
+
+        /**
+         * @brief Gets the blend shapes of the mesh.
+         * @return The morph targets, empty if the mesh has none.
+         */
+        const MorphTargetData& GetMorphTargets() const { return m_MorphTargets; }
+
+        /**
+         * @brief Whether the mesh has blend shapes, drawn through a MorphedMesh.
+         */
+        bool HasMorphTargets() const { return !m_MorphTargets.IsEmpty(); }
+
+    private:
+        /**
+         * @brief Groups the vertices by the bones influencing them and computes their bounds.
+         */
+        void ComputeBoneBounds();
+
     private:
         friend class cereal::access;
 
+        // Written first, so caches of another layout are rejected instead of misread. The old layout started with the
+        // vertex count, the high bytes keep the two apart
+        static constexpr uint32_t s_CacheVersion = 0x4D455302; ///< "MES" and the layout revision, 2 since the SkinData.
+
+        template<class Archive>
+        static void CheckCacheVersion(Archive& archive)
+        {
+            uint32_t version = 0;
+            archive(version);
+            if(version != s_CacheVersion)
+                throw cereal::Exception("Mesh: the cache was written with another layout");
+        }
+
         template<class Archive>
         void save(Archive& archive) const
         {
             UUID materialUUID = m_Material->GetUUID();
-            archive(m_Vertices, m_Indices, m_AABB, materialUUID, cereal::base_class<Resource>(this));
+            archive(s_CacheVersion, m_Vertices, m_Indices, m_Skin, m_MorphTargets, m_AABB, materialUUID, cereal::base_class<Resource>(this));
         }
 
         template<class Archive>
         void load(Archive& archive)
         {
+            CheckCacheVersion(archive);
+
             UUID materialUUID;
-            archive(m_Vertices, m_Indices, m_AABB, materialUUID, cereal::base_class<Resource>(this));
+            archive(m_Vertices, m_Indices, m_Skin, m_MorphTargets, m_AABB, materialUUID, cereal::base_class<Resource>(this));
 
             m_Material = ResourceLoader::LoadMaterial(materialUUID);
         }
@@ -145,11 +252,15 @@ namespace Coffee {
         template<class Archive>
         static void load_and_construct(Archive& data, cereal::construct<Mesh>& construct)
         {
+            CheckCacheVersion(data);
+
             // Try to take this data as a reference
             std::vector<Vertex> vertices;
             std::vector<uint32_t> indices;
-            data(vertices, indices);
-            construct(vertices, indices);
+            SkinData skin;
+            MorphTargetData morphTargets;
+            data(vertices, indices, skin, morphTargets);
+            construct(vertices, indices, skin, morphTargets);
 
             UUID materialUUID;
 
@@ -161,13 +272,18 @@ namespace Coffee {
       private:
         Ref<VertexArray> m_VertexArray; ///< The vertex array of the mesh.
         Ref<VertexBuffer> m_VertexBuffer; ///< The vertex buffer of the mesh.
+        Ref<VertexBuffer> m_SkinBuffer; ///< The bone influences of the vertices, only created for skinned meshes.
         Ref<IndexBuffer> m_IndexBuffer; ///< The index buffer of the mesh.
+        GeometryArenaAllocation m_ArenaAllocation; ///< The ranges of the mesh in the geometry arena, drawn with the other static meshes.
 
         Ref<Material> m_Material; ///< The material of the mesh.
         AABB m_AABB; ///< The axis-aligned bounding box of the mesh.
+        std::vector<BoneBounds> m_BoneBounds; ///< The bounds of the vertices of every influencing bone.
 
         std::vector<uint32_t> m_Indices; ///< The indices of the mesh.
         std::vector<Vertex> m_Vertices; ///< The vertices of the mesh.
+        SkinData m_Skin; ///< The bone influences of the vertices.
+        MorphTargetData m_MorphTargets; ///< The blend shapes of the mesh.
     };
 
     /** @} */
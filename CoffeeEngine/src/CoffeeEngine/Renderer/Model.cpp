@@ -1,5 +1,6 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include "CoffeeEngine/Renderer/Model.h"
+#include "CoffeeEngine/Animation/AnimationLibrary.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Renderer/Material.h"
@@ -33,12 +34,13 @@ namespace Coffee {
         return glmMat;
     }
 
-    Model::Model(const std::filesystem::path& path)
+    Model::Model(const std::filesystem::path& path, const SkinImportSettings& skinSettings)
         : Resource(ResourceType::Model)
     {
         ZoneScoped;
 
         m_FilePath = path;
+        m_SkinSettings = skinSettings;
 
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(m_FilePath.string(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace | aiProcess_GenBoundingBoxes);
@@ -54,9 +56,9 @@ namespace Coffee {
         processNode(scene->mRootNode, scene);
     }
 
-    Ref<Model> Model::Load(const std::filesystem::path& path)
+    Ref<Model> Model::Load(const std::filesystem::path& path, const SkinImportSettings& skinSettings)
     {
-        return ResourceLoader::LoadModel(path, true);
+        return ResourceLoader::LoadModel(path, true, skinSettings);
     }
 
     Ref<Mesh> Model::processMesh(aiMesh* mesh, const aiScene* scene)
@@ -114,12 +116,6 @@ namespace Coffee {
                 vertex.TexCoords = glm::vec2(0.0f, 0.0f);
             }
             vertices.push_back(vertex);
-
-            for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
-            {
-                vertex.m_BoneIDs[j] = -1;
-                vertex.m_Weights[j] = 0.0f;
-            }
         }
         // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
 
@@ -130,7 +126,8 @@ namespace Coffee {
                 indices.push_back(face.mIndices[j]);
         }
 
-        ExtractBoneWeightForVertices(vertices,mesh,scene);
+        SkinData skin = ExtractBoneWeightForVertices(static_cast<uint32_t>(vertices.size()), mesh, scene);
+        MorphTargetData morphTargets = ExtractMorphTargets(mesh);
 
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
@@ -157,7 +154,7 @@ namespace Coffee {
             );
 
         std::string nameReference = m_FilePath.stem().string() + "_" + mesh->mName.C_Str();
-        Ref<Mesh> resultMesh = ResourceLoader::LoadMesh(nameReference, vertices, indices, meshMaterial, aabb);
+        Ref<Mesh> resultMesh = ResourceLoader::LoadMesh(nameReference, vertices, indices, skin, morphTargets, meshMaterial, aabb);
         //resultMesh->SetName(mesh->mName.C_Str());
         //TODO: When the UUID is implemented, the name of the mesh will be resultMesh->SetName(mesh->mName.C_Str());, are your sure?
         //resultMesh->SetName(nameReference);
@@ -167,8 +164,13 @@ namespace Coffee {
         return resultMesh;
     }
 
-    void Model::ExtractBoneWeightForVertices(std::vector<Vertex>& vertices, aiMesh* mesh, const aiScene* scene)
+    SkinData Model::ExtractBoneWeightForVertices(uint32_t vertexCount, aiMesh* mesh, const aiScene* scene)
     {
+        if (!mesh->HasBones())
+            return {};
+
+        std::vector<VertexInfluences> influences(vertexCount);
+
         for (int boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex)
         {
             int boneID = -1;
@@ -198,24 +200,58 @@ namespace Coffee {
             {
                 int vertexId = weights[weightIndex].mVertexId;
                 float weight = weights[weightIndex].mWeight;
-                SetVertexBoneData(vertices[vertexId], boneID, weight);
+                influences[vertexId].Add(boneID, weight);
             }
         }
+
+        // Keeps the strongest influences of each vertex, renormalized and quantized
+        return SkinData::Build(influences, m_SkinSettings);
     }
 
-    void Model::SetVertexBoneData(Vertex& vertex, int boneID, float weight)
+
+    MorphTargetData Model::ExtractMorphTargets(aiMesh* mesh)
     {
-        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        if (mesh->mNumAnimMeshes == 0)
+            return {};
+
+        ZoneScoped;
+
+        // Assimp stores the displaced vertices of every target, only their difference to the mesh is kept
+        std::vector<MorphTargetDeltas> targets(mesh->mNumAnimMeshes);
+        for (uint32_t t = 0; t < mesh->mNumAnimMeshes; t++)
         {
-            if (vertex.m_BoneIDs[i] < 0)
+            const aiAnimMesh* animMesh = mesh->mAnimMeshes[t];
+            MorphTargetDeltas& target = targets[t];
+            target.name = animMesh->mName.length > 0 ? animMesh->mName.C_Str() : "Target" + std::to_string(t);
+            target.defaultWeight = animMesh->mWeight;
+
+            if (!animMesh->HasPositions() || animMesh->mNumVertices != mesh->mNumVertices)
+                continue;
+
+            target.positions.resize(mesh->mNumVertices);
+            for (uint32_t v = 0; v < mesh->mNumVertices; v++)
             {
-                vertex.m_Weights[i] = weight;
-                vertex.m_BoneIDs[i] = boneID;
-                break;
+                const aiVector3D delta = animMesh->mVertices[v] - mesh->mVertices[v];
+                target.positions[v] = glm::vec3(delta.x, delta.y, delta.z);
+            }
+
+            if (animMesh->HasNormals() && mesh->HasNormals())
+            {
+                target.normals.resize(mesh->mNumVertices);
+                for (uint32_t v = 0; v < mesh->mNumVertices; v++)
+                {
+                    const aiVector3D delta = animMesh->mNormals[v] - mesh->mNormals[v];
+                    target.normals[v] = glm::vec3(delta.x, delta.y, delta.z);
+                }
             }
         }
-    }
 
+        // Clips animate the weights of the node the mesh hangs from
+        MorphTargetData morphTargets = MorphTargetData::Build(m_NodeName, targets);
+        COFFEE_CORE_INFO("Imported {0} morph targets of {1}: {2} KB of deltas for {3} vertices",
+                         morphTargets.GetTargetCount(), mesh->mName.C_Str(), morphTargets.GetMemorySize() / 1024.0f, mesh->mNumVertices);
+        return morphTargets;
+    }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
     void Model::processNode(aiNode* node, const aiScene* scene)
@@ -237,6 +273,7 @@ namespace Coffee {
             Ref<Model> child = CreateRef<Model>();
             child->m_Name = node->mChildren[i]->mName.C_Str();
             child->m_FilePath = m_FilePath;
+            child->m_SkinSettings = m_SkinSettings;
             child->m_Parent = weak_from_this();
             m_Children.push_back(child);
 
@@ -279,66 +316,30 @@ namespace Coffee {
         return matTextures;
     }
 
-    Ref<Animation> Model::LoadAnimation(const std::filesystem::path& animationPath)
+    Ref<Animation> Model::LoadAnimation(const std::filesystem::path& animationPath, const AnimationCompressionSettings& compression)
+    {
+        const Ref<AnimationLibrary>& library = LoadAnimationLibrary(animationPath, compression);
+        return library ? library->GetAnimation(size_t(0)) : nullptr;
+    }
+
+    Ref<AnimationLibrary> Model::LoadAnimationLibrary(const std::filesystem::path& animationPath, const AnimationCompressionSettings& compression, const AnimationBakeSettings& bake)
     {
         ZoneScoped;
 
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(animationPath.string(), aiProcess_Triangulate);
-    
-        if (!scene || !scene->mRootNode || scene->mNumAnimations == 0)
-        {
-            COFFEE_CORE_ERROR("ERROR::ASSIMP:: Failed to load animation: {0}", importer.GetErrorString());
+        Ref<AnimationLibrary> library = ResourceLoader::LoadAnimationLibrary(animationPath, m_BoneInfoMap, compression, bake);
+        if (!library)
             return nullptr;
-        }
-
-        Ref<Animation> animation = CreateRef<Animation>();
-        const aiAnimation* aiAnim = scene->mAnimations[0];
-    
-        // Set basic animation properties
-        animation->m_Duration = aiAnim->mDuration;
-        animation->m_TicksPerSecond = aiAnim->mTicksPerSecond;
-    
-        // Read node hierarchy
-        ReadNodeHierarchy(animation->m_RootNode, scene->mRootNode);
-    
-        // Read bones
-        ReadAnimationBones(aiAnim, animation->m_Bones, animation->m_BoneInfoMap);
-
-        return animation;
-    }
 
-    void Model::ReadAnimationBones(const aiAnimation* animation, std::vector<Bone>& bones, std::map<std::string, BoneInfo>& boneInfoMap)
-    {
-        for (uint32_t i = 0; i < animation->mNumChannels; i++)
+        // Keep the bones added by the clips so later libraries resolve to the same indices
+        for (const auto& [name, info] : library->GetBoneInfoMap())
         {
-            auto channel = animation->mChannels[i];
-            std::string boneName = channel->mNodeName.data;
-        
-            if (m_BoneInfoMap.find(boneName) == m_BoneInfoMap.end())
+            if (m_BoneInfoMap.emplace(name, info).second)
             {
-                m_BoneInfoMap[boneName].id = m_BoneCounter;
-                m_BoneCounter++;
+                m_BoneCounter = std::max(m_BoneCounter, info.id + 1);
             }
-        
-            bones.push_back(Bone(channel->mNodeName.data, m_BoneInfoMap[boneName].id, channel));
         }
-    
-        boneInfoMap = m_BoneInfoMap;
-    }
 
-    void Model::ReadNodeHierarchy(AssimpNodeData& dest, const aiNode* src)
-    {
-        dest.name = src->mName.data;
-        dest.transformation = aiMatrix4x4ToGLMMat4(src->mTransformation);
-        dest.childrenCount = src->mNumChildren;
-    
-        for (uint32_t i = 0; i < src->mNumChildren; i++)
-        {
-            AssimpNodeData newData;
-            ReadNodeHierarchy(newData, src->mChildren[i]);
-            dest.children.push_back(newData);
-        }
+        return library;
     }
 
 } // namespace Coffee
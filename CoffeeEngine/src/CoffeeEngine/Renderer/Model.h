@@ -12,16 +12,17 @@
 #include <cereal/access.hpp>
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
 #include <cereal/types/vector.hpp>
 #include <filesystem>
 #include <glm/fwd.hpp>
 #include <memory>
 #include <string>
 #include <vector>
+#include "CoffeeEngine/Animation/AnimationCompression.h"
+#include "CoffeeEngine/Animation/Bone.h"
 #include <CoffeeEngine/Animation/Animation.h>
 
-#define MAX_BONE_INFLUENCE 4
-
 namespace Coffee {
 
     /**
@@ -29,12 +30,16 @@ namespace Coffee {
      * @brief Renderer components of the CoffeeEngine.
      * @{
      */
-    struct BoneInfo
-    {
-        int id;
-        glm::mat4 offset;               
 
-    };
+    class AnimationLibrary;
+
+    /**
+     * @brief Converts an Assimp matrix to a glm matrix.
+     * @param aiMat The Assimp matrix (row-major).
+     * @return The glm matrix (column-major).
+     */
+    glm::mat4 aiMatrix4x4ToGLMMat4(const aiMatrix4x4& aiMat);
+
     /**
      * @brief Class representing a 3D model.
      */
@@ -51,8 +56,9 @@ namespace Coffee {
         /**
          * @brief Constructs a Model from a file path.
          * @param filePath The file path to the model.
+         * @param skinSettings How the bone weights of the skinned meshes are compacted.
          */
-        Model(const std::filesystem::path& path);
+        Model(const std::filesystem::path& path, const SkinImportSettings& skinSettings = {});
 
         /**
          * @brief Gets the meshes of the model.
@@ -90,8 +96,22 @@ namespace Coffee {
         * Loads a model from the specified file path.
         *
         * @param path The path to the model file.
+        * @param skinSettings How the bone weights of the skinned meshes are compacted.
         */
-        static Ref<Model> Load(const std::filesystem::path& path);
+        static Ref<Model> Load(const std::filesystem::path& path, const SkinImportSettings& skinSettings = {});
+
+        /**
+         * @brief Loads every animation clip of a file, resolving its bones against this model.
+         *
+         * The file is parsed once and the clips are cached, so later runs load them without Assimp.
+         * Bones that only exist in the clips are added to the bone info map of the model.
+         *
+         * @param animationPath Path to the animation file
+         * @param compression The compression applied to the keys of the clips
+         * @param bake Whether the clips are also baked into palette tables, for crowds played with a BakedAnimatorComponent
+         * @return The loaded animation library
+         */
+        Ref<AnimationLibrary> LoadAnimationLibrary(const std::filesystem::path& animationPath, const AnimationCompressionSettings& compression = {}, const AnimationBakeSettings& bake = {});
 
     private:
         /**
@@ -125,11 +145,12 @@ namespace Coffee {
         MaterialTextures LoadMaterialTextures(aiMaterial* material);
 
         /**
-         * @brief Loads an animation from file and associates it with this model.
+         * @brief Loads the first animation of a file and associates it with this model.
          * @param animationPath Path to the animation file
+         * @param compression The compression applied to the keys of the animation
          * @return The loaded animation
          */
-        Ref<Animation> LoadAnimation(const std::filesystem::path& animationPath);
+        Ref<Animation> LoadAnimation(const std::filesystem::path& animationPath, const AnimationCompressionSettings& compression = {});
 
         /**
          * @brief Gets the bone information map.
@@ -154,16 +175,20 @@ namespace Coffee {
             {
                 meshUUIDs.push_back(mesh->GetUUID());
             }
-            archive(meshUUIDs, m_Parent, m_Children, m_Transform, m_NodeName, cereal::base_class<Resource>(this));
+            archive(meshUUIDs, m_Parent, m_Children, m_Transform, m_NodeName, m_BoneInfoMap, m_BoneCounter, cereal::base_class<Resource>(this));
         }
         template<class Archive>
         void load(Archive& archive)
         {
             std::vector<UUID> meshUUIDs;
-            archive(meshUUIDs, m_Parent, m_Children, m_Transform, m_NodeName, cereal::base_class<Resource>(this));
+            archive(meshUUIDs, m_Parent, m_Children, m_Transform, m_NodeName, m_BoneInfoMap, m_BoneCounter, cereal::base_class<Resource>(this));
             for (const auto& meshUUID : meshUUIDs)
             {
-                m_Meshes.push_back(ResourceLoader::LoadMesh(meshUUID));
+                // A missing or outdated mesh rejects the whole cache, so the model is imported again
+                Ref<Mesh> mesh = ResourceLoader::LoadMesh(meshUUID);
+                if (!mesh)
+                    throw cereal::Exception("Model: a mesh of the cache could not be loaded");
+                m_Meshes.push_back(mesh);
             }
         }
 
@@ -182,11 +207,16 @@ namespace Coffee {
          std::map<std::string, BoneInfo> m_BoneInfoMap;
         int m_BoneCounter = 0;
 
-        void SetVertexBoneData(Vertex& vertex, int boneID, float weight);
-        void ExtractBoneWeightForVertices(std::vector<Vertex>& vertices, aiMesh* mesh, const aiScene* scene);
+        SkinImportSettings m_SkinSettings; ///< How the bone weights are compacted at import, not serialized but part of the UUID and so of the cache key.
+
+        SkinData ExtractBoneWeightForVertices(uint32_t vertexCount, aiMesh* mesh, const aiScene* scene);
 
-         void ReadAnimationBones(const aiAnimation* animation, std::vector<Bone>& bones, std::map<std::string, BoneInfo>& boneInfoMap);
-        void ReadNodeHierarchy(AssimpNodeData& dest, const aiNode* src);
+        /**
+         * @brief Reads the blend shapes of a mesh as sparse deltas.
+         * @param mesh The Assimp mesh.
+         * @return The morph targets, empty if the mesh has none.
+         */
+        MorphTargetData ExtractMorphTargets(aiMesh* mesh);
     };
 
 
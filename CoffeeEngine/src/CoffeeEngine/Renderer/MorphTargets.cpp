@@ -0,0 +1,230 @@
+#include "CoffeeEngine/Renderer/MorphTargets.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+    #define COFFEE_MORPH_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define COFFEE_MORPH_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace Coffee {
+
+    static constexpr uint32_t kRowCount = 6; ///< Position x, y, z and normal x, y, z.
+    static constexpr float kQuantizedMax = 32767.0f;
+
+    static float MaxComponent(const glm::vec3& v)
+    {
+        return std::max({std::abs(v.x), std::abs(v.y), std::abs(v.z)});
+    }
+
+    static int16_t Quantize(float value, float scale)
+    {
+        if (scale <= 0.0f)
+            return 0;
+        return static_cast<int16_t>(std::clamp(std::lround(value / scale), -32767l, 32767l));
+    }
+
+    MorphTargetData MorphTargetData::Build(const std::string& channelName, const std::vector<MorphTargetDeltas>& targets, float tolerance)
+    {
+        ZoneScoped;
+
+        MorphTargetData data;
+        data.m_ChannelName = channelName;
+
+        bool touched = false;
+        std::vector<uint32_t> vertices;
+        for (const MorphTargetDeltas& deltas : targets)
+        {
+            bool hasNormals = deltas.normals.size() == deltas.positions.size();
+
+            // Untouched vertices are the bulk of most blend shapes (a smile does not move the feet)
+            vertices.clear();
+            float positionMax = 0.0f, normalMax = 0.0f, maxDisplacement = 0.0f;
+            for (uint32_t v = 0; v < deltas.positions.size(); v++)
+            {
+                float positionOffset = MaxComponent(deltas.positions[v]);
+                float normalOffset = hasNormals ? MaxComponent(deltas.normals[v]) : 0.0f;
+                if (positionOffset <= tolerance && normalOffset <= tolerance)
+                    continue;
+
+                vertices.push_back(v);
+                positionMax = std::max(positionMax, positionOffset);
+                normalMax = std::max(normalMax, normalOffset);
+                maxDisplacement = std::max(maxDisplacement, glm::length(deltas.positions[v]));
+            }
+
+            Target target;
+            target.name = deltas.name;
+            target.defaultWeight = deltas.defaultWeight;
+            target.positionScale = positionMax / kQuantizedMax;
+            target.normalScale = normalMax / kQuantizedMax;
+            target.maxDisplacement = maxDisplacement;
+            target.firstBlock = static_cast<uint32_t>(data.m_Vertices.size() / kBlockSize);
+            target.blockCount = static_cast<uint32_t>((vertices.size() + kBlockSize - 1) / kBlockSize);
+            target.vertexCount = static_cast<uint32_t>(vertices.size());
+            touched |= !vertices.empty();
+
+            for (uint32_t block = 0; block < target.blockCount; block++)
+            {
+                int16_t rows[kRowCount][kBlockSize] = {};
+                for (uint32_t i = 0; i < kBlockSize; i++)
+                {
+                    // The padding repeats the last vertex with a zero offset, which leaves it as it is
+                    uint32_t entry = block * kBlockSize + i;
+                    if (entry >= vertices.size())
+                    {
+                        data.m_Vertices.push_back(vertices.back());
+                        continue;
+                    }
+
+                    uint32_t v = vertices[entry];
+                    data.m_Vertices.push_back(v);
+
+                    const glm::vec3& position = deltas.positions[v];
+                    glm::vec3 normal = hasNormals ? deltas.normals[v] : glm::vec3(0.0f);
+                    for (int c = 0; c < 3; c++)
+                    {
+                        rows[c][i] = Quantize(position[c], target.positionScale);
+                        rows[3 + c][i] = Quantize(normal[c], target.normalScale);
+                    }
+                }
+                data.m_Deltas.insert(data.m_Deltas.end(), &rows[0][0], &rows[0][0] + kRowCount * kBlockSize);
+            }
+
+            data.m_Targets.push_back(std::move(target));
+        }
+
+        if (!touched)
+            return {};
+
+        return data;
+    }
+
+    /**
+     * @brief Converts the quantized offsets of a block to weighted float offsets.
+     * @param rows The six rows of the block.
+     * @param positionFactor The weight of the target times its position scale.
+     * @param normalFactor The weight of the target times its normal scale.
+     * @param out The weighted offsets, one row per component.
+     */
+    static inline void DequantizeBlock(const int16_t* rows, float positionFactor, float normalFactor, float (*out)[MorphTargetData::kBlockSize])
+    {
+#if defined(COFFEE_MORPH_AVX2)
+        for (uint32_t row = 0; row < kRowCount; row++)
+        {
+            __m256 factor = _mm256_set1_ps(row < 3 ? positionFactor : normalFactor);
+            __m128i quantized = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + row * MorphTargetData::kBlockSize));
+            _mm256_storeu_ps(out[row], _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(quantized)), factor));
+        }
+#elif defined(COFFEE_MORPH_SSE2)
+        for (uint32_t row = 0; row < kRowCount; row++)
+        {
+            __m128 factor = _mm_set1_ps(row < 3 ? positionFactor : normalFactor);
+            __m128i quantized = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + row * MorphTargetData::kBlockSize));
+
+            // Sign extends the 16 bit offsets by unpacking them into the high half and shifting them back down
+            __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(quantized, quantized), 16);
+            __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(quantized, quantized), 16);
+            _mm_storeu_ps(out[row], _mm_mul_ps(_mm_cvtepi32_ps(low), factor));
+            _mm_storeu_ps(out[row] + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), factor));
+        }
+#else
+        for (uint32_t row = 0; row < kRowCount; row++)
+        {
+            float factor = row < 3 ? positionFactor : normalFactor;
+            for (uint32_t i = 0; i < MorphTargetData::kBlockSize; i++)
+                out[row][i] = static_cast<float>(rows[row * MorphTargetData::kBlockSize + i]) * factor;
+        }
+#endif
+    }
+
+    void MorphTargetData::Accumulate(const float* weights, float minWeight, Vertex* vertices) const
+    {
+        ZoneScoped;
+
+        alignas(32) float offsets[kRowCount][kBlockSize];
+
+        for (uint32_t t = 0; t < m_Targets.size(); t++)
+        {
+            if (!IsActive(weights[t], minWeight))
+                continue;
+
+            const Target& target = m_Targets[t];
+            float positionFactor = weights[t] * target.positionScale;
+            float normalFactor = weights[t] * target.normalScale;
+
+            for (uint32_t b = target.firstBlock; b < target.firstBlock + target.blockCount; b++)
+            {
+                DequantizeBlock(&m_Deltas[static_cast<size_t>(b) * kRowCount * kBlockSize], positionFactor, normalFactor, offsets);
+
+                // The vertices of a block are scattered over the mesh, so the offsets are added one vertex at a time
+                const uint32_t* indices = &m_Vertices[static_cast<size_t>(b) * kBlockSize];
+                for (uint32_t i = 0; i < kBlockSize; i++)
+                {
+                    Vertex& vertex = vertices[indices[i]];
+                    vertex.Position += glm::vec3(offsets[0][i], offsets[1][i], offsets[2][i]);
+                    vertex.Normals += glm::vec3(offsets[3][i], offsets[4][i], offsets[5][i]);
+                }
+            }
+        }
+    }
+
+    void MorphTargetData::AccumulateReference(const float* weights, float minWeight, Vertex* vertices) const
+    {
+        for (uint32_t t = 0; t < m_Targets.size(); t++)
+        {
+            if (!IsActive(weights[t], minWeight))
+                continue;
+
+            const Target& target = m_Targets[t];
+            for (uint32_t b = target.firstBlock; b < target.firstBlock + target.blockCount; b++)
+            {
+                const int16_t* rows = &m_Deltas[static_cast<size_t>(b) * kRowCount * kBlockSize];
+                for (uint32_t i = 0; i < kBlockSize; i++)
+                {
+                    Vertex& vertex = vertices[m_Vertices[static_cast<size_t>(b) * kBlockSize + i]];
+                    for (int c = 0; c < 3; c++)
+                    {
+                        vertex.Position[c] += weights[t] * (static_cast<float>(rows[c * kBlockSize + i]) * target.positionScale);
+                        vertex.Normals[c] += weights[t] * (static_cast<float>(rows[(3 + c) * kBlockSize + i]) * target.normalScale);
+                    }
+                }
+            }
+        }
+    }
+
+    float MorphTargetData::GetMaxDisplacement(const float* weights) const
+    {
+        float displacement = 0.0f;
+        for (uint32_t t = 0; t < m_Targets.size(); t++)
+            displacement += std::abs(weights[t]) * m_Targets[t].maxDisplacement;
+        return displacement;
+    }
+
+    int MorphTargetData::FindTarget(const std::string& name) const
+    {
+        for (uint32_t t = 0; t < m_Targets.size(); t++)
+        {
+            if (m_Targets[t].name == name)
+                return static_cast<int>(t);
+        }
+        return -1;
+    }
+
+    std::vector<float> MorphTargetData::GetDefaultWeights() const
+    {
+        std::vector<float> weights;
+        weights.reserve(m_Targets.size());
+        for (const Target& target : m_Targets)
+            weights.push_back(target.defaultWeight);
+        return weights;
+    }
+
+}
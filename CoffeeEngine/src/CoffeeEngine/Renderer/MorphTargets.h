@@ -0,0 +1,163 @@
+#pragma once
+
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+
+#include <cereal/access.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    struct Vertex;
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    /**
+     * @brief The displacement of every vertex of a mesh by one blend shape, gathered during import.
+     */
+    struct MorphTargetDeltas
+    {
+        std::string name; ///< The name of the target.
+        float defaultWeight = 0.0f; ///< The weight of the target when no clip animates it.
+        std::vector<glm::vec3> positions; ///< The position offset of every vertex.
+        std::vector<glm::vec3> normals; ///< The normal offset of every vertex, empty if the target does not change them.
+    };
+
+    /**
+     * @brief The blend shapes of a mesh, stored as sparse quantized deltas.
+     *
+     * Only the vertices a target moves are kept, so the memory and the cost of Accumulate scale with the
+     * touched vertices instead of the mesh. The deltas of a target are grouped in blocks of kBlockSize vertices:
+     * the vertex indices, then the x, y and z position offsets and the x, y and z normal offsets as 16 bit integers
+     * scaled by the largest offset of the target. Blocks are padded with zero offsets to the last vertex of the target.
+     */
+    class MorphTargetData
+    {
+    public:
+        static constexpr uint32_t kBlockSize = 8; ///< The vertices of a block, one AVX2 register of offsets.
+
+        /**
+         * @brief The metadata of one target, its deltas live in the shared blocks.
+         */
+        struct Target
+        {
+            std::string name; ///< The name of the target.
+            float defaultWeight = 0.0f; ///< The weight of the target when no clip animates it.
+            float positionScale = 0.0f; ///< The position offset of a quantized unit.
+            float normalScale = 0.0f; ///< The normal offset of a quantized unit.
+            float maxDisplacement = 0.0f; ///< The length of the largest position offset, to grow the bounds of the mesh.
+            uint32_t firstBlock = 0; ///< The first block of the target.
+            uint32_t blockCount = 0; ///< The blocks of the target.
+            uint32_t vertexCount = 0; ///< The vertices moved by the target.
+
+            template<class Archive>
+            void serialize(Archive& archive)
+            {
+                archive(name, defaultWeight, positionScale, normalScale, maxDisplacement, firstBlock, blockCount, vertexCount);
+            }
+        };
+
+        MorphTargetData() = default;
+
+        /**
+         * @brief Compacts the dense deltas of the targets of a mesh.
+         * @param channelName The name the morph channels of the clips animating the mesh are bound by.
+         * @param targets The deltas of every target, sized like the vertices of the mesh.
+         * @param tolerance The position and normal offsets at or below which a vertex is not touched by a target.
+         * @return The morph targets, empty if no target moves any vertex.
+         */
+        static MorphTargetData Build(const std::string& channelName, const std::vector<MorphTargetDeltas>& targets, float tolerance = 1.0e-5f);
+
+        /**
+         * @brief Adds the weighted deltas of every active target to the vertices of the mesh.
+         *
+         * Targets whose weight is at or below minWeight in magnitude are skipped. Uses AVX2 when the engine is
+         * built with COFFEE_ENABLE_AVX2, SSE2 on other x86-64 builds and AccumulateReference elsewhere.
+         *
+         * @param weights The weight of every target.
+         * @param minWeight The weight below which a target is skipped.
+         * @param vertices The vertices to displace, usually a copy of the vertices of the mesh.
+         */
+        void Accumulate(const float* weights, float minWeight, Vertex* vertices) const;
+
+        /**
+         * @brief Scalar implementation of Accumulate, used as the accuracy and performance reference.
+         */
+        void AccumulateReference(const float* weights, float minWeight, Vertex* vertices) const;
+
+        /**
+         * @brief Calls a function with every vertex the active targets touch, some of them more than once.
+         * @param weights The weight of every target.
+         * @param minWeight The weight below which a target is skipped.
+         * @param function Called with the index of the first vertex and the number of vertices of every block.
+         */
+        template<typename Function>
+        void ForEachTouchedBlock(const float* weights, float minWeight, Function&& function) const
+        {
+            for (uint32_t t = 0; t < m_Targets.size(); t++)
+            {
+                if (!IsActive(weights[t], minWeight))
+                    continue;
+
+                const Target& target = m_Targets[t];
+                for (uint32_t b = target.firstBlock; b < target.firstBlock + target.blockCount; b++)
+                    function(&m_Vertices[static_cast<size_t>(b) * kBlockSize], kBlockSize);
+            }
+        }
+
+        /**
+         * @brief Gets how far the active targets can move a vertex, to grow the bounds of the mesh.
+         * @param weights The weight of every target.
+         */
+        float GetMaxDisplacement(const float* weights) const;
+
+        /**
+         * @brief Finds a target by name.
+         * @return The index of the target, or -1 if there is no target with that name.
+         */
+        int FindTarget(const std::string& name) const;
+
+        /**
+         * @brief Gets the default weight of every target.
+         */
+        std::vector<float> GetDefaultWeights() const;
+
+        static bool IsActive(float weight, float minWeight) { return weight > minWeight || weight < -minWeight; }
+
+        bool IsEmpty() const { return m_Targets.empty(); }
+        uint32_t GetTargetCount() const { return static_cast<uint32_t>(m_Targets.size()); }
+        const Target& GetTarget(uint32_t target) const { return m_Targets[target]; }
+        const std::string& GetChannelName() const { return m_ChannelName; }
+
+        /**
+         * @brief Gets the memory used by the deltas of every target, in bytes.
+         */
+        size_t GetMemorySize() const { return m_Vertices.size() * sizeof(uint32_t) + m_Deltas.size() * sizeof(int16_t); }
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(m_ChannelName, m_Targets, m_Vertices, m_Deltas);
+        }
+
+    private:
+        std::string m_ChannelName; ///< See GetChannelName, the name of the node of the mesh.
+        std::vector<Target> m_Targets; ///< The targets, in the order of the weights of the clips.
+        std::vector<uint32_t> m_Vertices; ///< The vertex index of every entry of every block.
+        std::vector<int16_t> m_Deltas; ///< Six rows of kBlockSize quantized offsets per block.
+    };
+
+    /** @} */
+}
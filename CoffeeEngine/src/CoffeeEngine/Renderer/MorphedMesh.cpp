@@ -0,0 +1,79 @@
+#include "CoffeeEngine/Renderer/MorphedMesh.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Coffee {
+
+    MorphedMesh::MorphedMesh(const Ref<Mesh>& mesh)
+        : m_Mesh(mesh), m_Vertices(mesh->GetVertices())
+    {
+        ZoneScoped;
+
+        COFFEE_CORE_ASSERT(mesh->HasMorphTargets(), "MorphedMesh: the mesh has no morph targets!");
+
+        uint32_t size = static_cast<uint32_t>(m_Vertices.size() * sizeof(Vertex));
+        m_VertexBuffer = VertexBuffer::Create(size);
+        m_VertexBuffer->SetLayout(mesh->GetVertexBuffer()->GetLayout());
+
+        m_VertexArray = VertexArray::Create();
+        m_VertexArray->AddVertexBuffer(m_VertexBuffer);
+        if (mesh->IsSkinned())
+            m_VertexArray->AddVertexBuffer(mesh->GetSkinBuffer());
+        m_VertexArray->SetIndexBuffer(mesh->GetIndexBuffer());
+
+        // Uploaded in full once, later updates only upload the vertices they change
+        const MorphTargetData& morphTargets = mesh->GetMorphTargets();
+        m_Weights = morphTargets.GetDefaultWeights();
+        morphTargets.ForEachTouchedBlock(m_Weights.data(), m_MinWeight, [&](const uint32_t* vertices, uint32_t count) {
+            m_Touched.insert(m_Touched.end(), vertices, vertices + count);
+        });
+        morphTargets.Accumulate(m_Weights.data(), m_MinWeight, m_Vertices.data());
+        m_VertexBuffer->SetData(m_Vertices.data(), size);
+    }
+
+    void MorphedMesh::Update(const std::vector<float>& weights, float minWeight)
+    {
+        ZoneScoped;
+
+        const MorphTargetData& morphTargets = m_Mesh->GetMorphTargets();
+        m_UploadedVertexCount = 0;
+
+        if (weights.size() != morphTargets.GetTargetCount() || (weights == m_Weights && minWeight == m_MinWeight))
+            return;
+
+        const std::vector<Vertex>& bindVertices = m_Mesh->GetVertices();
+        uint32_t first = std::numeric_limits<uint32_t>::max();
+        uint32_t last = 0;
+
+        // The vertices of the previous weights go back to the bind pose, then the active targets displace theirs
+        for (uint32_t v : m_Touched)
+        {
+            m_Vertices[v].Position = bindVertices[v].Position;
+            m_Vertices[v].Normals = bindVertices[v].Normals;
+            first = std::min(first, v);
+            last = std::max(last, v);
+        }
+
+        m_Touched.clear();
+        morphTargets.ForEachTouchedBlock(weights.data(), minWeight, [&](const uint32_t* vertices, uint32_t count) {
+            m_Touched.insert(m_Touched.end(), vertices, vertices + count);
+            first = std::min(first, *std::min_element(vertices, vertices + count));
+            last = std::max(last, *std::max_element(vertices, vertices + count));
+        });
+        morphTargets.Accumulate(weights.data(), minWeight, m_Vertices.data());
+
+        m_Weights = weights;
+        m_MinWeight = minWeight;
+
+        if (first > last)
+            return;
+
+        // A blend shape usually moves one region of the mesh, whose vertices are close together in the buffer
+        m_UploadedVertexCount = last - first + 1;
+        m_VertexBuffer->SetData(&m_Vertices[first], m_UploadedVertexCount * sizeof(Vertex), first * sizeof(Vertex));
+    }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/Buffer.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/VertexArray.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    /**
+     * @brief The vertices of one instance of a mesh with blend shapes, displaced by the weights of the instance.
+     *
+     * The instance keeps a copy of the vertices in its own vertex buffer, drawn with the skin and indices of the mesh.
+     * An update only restores the vertices the previous weights touched, adds the deltas of the active targets
+     * and uploads the range of vertices that changed, so its cost scales with the touched vertices.
+     */
+    class MorphedMesh
+    {
+    public:
+        /**
+         * @brief Creates the buffers of an instance, displaced by the default weights of the targets.
+         * @param mesh The mesh, which must have morph targets.
+         */
+        MorphedMesh(const Ref<Mesh>& mesh);
+
+        /**
+         * @brief Displaces the vertices by a new set of weights. Nothing is done if the weights did not change.
+         * @param weights The weight of every target of the mesh.
+         * @param minWeight The weight below which a target is skipped.
+         */
+        void Update(const std::vector<float>& weights, float minWeight = 1.0e-3f);
+
+        const Ref<Mesh>& GetMesh() const { return m_Mesh; }
+
+        /**
+         * @brief Gets the vertex array drawing the displaced vertices, see RenderCommand::vertexArray.
+         */
+        const Ref<VertexArray>& GetVertexArray() const { return m_VertexArray; }
+
+        /**
+         * @brief Gets the weights of the last update.
+         */
+        const std::vector<float>& GetWeights() const { return m_Weights; }
+
+        /**
+         * @brief Gets how far the current weights can move a vertex, to grow the bounds of the mesh.
+         */
+        float GetMaxDisplacement() const { return m_Mesh->GetMorphTargets().GetMaxDisplacement(m_Weights.data()); }
+
+        /**
+         * @brief Gets the vertices uploaded by the last update.
+         */
+        uint32_t GetUploadedVertexCount() const { return m_UploadedVertexCount; }
+
+    private:
+        Ref<Mesh> m_Mesh;
+        std::vector<Vertex> m_Vertices; ///< The displaced copy of the vertices of the mesh.
+        std::vector<uint32_t> m_Touched; ///< The vertices displaced by the current weights, some of them more than once.
+        std::vector<float> m_Weights; ///< The weights of the last update.
+        float m_MinWeight = 0.0f; ///< The minimum weight of the last update.
+        uint32_t m_UploadedVertexCount = 0;
+
+        Ref<VertexBuffer> m_VertexBuffer; ///< The displaced vertices.
+        Ref<VertexArray> m_VertexArray; ///< The displaced vertices with the skin and indices of the mesh.
+    };
+
+    /** @} */
+}
@@ -0,0 +1,177 @@
+#include "CoffeeEngine/Renderer/RenderState.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Coffee {
+
+    uint32_t RenderState::s_Program = RenderState::UnknownBinding;
+    uint32_t RenderState::s_VertexArray = RenderState::UnknownBinding;
+    std::array<uint32_t, RenderState::MaxTextureUnits> RenderState::s_Textures = [] {
+        std::array<uint32_t, MaxTextureUnits> textures;
+        textures.fill(UnknownBinding);
+        return textures;
+    }();
+    std::array<uint32_t, RenderState::MaxUniformBufferBindings> RenderState::s_UniformBuffers = [] {
+        std::array<uint32_t, MaxUniformBufferBindings> buffers;
+        buffers.fill(UnknownBinding);
+        return buffers;
+    }();
+    std::unordered_map<uint32_t, std::vector<RenderState::UniformValue>> RenderState::s_Uniforms;
+    uint32_t RenderState::s_UniformProgram = RenderState::UnknownBinding;
+    std::vector<RenderState::UniformValue>* RenderState::s_UniformValues = nullptr;
+    RenderStateStats RenderState::s_Stats;
+
+    void RenderState::UseProgram(uint32_t program)
+    {
+        if(program == s_Program)
+        {
+            s_Stats.ElidedBinds++;
+            return;
+        }
+
+        glUseProgram(program);
+        s_Program = program;
+        s_Stats.IssuedBinds++;
+    }
+
+    void RenderState::BindTexture(uint32_t unit, uint32_t texture)
+    {
+        if(unit < MaxTextureUnits)
+        {
+            if(s_Textures[unit] == texture)
+            {
+                s_Stats.ElidedBinds++;
+                return;
+            }
+            s_Textures[unit] = texture;
+        }
+
+        glBindTextureUnit(unit, texture);
+        s_Stats.IssuedBinds++;
+    }
+
+    void RenderState::BindVertexArray(uint32_t vertexArray)
+    {
+        if(vertexArray == s_VertexArray)
+        {
+            s_Stats.ElidedBinds++;
+            return;
+        }
+
+        glBindVertexArray(vertexArray);
+        s_VertexArray = vertexArray;
+        s_Stats.IssuedBinds++;
+    }
+
+    void RenderState::BindUniformBuffer(uint32_t binding, uint32_t buffer)
+    {
+        if(binding < MaxUniformBufferBindings)
+        {
+            if(s_UniformBuffers[binding] == buffer)
+            {
+                s_Stats.ElidedBinds++;
+                return;
+            }
+            s_UniformBuffers[binding] = buffer;
+        }
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+        s_Stats.IssuedBinds++;
+    }
+
+    std::vector<RenderState::UniformValue>& RenderState::GetUniformValues(uint32_t program)
+    {
+        // Uniforms are set in runs on the bound program, so the last lookup is usually the right one
+        if(program != s_UniformProgram || s_UniformValues == nullptr)
+        {
+            s_UniformValues = &s_Uniforms[program];
+            s_UniformProgram = program;
+        }
+        return *s_UniformValues;
+    }
+
+    bool RenderState::ShouldUploadUniform(uint32_t program, int32_t location, const void* data, uint32_t size)
+    {
+        // GL ignores uploads to uniforms the linker removed
+        if(location < 0)
+        {
+            s_Stats.ElidedUniforms++;
+            return false;
+        }
+
+        if(size > MaxUniformSize)
+        {
+            ForgetUniforms(program, location, 1);
+            s_Stats.IssuedUniforms++;
+            return true;
+        }
+
+        std::vector<UniformValue>& values = GetUniformValues(program);
+        if(static_cast<size_t>(location) >= values.size())
+            values.resize(location + 1);
+
+        UniformValue& value = values[location];
+        if(value.size == size && std::memcmp(value.data.data(), data, size) == 0)
+        {
+            s_Stats.ElidedUniforms++;
+            return false;
+        }
+
+        value.size = size;
+        std::memcpy(value.data.data(), data, size);
+        s_Stats.IssuedUniforms++;
+        return true;
+    }
+
+    void RenderState::ForgetUniforms(uint32_t program, int32_t location, uint32_t count)
+    {
+        if(location < 0)
+            return;
+
+        std::vector<UniformValue>& values = GetUniformValues(program);
+        size_t end = std::min(values.size(), static_cast<size_t>(location) + count);
+        for(size_t i = location; i < end; i++)
+            values[i].size = 0;
+    }
+
+    void RenderState::Invalidate()
+    {
+        s_Program = UnknownBinding;
+        s_VertexArray = UnknownBinding;
+        s_Textures.fill(UnknownBinding);
+        s_UniformBuffers.fill(UnknownBinding);
+    }
+
+    void RenderState::OnProgramDeleted(uint32_t program)
+    {
+        if(s_Program == program)
+            s_Program = UnknownBinding;
+
+        if(s_UniformProgram == program)
+        {
+            s_UniformProgram = UnknownBinding;
+            s_UniformValues = nullptr;
+        }
+        s_Uniforms.erase(program);
+    }
+
+    void RenderState::OnTextureDeleted(uint32_t texture)
+    {
+        std::replace(s_Textures.begin(), s_Textures.end(), texture, UnknownBinding);
+    }
+
+    void RenderState::OnVertexArrayDeleted(uint32_t vertexArray)
+    {
+        if(s_VertexArray == vertexArray)
+            s_VertexArray = UnknownBinding;
+    }
+
+    void RenderState::OnUniformBufferDeleted(uint32_t buffer)
+    {
+        std::replace(s_UniformBuffers.begin(), s_UniformBuffers.end(), buffer, UnknownBinding);
+    }
+
+}
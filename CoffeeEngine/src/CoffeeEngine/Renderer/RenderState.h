@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    /**
+     * @brief Counts of the GL calls that went through the state cache since the last reset.
+     */
+    struct RenderStateStats
+    {
+        uint32_t IssuedBinds = 0; ///< Program, texture, vertex array and uniform buffer binds sent to the driver.
+        uint32_t ElidedBinds = 0; ///< Binds skipped because the object was already bound.
+        uint32_t IssuedUniforms = 0; ///< Uniform uploads sent to the driver.
+        uint32_t ElidedUniforms = 0; ///< Uniform uploads skipped because the program already had the value.
+    };
+
+    /**
+     * @brief Remembers the GL state set by the renderer and skips the calls that would not change it.
+     *
+     * Shader, Texture2D, VertexArray and UniformBuffer bind through this class, and the uniform setters of Shader ask it whether
+     * a value differs from the last one written to that location of that program. Code changing the bindings
+     * behind its back (ImGui, raw GL calls) must call Invalidate before the renderer draws again.
+     */
+    class RenderState
+    {
+    public:
+        /**
+         * @brief Binds a program unless it is already in use.
+         * @param program The program, 0 to unbind.
+         */
+        static void UseProgram(uint32_t program);
+
+        /**
+         * @brief Binds a texture to a texture unit unless it is already bound there.
+         * @param unit The texture unit.
+         * @param texture The texture, 0 to unbind.
+         */
+        static void BindTexture(uint32_t unit, uint32_t texture);
+
+        /**
+         * @brief Binds a vertex array unless it is already bound.
+         * @param vertexArray The vertex array, 0 to unbind.
+         */
+        static void BindVertexArray(uint32_t vertexArray);
+
+        /**
+         * @brief Binds a uniform buffer to a binding point unless it is already bound there.
+         * @param binding The uniform buffer binding point.
+         * @param buffer The buffer.
+         */
+        static void BindUniformBuffer(uint32_t binding, uint32_t buffer);
+
+        /**
+         * @brief Checks whether a uniform value must be uploaded, and remembers it if so.
+         * @param program The program owning the uniform.
+         * @param location The location of the uniform, uploads to -1 are always skipped.
+         * @param data The value.
+         * @param size The size of the value, values larger than a mat4 are never cached.
+         * @return True if the caller has to upload the value.
+         */
+        static bool ShouldUploadUniform(uint32_t program, int32_t location, const void* data, uint32_t size);
+
+        /**
+         * @brief Forgets the values of a range of uniform locations, after an upload the cache did not see.
+         * @param program The program owning the uniforms.
+         * @param location The first location.
+         * @param count The number of locations.
+         */
+        static void ForgetUniforms(uint32_t program, int32_t location, uint32_t count);
+
+        /**
+         * @brief Forgets every binding, for when other code may have changed them. Uniform values are kept, they belong to their programs.
+         */
+        static void Invalidate();
+
+        /**
+         * @brief Forgets a program, whose name the driver can give to a new one.
+         */
+        static void OnProgramDeleted(uint32_t program);
+
+        /**
+         * @brief Forgets a texture in every unit it is bound to, whose name the driver can give to a new one.
+         */
+        static void OnTextureDeleted(uint32_t texture);
+
+        /**
+         * @brief Forgets a vertex array, whose name the driver can give to a new one.
+         */
+        static void OnVertexArrayDeleted(uint32_t vertexArray);
+
+        /**
+         * @brief Forgets a uniform buffer at every binding point it is bound to, whose name the driver can give to a new one.
+         */
+        static void OnUniformBufferDeleted(uint32_t buffer);
+
+        static const RenderStateStats& GetStats() { return s_Stats; }
+        static void ResetStats() { s_Stats = {}; }
+
+    private:
+        static constexpr uint32_t MaxTextureUnits = 32; ///< Units tracked, binds to higher units are always issued.
+        static constexpr uint32_t MaxUniformBufferBindings = 16; ///< Binding points tracked, binds to higher points are always issued.
+        static constexpr uint32_t MaxUniformSize = 64; ///< The size of a mat4, the largest cached value.
+        static constexpr uint32_t UnknownBinding = 0xFFFFFFFF; ///< A binding the cache does not know.
+
+        /**
+         * @brief The last value written to a uniform location.
+         */
+        struct UniformValue
+        {
+            uint32_t size = 0; ///< The size of the value, 0 if unknown.
+            std::array<uint8_t, MaxUniformSize> data;
+        };
+
+        static std::vector<UniformValue>& GetUniformValues(uint32_t program);
+
+    private:
+        static uint32_t s_Program;
+        static uint32_t s_VertexArray;
+        static std::array<uint32_t, MaxTextureUnits> s_Textures;
+        static std::array<uint32_t, MaxUniformBufferBindings> s_UniformBuffers;
+        static std::unordered_map<uint32_t, std::vector<UniformValue>> s_Uniforms; ///< The uniform values of every program, indexed by location.
+        static uint32_t s_UniformProgram; ///< The program of the last uniform lookup.
+        static std::vector<UniformValue>* s_UniformValues; ///< The values of s_UniformProgram.
+        static RenderStateStats s_Stats;
+    };
+
+    /** @} */
+}
@@ -1,12 +1,17 @@
 #include "Renderer.h"
+#include "CoffeeEngine/Core/DataStructures/RadixSort.h"
+#include "CoffeeEngine/Core/Stopwatch.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
 #include "CoffeeEngine/Renderer/DebugRenderer.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
 #include "CoffeeEngine/Renderer/Framebuffer.h"
+#include "CoffeeEngine/Renderer/GeometryArena.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/RendererAPI.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 #include "CoffeeEngine/Renderer/Shader.h"
+#include "CoffeeEngine/Renderer/ShaderStorageBuffer.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "CoffeeEngine/Renderer/UniformBuffer.h"
 
@@ -14,6 +19,8 @@
 #include "CoffeeEngine/Embedded/FinalPassShader.inl"
 #include "CoffeeEngine/Embedded/MissingShader.inl"
 
+#include <algorithm>
+#include <bit>
 #include <cstdint>
 #include <glm/fwd.hpp>
 #include <glm/matrix.hpp>
@@ -21,6 +28,29 @@
 
 namespace Coffee {
 
+    // Widths of the fields of a render sort key, from the most significant bits
+    static constexpr int s_SortPassBits = 2;
+    static constexpr int s_SortShaderBits = 10;
+    static constexpr int s_SortMaterialBits = 14;
+    static constexpr int s_SortMeshBits = 14;
+    static constexpr int s_SortDepthBits = 24;
+    static_assert(s_SortPassBits + s_SortShaderBits + s_SortMaterialBits + s_SortMeshBits + s_SortDepthBits == 64);
+
+    enum class RenderPass : uint64_t
+    {
+        Opaque = 0,
+        Transparent = 1
+    };
+
+    // Writes the entity ID into the entity ID texture as a color, read back by the editor to pick entities
+    static glm::vec3 EntityIDToColor(uint32_t entityID)
+    {
+        uint32_t r = (entityID & 0x000000FF) >> 0;
+        uint32_t g = (entityID & 0x0000FF00) >> 8;
+        uint32_t b = (entityID & 0x00FF0000) >> 16;
+        return glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f);
+    }
+
     static bool s_viewportResized = false;
     static uint32_t s_viewportWidth = 0, s_viewportHeight = 0;
 
@@ -70,6 +100,11 @@ namespace Coffee {
         s_RendererData.CameraUniformBuffer = UniformBuffer::Create(sizeof(RendererData::CameraData), 0);
         s_RendererData.RenderDataUniformBuffer = UniformBuffer::Create(sizeof(RendererData::RenderData), 1);
 
+        s_RendererData.BonePaletteBuffer = ShaderStorageRingBuffer::Create(sizeof(glm::mat4), 1024, 2);
+        s_RendererData.InstanceBuffer = ShaderStorageRingBuffer::Create(sizeof(InstanceData), 1024, 4);
+
+        GeometryArena::Init();
+
         Ref<Shader> missingShader = CreateRef<Shader>("MissingShader", std::string(missingShaderSource));
         s_RendererData.DefaultMaterial = CreateRef<Material>("Missing Material", missingShader); //TODO: Port it to use the Material::Create
 
@@ -90,6 +125,7 @@ namespace Coffee {
 
     void Renderer::Shutdown()
     {
+        GeometryArena::Shutdown();
     }
 
     void Renderer::BeginScene(EditorCamera& camera)
@@ -97,6 +133,17 @@ namespace Coffee {
         s_Stats.DrawCalls = 0;
         s_Stats.VertexCount = 0;
         s_Stats.IndexCount = 0;
+        s_Stats.BoneMatrixCount = 0;
+        s_Stats.InstanceCount = 0;
+        s_Stats.IndirectDrawCount = 0;
+        s_Stats.ShaderChanges = 0;
+        s_Stats.MaterialChanges = 0;
+        s_Stats.MeshChanges = 0;
+        s_Stats.SortTime = 0.0f;
+
+        // The editor UI binds its own programs, textures and vertex arrays between frames
+        RenderState::Invalidate();
+        RenderState::ResetStats();
 
         //I think if a render queue is implemented this is not necessary. The OnResize would work.
         if(s_viewportResized)
@@ -118,6 +165,17 @@ namespace Coffee {
         s_Stats.DrawCalls = 0;
         s_Stats.VertexCount = 0;
         s_Stats.IndexCount = 0;
+        s_Stats.BoneMatrixCount = 0;
+        s_Stats.InstanceCount = 0;
+        s_Stats.IndirectDrawCount = 0;
+        s_Stats.ShaderChanges = 0;
+        s_Stats.MaterialChanges = 0;
+        s_Stats.MeshChanges = 0;
+        s_Stats.SortTime = 0.0f;
+
+        // The editor UI binds its own programs, textures and vertex arrays between frames
+        RenderState::Invalidate();
+        RenderState::ResetStats();
 
         // This resize the camera to the viewport size. Think how to manage this in a better way :p
         camera.SetViewportSize(s_viewportWidth, s_viewportHeight);
@@ -143,42 +201,122 @@ namespace Coffee {
 
         s_RendererData.RenderDataUniformBuffer->SetData(&s_RendererData.renderData, sizeof(RendererData::RenderData));
 
+        UploadBonePalettes();
+
         // Sort the render queue to minimize state changes
+        SortRenderQueue();
+
+        BuildRenderBatches();
+
+        if(s_RenderSettings.MultiDrawIndirect)
+            BuildMultiDrawCommands();
+
+        const std::vector<RenderCommand>& queue = s_RendererData.renderQueue;
+        const std::vector<RenderSortKey>& sortKeys = s_RendererData.sortKeys;
+        const std::vector<RenderBatch>& batches = s_RendererData.renderBatches;
+
+        const Material* boundMaterial = nullptr;
+        const Shader* boundShader = nullptr;
+        const VertexArray* boundVertexArray = nullptr;
+        uint32_t nextDrawCommand = 0;
 
-        for(const auto& command : s_RendererData.renderQueue)
+        for(size_t b = 0; b < batches.size(); b++)
         {
-            Material* material = command.material.get();
+            // The commands of a batch only differ by their transform and entity, which are in the instance buffer
+            const RenderBatch& batch = batches[b];
+            const RenderCommand& command = queue[sortKeys[batch.firstKey].command];
+            Material* material = GetCommandMaterial(command);
 
-            if(material == nullptr)
+            // Consecutive draws of a material keep its shader, textures and uniforms bound
+            const Ref<Shader>& shader = material->GetShader();
+            if(material != boundMaterial)
             {
-                material = s_RendererData.DefaultMaterial.get();
+                material->Use();
+                boundMaterial = material;
+                s_Stats.MaterialChanges++;
+
+                if(shader.get() != boundShader)
+                {
+                    boundShader = shader.get();
+                    s_Stats.ShaderChanges++;
+                }
             }
-            
-            material->Use();
-
-            const Ref<Shader>& shader = material->GetShader();
 
-            shader->Bind();
-            shader->setMat4("model", command.transform);
-            shader->setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(command.transform))));
+            const ShaderStandardUniforms& uniforms = shader->GetStandardUniforms();
 
             //REMOVE: This is for the first release of the engine it should be handled differently
-            shader->setBool("showNormals", s_RenderSettings.showNormals);
+            shader->setUniform(uniforms.showNormals, s_RenderSettings.showNormals);
 
-            // Convert entityID to vec3
-            uint32_t r = (command.entityID & 0x000000FF) >> 0;
-            uint32_t g = (command.entityID & 0x0000FF00) >> 8;
-            uint32_t b = (command.entityID & 0x00FF0000) >> 16;
-            glm::vec3 entityIDVec3 = glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f);
+            shader->setUniform(uniforms.boneOffset, command.boneOffset);
 
-            shader->setVec3("entityID", entityIDVec3);
+            if(batch.multiDraw)
+            {
+                // The following batches of the material drawn from the geometry arena go in the same call, each draw gets its first instance as base instance
+                size_t end = b + 1;
+                while(end < batches.size() && batches[end].multiDraw && GetCommandMaterial(queue[sortKeys[batches[end].firstKey].command]) == material)
+                    end++;
+
+                uint32_t drawCount = static_cast<uint32_t>(end - b);
+                shader->setUniform(uniforms.instanceOffset, 0);
+                GeometryArena::Bind();
+                RendererAPI::MultiDrawIndexedIndirect(s_RendererData.drawCommandOffset + nextDrawCommand * sizeof(DrawElementsIndirectCommand), drawCount);
+
+                for(size_t i = b; i < end; i++)
+                {
+                    const GeometryArenaAllocation& allocation = queue[sortKeys[batches[i].firstKey].command].mesh->GetArenaAllocation();
+                    s_Stats.VertexCount += allocation.vertexCount * batches[i].count;
+                    s_Stats.IndexCount += allocation.indexCount * batches[i].count;
+                    s_Stats.InstanceCount += batches[i].count > 1 ? batches[i].count : 0;
+                }
+
+                s_Stats.DrawCalls++;
+                s_Stats.IndirectDrawCount += drawCount;
+                s_Stats.MeshChanges++;
+                boundVertexArray = nullptr;
+                nextDrawCommand += drawCount;
+                b = end - 1;
+                continue;
+            }
 
-            RendererAPI::DrawIndexed(command.mesh->GetVertexArray());
+            if(batch.instanceOffset >= 0)
+            {
+                shader->setUniform(uniforms.instanceOffset, batch.instanceOffset);
+            }
+            else
+            {
+                shader->setUniform(uniforms.model, command.transform);
+                shader->setUniform(uniforms.normalMatrix, glm::transpose(glm::inverse(glm::mat3(command.transform))));
+                shader->setUniform(uniforms.entityID, EntityIDToColor(command.entityID));
+            }
+
+            if(command.boneOffset >= 0)
+            {
+                shader->setUniform(uniforms.boneInfluences, static_cast<int>(command.mesh->GetSkin().GetInfluenceCount()));
+                shader->setUniform(uniforms.nextBoneOffset, command.nextBoneOffset);
+                shader->setUniform(uniforms.boneLerp, command.boneLerp);
+            }
+
+            const Ref<VertexArray>& vertexArray = command.vertexArray ? command.vertexArray : command.mesh->GetVertexArray();
+            if(vertexArray.get() != boundVertexArray)
+            {
+                boundVertexArray = vertexArray.get();
+                s_Stats.MeshChanges++;
+            }
+
+            if(batch.count > 1)
+            {
+                RendererAPI::DrawIndexedInstanced(vertexArray, batch.count);
+                s_Stats.InstanceCount += batch.count;
+            }
+            else
+            {
+                RendererAPI::DrawIndexed(vertexArray);
+            }
 
             s_Stats.DrawCalls++;
 
-            s_Stats.VertexCount += command.mesh->GetVertices().size();
-            s_Stats.IndexCount += command.mesh->GetIndices().size();
+            s_Stats.VertexCount += command.mesh->GetVertices().size() * batch.count;
+            s_Stats.IndexCount += command.mesh->GetIndices().size() * batch.count;
         }
 
         // Test drawing the skybox
@@ -229,6 +367,8 @@ namespace Coffee {
         s_MainFramebuffer->UnBind();
 
         s_RendererData.renderQueue.clear();
+        s_RendererData.sortKeys.clear();
+        s_RendererData.renderBatches.clear();
     }
 
     //TEMPORAL
@@ -268,13 +408,7 @@ namespace Coffee {
         //REMOVE: This is for the first release of the engine it should be handled differently
         shader->setBool("showNormals", s_RenderSettings.showNormals);
 
-        // Convert entityID to vec3
-        uint32_t r = (entityID & 0x000000FF) >> 0;
-        uint32_t g = (entityID & 0x0000FF00) >> 8;
-        uint32_t b = (entityID & 0x00FF0000) >> 16;
-        glm::vec3 entityIDVec3 = glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f);
-
-        shader->setVec3("entityID", entityIDVec3);
+        shader->setVec3("entityID", EntityIDToColor(entityID));
 
         RendererAPI::DrawIndexed(vertexArray);
 
@@ -294,4 +428,211 @@ namespace Coffee {
         s_MainFramebuffer->Resize(s_viewportWidth, s_viewportHeight);
         s_PostProcessingFramebuffer->Resize(s_viewportWidth, s_viewportHeight);
     }
-}
\ No newline at end of file
+
+    void Renderer::UploadBonePalettes()
+    {
+        ZoneScoped;
+
+        std::vector<glm::mat4>& palettes = s_RendererData.bonePalettes;
+        std::unordered_map<const glm::mat4*, int32_t>& offsets = s_RendererData.bonePaletteOffsets;
+        palettes.clear();
+        offsets.clear();
+
+        // Instances sharing a palette (see AnimationPoseCache and BakedAnimation) point to the same matrices, which are uploaded once
+        auto findOffset = [&](const glm::mat4* matrices, uint32_t count) {
+            auto [it, inserted] = offsets.try_emplace(matrices, static_cast<int32_t>(palettes.size()));
+            if(inserted)
+            {
+                palettes.insert(palettes.end(), matrices, matrices + count);
+            }
+            return it->second;
+        };
+
+        for(auto& command : s_RendererData.renderQueue)
+        {
+            // A static mesh under an animated entity has no skin attributes to read the palette with
+            if(!command.boneMatrices || !command.mesh->IsSkinned())
+            {
+                command.boneOffset = -1;
+                command.nextBoneOffset = -1;
+                continue;
+            }
+
+            command.boneOffset = findOffset(command.boneMatrices, command.boneCount);
+            command.nextBoneOffset = command.nextBoneMatrices ? findOffset(command.nextBoneMatrices, command.boneCount) : -1;
+        }
+
+        if(palettes.empty())
+            return;
+
+        uint32_t matrixCount = static_cast<uint32_t>(palettes.size());
+        s_RendererData.BonePaletteBuffer->Upload(palettes.data(), matrixCount);
+
+        s_Stats.BoneMatrixCount += matrixCount;
+    }
+
+    // Positive floats order like their bit patterns, so the top bits of the pattern are a logarithmic depth quantization
+    static uint64_t QuantizeSortDepth(float depth)
+    {
+        uint32_t bits = std::bit_cast<uint32_t>(std::max(depth, 0.0f));
+        return bits >> (32 - s_SortDepthBits);
+    }
+
+    void Renderer::SortRenderQueue()
+    {
+        ZoneScoped;
+
+        Stopwatch stopwatch;
+        stopwatch.Start();
+
+        std::vector<RenderCommand>& queue = s_RendererData.renderQueue;
+        std::vector<RenderSortKey>& sortKeys = s_RendererData.sortKeys;
+        std::unordered_map<const void*, uint32_t>& ids = s_RendererData.sortIDs;
+        sortKeys.clear();
+        ids.clear();
+
+        // Dense ids in order of first submission fit the fields of the key, saturating only past their capacity
+        uint32_t nextShader = 0, nextMaterial = 0, nextMesh = 0;
+        auto findID = [&](const void* object, uint32_t& next, int bits) {
+            auto [it, inserted] = ids.try_emplace(object, next);
+            if(inserted)
+            {
+                next++;
+            }
+            return static_cast<uint64_t>(std::min(it->second, (1u << bits) - 1));
+        };
+
+        const glm::mat4& view = s_RendererData.cameraData.view;
+        constexpr uint64_t depthMask = (1ull << s_SortDepthBits) - 1;
+
+        for(uint32_t i = 0; i < queue.size(); i++)
+        {
+            const RenderCommand& command = queue[i];
+            Material* material = command.material ? command.material.get() : s_RendererData.DefaultMaterial.get();
+            const VertexArray* vertexArray = command.vertexArray ? command.vertexArray.get() : command.mesh->GetVertexArray().get();
+
+            uint64_t shader = findID(material->GetShader().get(), nextShader, s_SortShaderBits);
+            uint64_t materialID = findID(material, nextMaterial, s_SortMaterialBits);
+            uint64_t mesh = findID(vertexArray, nextMesh, s_SortMeshBits);
+            uint64_t depth = QuantizeSortDepth(-(view * command.transform[3]).z);
+
+            uint64_t key;
+            if(material->IsTransparent())
+            {
+                // Back to front: the farthest draw gets the smallest depth field
+                key = static_cast<uint64_t>(RenderPass::Transparent) << (64 - s_SortPassBits);
+                key |= (depthMask - depth) << (s_SortShaderBits + s_SortMaterialBits + s_SortMeshBits);
+                key |= shader << (s_SortMaterialBits + s_SortMeshBits);
+                key |= materialID << s_SortMeshBits;
+                key |= mesh;
+            }
+            else
+            {
+                // Front to back within a state, so early depth testing rejects the hidden fragments
+                key = static_cast<uint64_t>(RenderPass::Opaque) << (64 - s_SortPassBits);
+                key |= shader << (s_SortMaterialBits + s_SortMeshBits + s_SortDepthBits);
+                key |= materialID << (s_SortMeshBits + s_SortDepthBits);
+                key |= mesh << s_SortDepthBits;
+                key |= depth;
+            }
+
+            sortKeys.push_back({ key, i });
+        }
+
+        RadixSort(sortKeys, s_RendererData.sortScratch, [](const RenderSortKey& sortKey) { return sortKey.key; });
+
+        stopwatch.Stop();
+        s_Stats.SortTime = static_cast<float>(stopwatch.GetPreciseElapsedTime() * 1000.0);
+    }
+
+    Material* Renderer::GetCommandMaterial(const RenderCommand& command)
+    {
+        return command.material ? command.material.get() : s_RendererData.DefaultMaterial.get();
+    }
+
+    void Renderer::BuildRenderBatches()
+    {
+        ZoneScoped;
+
+        const std::vector<RenderCommand>& queue = s_RendererData.renderQueue;
+        const std::vector<RenderSortKey>& sortKeys = s_RendererData.sortKeys;
+        std::vector<RenderBatch>& batches = s_RendererData.renderBatches;
+        std::vector<InstanceData>& instances = s_RendererData.instances;
+        batches.clear();
+        instances.clear();
+
+        auto vertexArrayOf = [](const RenderCommand& command) {
+            return command.vertexArray ? command.vertexArray.get() : command.mesh->GetVertexArray().get();
+        };
+
+        for(uint32_t i = 0; i < sortKeys.size(); i++)
+        {
+            const RenderCommand& command = queue[sortKeys[i].command];
+            Material* material = GetCommandMaterial(command);
+
+            // Shaders without an instance buffer get their transform as uniforms, one draw per command
+            bool instanced = material->GetShader()->GetStandardUniforms().instanceOffset.IsValid();
+
+            bool merged = false;
+            if(instanced && !batches.empty() && batches.back().instanceOffset >= 0)
+            {
+                // The sort keys put the commands sharing a mesh and material next to each other, the skinned ones also have to share a palette
+                const RenderCommand& first = queue[sortKeys[batches.back().firstKey].command];
+                merged = GetCommandMaterial(first) == material && vertexArrayOf(first) == vertexArrayOf(command) &&
+                         first.boneOffset == command.boneOffset && first.nextBoneOffset == command.nextBoneOffset &&
+                         first.boneLerp == command.boneLerp;
+            }
+
+            if(merged)
+            {
+                batches.back().count++;
+            }
+            else
+            {
+                batches.push_back({ i, 1, instanced ? static_cast<int32_t>(instances.size()) : -1 });
+            }
+
+            if(instanced)
+            {
+                InstanceData& instance = instances.emplace_back();
+                instance.model = command.transform;
+                instance.normalMatrix = glm::mat3x4(glm::transpose(glm::inverse(glm::mat3(command.transform))));
+                instance.entityID = glm::vec4(EntityIDToColor(command.entityID), 1.0f);
+            }
+        }
+
+        if(instances.empty())
+            return;
+
+        s_RendererData.InstanceBuffer->Upload(instances.data(), static_cast<uint32_t>(instances.size()));
+    }
+
+    void Renderer::BuildMultiDrawCommands()
+    {
+        ZoneScoped;
+
+        const std::vector<RenderCommand>& queue = s_RendererData.renderQueue;
+        const std::vector<RenderSortKey>& sortKeys = s_RendererData.sortKeys;
+        std::vector<DrawElementsIndirectCommand>& drawCommands = s_RendererData.drawCommands;
+        drawCommands.clear();
+
+        for(RenderBatch& batch : s_RendererData.renderBatches)
+        {
+            // Only instanced batches of static meshes read everything that differs between draws from the instance buffer
+            const RenderCommand& command = queue[sortKeys[batch.firstKey].command];
+            if(batch.instanceOffset < 0 || command.vertexArray || command.boneOffset >= 0 || !command.mesh->AddToGeometryArena())
+                continue;
+
+            const GeometryArenaAllocation& allocation = command.mesh->GetArenaAllocation();
+            drawCommands.push_back({ allocation.indexCount, batch.count, allocation.firstIndex,
+                                     static_cast<int32_t>(allocation.baseVertex), static_cast<uint32_t>(batch.instanceOffset) });
+            batch.multiDraw = true;
+        }
+
+        if(drawCommands.empty())
+            return;
+
+        GeometryArena::ReserveInstances(static_cast<uint32_t>(s_RendererData.instances.size()));
+        s_RendererData.drawCommandOffset = GeometryArena::UploadDrawCommands(drawCommands);
+    }
+}
@@ -3,15 +3,19 @@
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
 #include "CoffeeEngine/Renderer/Framebuffer.h"
+#include "CoffeeEngine/Renderer/GeometryArena.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Shader.h"
+#include "CoffeeEngine/Renderer/ShaderStorageBuffer.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "CoffeeEngine/Renderer/UniformBuffer.h"
 #include "CoffeeEngine/Renderer/VertexArray.h"
 #include "CoffeeEngine/Scene/Components.h"
 #include <glm/fwd.hpp>
 
+#include <unordered_map>
+
 namespace Coffee {
 
     /**
@@ -26,6 +30,46 @@ namespace Coffee {
         Ref<Mesh> mesh;
         Ref<Material> material;
         uint32_t entityID;
+        const glm::mat4* boneMatrices = nullptr; ///< The bone palette of a skinned mesh, owned by its AnimatorComponent.
+        uint32_t boneCount = 0; ///< The number of matrices in the bone palette.
+        int32_t boneOffset = -1; ///< The index of the palette in the bone palette buffer, assigned by EndScene.
+        const glm::mat4* nextBoneMatrices = nullptr; ///< A second palette of boneCount matrices blended in by boneLerp, used by baked animations.
+        float boneLerp = 0.0f; ///< The weight of nextBoneMatrices.
+        int32_t nextBoneOffset = -1; ///< The index of the second palette in the bone palette buffer, assigned by EndScene.
+        Ref<VertexArray> vertexArray; ///< Drawn instead of the vertex array of the mesh, used by the instances of a MorphedMesh.
+    };
+
+    /**
+     * @brief The sort key of a command of the render queue.
+     *
+     * Opaque keys order by shader, material, mesh and then front to back, transparent keys order back to front first
+     * so blending stays correct, and by state only between draws at the same depth.
+     */
+    struct RenderSortKey
+    {
+        uint64_t key; ///< The 64-bit key, built by Renderer::SortRenderQueue.
+        uint32_t command; ///< The index of the command in the render queue.
+    };
+
+    /**
+     * @brief The per-instance data of an instanced draw, laid out like InstanceData in the std430 instance buffer of the standard shader.
+     */
+    struct InstanceData
+    {
+        glm::mat4 model; ///< The model matrix.
+        glm::mat3x4 normalMatrix; ///< The normal matrix, with std430 mat3 columns padded to a vec4.
+        glm::vec4 entityID; ///< The entity ID encoded as a color, see EndScene.
+    };
+
+    /**
+     * @brief Consecutive commands of the sorted render queue drawn with a single draw call.
+     */
+    struct RenderBatch
+    {
+        uint32_t firstKey; ///< The index of the first command of the batch in RendererData::sortKeys.
+        uint32_t count; ///< The number of commands of the batch.
+        int32_t instanceOffset = -1; ///< The index of the first instance in the instance buffer segment, -1 if the batch is not instanced.
+        bool multiDraw = false; ///< Whether the batch is drawn from the geometry arena, by a multi-draw with the next batches of its material.
     };
 
     /**
@@ -58,11 +102,25 @@ namespace Coffee {
         Ref<UniformBuffer> CameraUniformBuffer; ///< Uniform buffer for camera data.
         Ref<UniformBuffer> RenderDataUniformBuffer; ///< Uniform buffer for render data.
 
+        Ref<ShaderStorageRingBuffer> BonePaletteBuffer; ///< The palettes of every skinned draw, one segment per frame.
+        std::vector<glm::mat4> bonePalettes; ///< Palettes of the current frame, uploaded at once.
+        std::unordered_map<const glm::mat4*, int32_t> bonePaletteOffsets; ///< Offset of every palette already in bonePalettes.
+
+        Ref<ShaderStorageRingBuffer> InstanceBuffer; ///< The instances of every instanced draw, one segment per frame.
+        std::vector<InstanceData> instances; ///< Instances of the current frame, uploaded at once.
+
+        std::vector<DrawElementsIndirectCommand> drawCommands; ///< Draws of the batches drawn from the geometry arena, in batch order.
+        uint32_t drawCommandOffset = 0; ///< Byte offset of drawCommands in the indirect buffer.
+        std::vector<RenderBatch> renderBatches; ///< The draw calls of the sorted render queue.
+
         Ref<Material> DefaultMaterial; ///< Default material.
 
         Ref<Texture2D> RenderTexture; ///< Render texture.
 
         std::vector<RenderCommand> renderQueue; ///< Render queue.
+        std::vector<RenderSortKey> sortKeys; ///< Keys of the render queue, in draw order after sorting.
+        std::vector<RenderSortKey> sortScratch; ///< Scratch buffer of the radix sort.
+        std::unordered_map<const void*, uint32_t> sortIDs; ///< Dense per-frame ids of the shaders, materials and meshes of the queue.
     };
 
     /**
@@ -73,6 +131,13 @@ namespace Coffee {
         uint32_t DrawCalls = 0; ///< Number of draw calls.
         uint32_t VertexCount = 0; ///< Number of vertices.
         uint32_t IndexCount = 0; ///< Number of indices.
+        uint32_t BoneMatrixCount = 0; ///< Number of bone matrices uploaded.
+        uint32_t InstanceCount = 0; ///< Number of commands drawn by instanced draw calls.
+        uint32_t IndirectDrawCount = 0; ///< Number of draws issued by multi-draw indirect calls.
+        uint32_t ShaderChanges = 0; ///< Number of shader binds of the render queue.
+        uint32_t MaterialChanges = 0; ///< Number of material binds of the render queue.
+        uint32_t MeshChanges = 0; ///< Number of vertex array changes of the render queue.
+        float SortTime = 0.0f; ///< Time spent sorting the render queue, in milliseconds.
     };
 
     /**
@@ -85,6 +150,7 @@ namespace Coffee {
         bool Bloom = false; ///< Enable or disable bloom.
         bool FXAA = false; ///< Enable or disable FXAA.
         float Exposure = 1.0f; ///< Exposure value.
+        bool MultiDrawIndirect = false; ///< Draw the instanced static meshes from the geometry arena, one multi-draw per material.
 
         // REMOVE: This is for the first release of the engine it should be handled differently
         bool showNormals = false;
@@ -195,6 +261,32 @@ namespace Coffee {
 
         static void ResizeFramebuffers();
 
+        /**
+         * @brief Writes the bone palettes of the render queue into the current segment of the palette buffer with a single upload.
+         */
+        static void UploadBonePalettes();
+
+        /**
+         * @brief Builds the sort key of every command of the render queue and radix sorts them into draw order.
+         */
+        static void SortRenderQueue();
+
+        /**
+         * @brief Merges the consecutive commands of the sorted queue sharing a mesh, material and palette into instanced batches,
+         * and uploads their instances with a single upload.
+         */
+        static void BuildRenderBatches();
+
+        /**
+         * @brief Moves the instanced batches of static meshes into the geometry arena and uploads their indirect draws.
+         */
+        static void BuildMultiDrawCommands();
+
+        /**
+         * @brief Gets the material a command is drawn with, the default material if it has none.
+         */
+        static Material* GetCommandMaterial(const RenderCommand& command);
+
     private:
         static RendererData s_RendererData; ///< Renderer data.
         static RendererStats s_Stats; ///< Renderer statistics.
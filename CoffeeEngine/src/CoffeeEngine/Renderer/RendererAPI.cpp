@@ -3,6 +3,8 @@
 #include <glad/glad.h>
 #include <tracy/Tracy.hpp>
 
+#include <cstdint>
+
 namespace Coffee {
 
 	Scope<RendererAPI> RendererAPI::s_RendererAPI = RendererAPI::Create();
@@ -76,13 +78,28 @@ namespace Coffee {
     {
         ZoneScoped;
 
+        // The vertex array holds its vertex and index buffers, binding them again is redundant
         vertexArray->Bind();
-		vertexArray->GetVertexBuffers()[0]->Bind();
-		vertexArray->GetIndexBuffer()->Bind();
         uint32_t count = vertexArray->GetIndexBuffer()->GetCount();
         glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
     }
 
+    void RendererAPI::DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t instanceCount)
+    {
+        ZoneScoped;
+
+        vertexArray->Bind();
+        uint32_t count = vertexArray->GetIndexBuffer()->GetCount();
+        glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, instanceCount);
+    }
+
+    void RendererAPI::MultiDrawIndexedIndirect(uint32_t indirectOffset, uint32_t drawCount)
+    {
+        ZoneScoped;
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(indirectOffset)), drawCount, 0);
+    }
+
 	void RendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth)
 	{
 		ZoneScoped;
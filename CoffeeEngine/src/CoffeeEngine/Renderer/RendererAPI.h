@@ -46,6 +46,20 @@ namespace Coffee {
          */
         static void DrawIndexed(const Ref<VertexArray>& vertexArray);
 
+        /**
+         * @brief Draws several instances of the indexed vertices from the specified vertex array.
+         * @param vertexArray The vertex array containing the vertices to draw.
+         * @param instanceCount The number of instances to draw.
+         */
+        static void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t instanceCount);
+
+        /**
+         * @brief Draws the DrawElementsIndirectCommand list of the bound indirect buffer with the bound vertex array.
+         * @param indirectOffset The byte offset of the first draw in the indirect buffer.
+         * @param drawCount The number of draws.
+         */
+        static void MultiDrawIndexedIndirect(uint32_t indirectOffset, uint32_t drawCount);
+
         /**
          * @brief Draws lines from the specified vertex array.
          * @param vertexArray The vertex array containing the vertices to draw.
@@ -1,6 +1,7 @@
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 
 #include <fstream>
 #include <sstream>
@@ -48,92 +49,131 @@ namespace Coffee {
         ZoneScoped;
 
         glDeleteProgram(m_ShaderID);
+        RenderState::OnProgramDeleted(m_ShaderID);
     }
 
     void Shader::Bind()
     {
         ZoneScoped;
 
-        glUseProgram(m_ShaderID);
+        RenderState::UseProgram(m_ShaderID);
     }
 
     void Shader::Unbind()
     {
         ZoneScoped;
 
-        glUseProgram(0);
+        RenderState::UseProgram(0);
     }
 
-    void Shader::setBool(const std::string& name, bool value) const
+    void Shader::setBool(std::string_view name, bool value) const
     {
-        ZoneScoped;
+        setUniform(ShaderUniform<bool>{ m_Reflection.FindLocation(name) }, value);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform1i(location, (int)value);
+    void Shader::setInt(std::string_view name, int value) const
+    {
+        setUniform(ShaderUniform<int>{ m_Reflection.FindLocation(name) }, value);
     }
 
-    void Shader::setInt(const std::string& name, int value) const
+    void Shader::setFloat(std::string_view name, float value) const
     {
-        ZoneScoped;
+        setUniform(ShaderUniform<float>{ m_Reflection.FindLocation(name) }, value);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform1i(location, value);
+    void Shader::setVec2(std::string_view name, const glm::vec2& value) const
+    {
+        setUniform(ShaderUniform<glm::vec2>{ m_Reflection.FindLocation(name) }, value);
     }
 
-    void Shader::setFloat(const std::string& name, float value) const
+    void Shader::setVec3(std::string_view name, const glm::vec3& value) const
     {
-        ZoneScoped;
+        setUniform(ShaderUniform<glm::vec3>{ m_Reflection.FindLocation(name) }, value);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform1f(location, value);
+    void Shader::setVec4(std::string_view name, const glm::vec4& value) const
+    {
+        setUniform(ShaderUniform<glm::vec4>{ m_Reflection.FindLocation(name) }, value);
     }
 
-    void Shader::setVec2(const std::string& name, const glm::vec2& value) const
+    void Shader::setMat2(std::string_view name, const glm::mat2& mat) const
     {
-        ZoneScoped;
+        setUniform(ShaderUniform<glm::mat2>{ m_Reflection.FindLocation(name) }, mat);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform2fv(location, 1, &value[0]);
+    void Shader::setMat3(std::string_view name, const glm::mat3& mat) const
+    {
+        setUniform(ShaderUniform<glm::mat3>{ m_Reflection.FindLocation(name) }, mat);
     }
 
-    void Shader::setVec3(const std::string& name, const glm::vec3& value) const
+    void Shader::setMat4(std::string_view name, const glm::mat4& mat) const
     {
-        ZoneScoped;
+        setUniform(ShaderUniform<glm::mat4>{ m_Reflection.FindLocation(name) }, mat);
+    }
+
+    void Shader::setMat4Array(std::string_view name, const glm::mat4* mats, uint32_t count) const
+    {
+        GLint location = m_Reflection.FindLocation(name);
+        if(location < 0)
+            return;
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform3fv(location, 1, &value[0]);
+        RenderState::ForgetUniforms(m_ShaderID, location, count);
+        glUniformMatrix4fv(location, count, GL_FALSE, &mats[0][0][0]);
     }
 
-    void Shader::setVec4(const std::string& name, const glm::vec4& value) const
+    void Shader::setUniform(ShaderUniform<bool> uniform, bool value) const
     {
-        ZoneScoped;
+        int intValue = (int)value;
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &intValue, sizeof(intValue)))
+            glUniform1i(uniform.location, intValue);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniform4fv(location, 1, &value[0]);
+    void Shader::setUniform(ShaderUniform<int> uniform, int value) const
+    {
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniform1i(uniform.location, value);
     }
 
-    void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
+    void Shader::setUniform(ShaderUniform<float> uniform, float value) const
     {
-        ZoneScoped;
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniform1f(uniform.location, value);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+    void Shader::setUniform(ShaderUniform<glm::vec2> uniform, const glm::vec2& value) const
+    {
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniform2fv(uniform.location, 1, &value[0]);
     }
 
-    void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
+    void Shader::setUniform(ShaderUniform<glm::vec3> uniform, const glm::vec3& value) const
     {
-        ZoneScoped;
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniform3fv(uniform.location, 1, &value[0]);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+    void Shader::setUniform(ShaderUniform<glm::vec4> uniform, const glm::vec4& value) const
+    {
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniform4fv(uniform.location, 1, &value[0]);
     }
 
-    void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
+    void Shader::setUniform(ShaderUniform<glm::mat2> uniform, const glm::mat2& value) const
     {
-        ZoneScoped;
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &value[0][0]);
+    }
+
+    void Shader::setUniform(ShaderUniform<glm::mat3> uniform, const glm::mat3& value) const
+    {
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &value[0][0]);
+    }
 
-        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
-        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+    void Shader::setUniform(ShaderUniform<glm::mat4> uniform, const glm::mat4& value) const
+    {
+        if(RenderState::ShouldUploadUniform(m_ShaderID, uniform.location, &value, sizeof(value)))
+            glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &value[0][0]);
     }
 
     Ref<Shader> Shader::Create(const std::filesystem::path& shaderPath)
@@ -214,6 +254,32 @@ namespace Coffee {
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        // Looking the names up once here saves a driver lookup on every upload
+        m_Reflection = ShaderReflection::Reflect(m_ShaderID);
+
+        m_StandardUniforms.model = GetUniform<glm::mat4>("model");
+        m_StandardUniforms.normalMatrix = GetUniform<glm::mat3>("normalMatrix");
+        m_StandardUniforms.entityID = GetUniform<glm::vec3>("entityID");
+        m_StandardUniforms.showNormals = GetUniform<bool>("showNormals");
+        m_StandardUniforms.instanceOffset = GetUniform<int>("instanceOffset");
+
+        m_StandardUniforms.boneOffset = GetUniform<int>("boneOffset");
+        m_StandardUniforms.boneInfluences = GetUniform<int>("boneInfluences");
+        m_StandardUniforms.nextBoneOffset = GetUniform<int>("nextBoneOffset");
+        m_StandardUniforms.boneLerp = GetUniform<float>("boneLerp");
+
+        m_StandardUniforms.materialColor = GetUniform<glm::vec4>("material.color");
+        m_StandardUniforms.materialMetallic = GetUniform<float>("material.metallic");
+        m_StandardUniforms.materialRoughness = GetUniform<float>("material.roughness");
+        m_StandardUniforms.materialAO = GetUniform<float>("material.ao");
+        m_StandardUniforms.materialEmissive = GetUniform<glm::vec3>("material.emissive");
+        m_StandardUniforms.materialHasAlbedo = GetUniform<int>("material.hasAlbedo");
+        m_StandardUniforms.materialHasNormal = GetUniform<int>("material.hasNormal");
+        m_StandardUniforms.materialHasMetallic = GetUniform<int>("material.hasMetallic");
+        m_StandardUniforms.materialHasRoughness = GetUniform<int>("material.hasRoughness");
+        m_StandardUniforms.materialHasAO = GetUniform<int>("material.hasAO");
+        m_StandardUniforms.materialHasEmissive = GetUniform<int>("material.hasEmissive");
     }
 
 }
@@ -2,11 +2,13 @@
 
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/Renderer/ShaderReflection.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace Coffee {
@@ -17,6 +19,47 @@ namespace Coffee {
      * @{
      */
 
+    /**
+     * @brief A uniform location resolved once, set with Shader::setUniform without looking the name up again.
+     * @tparam T The C++ type of the value, which picks the glUniform call.
+     */
+    template<typename T>
+    struct ShaderUniform
+    {
+        int32_t location = -1; ///< The location, -1 if the program has no such active uniform.
+
+        bool IsValid() const { return location >= 0; }
+    };
+
+    /**
+     * @brief The uniforms set by the renderer and the materials on every draw, resolved when the program is linked.
+     */
+    struct ShaderStandardUniforms
+    {
+        ShaderUniform<glm::mat4> model;
+        ShaderUniform<glm::mat3> normalMatrix;
+        ShaderUniform<glm::vec3> entityID;
+        ShaderUniform<bool> showNormals;
+        ShaderUniform<int> instanceOffset; ///< Only declared by shaders reading their transforms from the instance buffer.
+
+        ShaderUniform<int> boneOffset;
+        ShaderUniform<int> boneInfluences;
+        ShaderUniform<int> nextBoneOffset;
+        ShaderUniform<float> boneLerp;
+
+        ShaderUniform<glm::vec4> materialColor;
+        ShaderUniform<float> materialMetallic;
+        ShaderUniform<float> materialRoughness;
+        ShaderUniform<float> materialAO;
+        ShaderUniform<glm::vec3> materialEmissive;
+        ShaderUniform<int> materialHasAlbedo;
+        ShaderUniform<int> materialHasNormal;
+        ShaderUniform<int> materialHasMetallic;
+        ShaderUniform<int> materialHasRoughness;
+        ShaderUniform<int> materialHasAO;
+        ShaderUniform<int> materialHasEmissive;
+    };
+
     /**
      * @brief Class representing a shader program.
      */
@@ -51,63 +94,105 @@ namespace Coffee {
          * @param name The name of the uniform.
          * @param value The boolean value to set.
          */
-        void setBool(const std::string& name, bool value) const;
+        void setBool(std::string_view name, bool value) const;
 
         /**
          * @brief Sets an integer uniform in the shader.
          * @param name The name of the uniform.
          * @param value The integer value to set.
          */
-        void setInt(const std::string& name, int value) const;
+        void setInt(std::string_view name, int value) const;
 
         /**
          * @brief Sets a float uniform in the shader.
          * @param name The name of the uniform.
          * @param value The float value to set.
          */
-        void setFloat(const std::string& name, float value) const;
+        void setFloat(std::string_view name, float value) const;
 
         /**
          * @brief Sets a vec2 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec2 value to set.
          */
-        void setVec2(const std::string& name, const glm::vec2& value) const;
+        void setVec2(std::string_view name, const glm::vec2& value) const;
 
         /**
          * @brief Sets a vec3 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec3 value to set.
          */
-        void setVec3(const std::string& name, const glm::vec3& value) const;
+        void setVec3(std::string_view name, const glm::vec3& value) const;
 
         /**
          * @brief Sets a vec4 uniform in the shader.
          * @param name The name of the uniform.
          * @param value The vec4 value to set.
          */
-        void setVec4(const std::string& name, const glm::vec4& value) const;
+        void setVec4(std::string_view name, const glm::vec4& value) const;
 
         /**
          * @brief Sets a mat2 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat2 value to set.
          */
-        void setMat2(const std::string& name, const glm::mat2& mat) const;
+        void setMat2(std::string_view name, const glm::mat2& mat) const;
 
         /**
          * @brief Sets a mat3 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat3 value to set.
          */
-        void setMat3(const std::string& name, const glm::mat3& mat) const;
+        void setMat3(std::string_view name, const glm::mat3& mat) const;
 
         /**
          * @brief Sets a mat4 uniform in the shader.
          * @param name The name of the uniform.
          * @param mat The mat4 value to set.
          */
-        void setMat4(const std::string& name, const glm::mat4& mat) const;
+        void setMat4(std::string_view name, const glm::mat4& mat) const;
+
+        /**
+         * @brief Sets a mat4 array uniform in the shader with a single upload.
+         * @param name The name of the uniform array.
+         * @param mats The first matrix to set.
+         * @param count The number of matrices to set.
+         */
+        void setMat4Array(std::string_view name, const glm::mat4* mats, uint32_t count) const;
+
+        /**
+         * @brief Resolves the location of a uniform, to set it later without looking its name up.
+         * @tparam T The C++ type of the uniform.
+         * @param name The name of the uniform.
+         * @return The handle, invalid if the program has no such active uniform.
+         */
+        template<typename T>
+        ShaderUniform<T> GetUniform(std::string_view name) const { return { m_Reflection.FindLocation(name) }; }
+
+        /**
+         * @brief Sets a uniform from a handle of this shader. The uploads of invalid handles are skipped.
+         * @param uniform The handle, from GetUniform or GetStandardUniforms.
+         * @param value The value to set.
+         */
+        void setUniform(ShaderUniform<bool> uniform, bool value) const;
+        void setUniform(ShaderUniform<int> uniform, int value) const;
+        void setUniform(ShaderUniform<float> uniform, float value) const;
+        void setUniform(ShaderUniform<glm::vec2> uniform, const glm::vec2& value) const;
+        void setUniform(ShaderUniform<glm::vec3> uniform, const glm::vec3& value) const;
+        void setUniform(ShaderUniform<glm::vec4> uniform, const glm::vec4& value) const;
+        void setUniform(ShaderUniform<glm::mat2> uniform, const glm::mat2& value) const;
+        void setUniform(ShaderUniform<glm::mat3> uniform, const glm::mat3& value) const;
+        void setUniform(ShaderUniform<glm::mat4> uniform, const glm::mat4& value) const;
+
+        /**
+         * @brief Gets the handles of the uniforms set on every draw.
+         */
+        const ShaderStandardUniforms& GetStandardUniforms() const { return m_StandardUniforms; }
+
+        /**
+         * @brief Gets the uniforms and uniform blocks of the program.
+         */
+        const ShaderReflection& GetReflection() const { return m_Reflection; }
 
         /**
          * @brief Creates a shader from the specified vertex and fragment shader paths.
@@ -130,6 +215,8 @@ namespace Coffee {
 
     private:
         unsigned int m_ShaderID; ///< The ID of the shader program.
+        ShaderReflection m_Reflection; ///< The uniforms of the program, queried after linking.
+        ShaderStandardUniforms m_StandardUniforms; ///< The uniforms set on every draw.
     };
 
     /** @} */
@@ -0,0 +1,140 @@
+#include "CoffeeEngine/Renderer/ShaderReflection.h"
+#include "CoffeeEngine/Core/Base.h"
+
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Coffee {
+
+    ShaderReflection ShaderReflection::Reflect(uint32_t program)
+    {
+        ZoneScoped;
+
+        ShaderReflection reflection;
+
+        GLint uniformCount = 0, maxNameLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::string name(std::max(maxNameLength, 1), '\0');
+        for (GLint i = 0; i < uniformCount; i++)
+        {
+            GLsizei length = 0;
+            GLint count = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, i, maxNameLength, &length, &count, &type, name.data());
+
+            // Members of uniform blocks have no location, they are written through the buffer of the block
+            GLint location = glGetUniformLocation(program, name.c_str());
+            if (location < 0)
+                continue;
+
+            ShaderUniformInfo uniform;
+            uniform.name.assign(name.data(), length);
+            uniform.location = location;
+            uniform.type = type;
+            uniform.count = count;
+
+            // Arrays are reported as "name[0]", both "name" and "name[i]" have to be found
+            if (uniform.name.size() > 3 && uniform.name.ends_with("[0]"))
+            {
+                uniform.name.resize(uniform.name.size() - 3);
+                for (GLint element = 1; element < count; element++)
+                {
+                    ShaderUniformInfo elementInfo;
+                    elementInfo.name = uniform.name + "[" + std::to_string(element) + "]";
+                    elementInfo.location = location + element;
+                    elementInfo.type = type;
+                    reflection.AddUniform(elementInfo);
+                }
+
+                ShaderUniformInfo firstElement = uniform;
+                firstElement.name += "[0]";
+                firstElement.count = 1;
+                reflection.AddUniform(firstElement);
+            }
+
+            reflection.AddUniform(uniform);
+        }
+
+        GLint blockCount = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+        for (GLint i = 0; i < blockCount; i++)
+        {
+            GLint nameLength = 0, binding = 0, size = 0;
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+            ShaderUniformBlockInfo block;
+            block.name.resize(std::max(nameLength, 1));
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(program, i, nameLength, &length, block.name.data());
+            block.name.resize(length);
+            block.index = i;
+            block.binding = binding;
+            block.size = size;
+            reflection.AddUniformBlock(block);
+        }
+
+        reflection.Finalize();
+        return reflection;
+    }
+
+    void ShaderReflection::AddUniform(const ShaderUniformInfo& uniform)
+    {
+        m_Uniforms.push_back(uniform);
+    }
+
+    void ShaderReflection::AddUniformBlock(const ShaderUniformBlockInfo& block)
+    {
+        m_UniformBlocks.push_back(block);
+    }
+
+    void ShaderReflection::Finalize()
+    {
+        std::vector<uint32_t> order(m_Uniforms.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::vector<uint64_t> hashes(m_Uniforms.size());
+        for (size_t i = 0; i < m_Uniforms.size(); i++)
+            hashes[i] = Hash(m_Uniforms[i].name);
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return hashes[a] < hashes[b]; });
+
+        m_Hashes.resize(order.size());
+        m_Locations.resize(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            m_Hashes[i] = hashes[order[i]];
+            m_Locations[i] = m_Uniforms[order[i]].location;
+
+            COFFEE_CORE_ASSERT(i == 0 || m_Hashes[i] != m_Hashes[i - 1] || m_Locations[i] == m_Locations[i - 1],
+                               "ShaderReflection: two uniforms have the same name hash!");
+        }
+    }
+
+    int32_t ShaderReflection::FindLocation(uint64_t hash) const
+    {
+        auto it = std::lower_bound(m_Hashes.begin(), m_Hashes.end(), hash);
+        if (it == m_Hashes.end() || *it != hash)
+            return -1;
+
+        return m_Locations[it - m_Hashes.begin()];
+    }
+
+    const ShaderUniformBlockInfo* ShaderReflection::FindUniformBlock(std::string_view name) const
+    {
+        // A program has a handful of blocks, which are looked up when a material is created, not per draw
+        for (const ShaderUniformBlockInfo& block : m_UniformBlocks)
+        {
+            if (block.name == name)
+                return &block;
+        }
+        return nullptr;
+    }
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    /**
+     * @brief An active uniform of a linked program.
+     */
+    struct ShaderUniformInfo
+    {
+        std::string name; ///< The name, without the [0] suffix of arrays.
+        int32_t location = -1; ///< The location of the first element.
+        uint32_t type = 0; ///< The GL type, like GL_FLOAT_MAT4.
+        int32_t count = 1; ///< The number of elements, 1 if the uniform is not an array.
+    };
+
+    /**
+     * @brief An active uniform block of a linked program.
+     */
+    struct ShaderUniformBlockInfo
+    {
+        std::string name; ///< The name of the block.
+        uint32_t index = 0; ///< The index of the block in the program.
+        uint32_t binding = 0; ///< The binding point, set in the shader with layout(binding = n).
+        uint32_t size = 0; ///< The size of the block in bytes.
+    };
+
+    /**
+     * @brief The uniforms and uniform blocks of a program, queried once after linking.
+     *
+     * Lookups hash the name and binary search a flat array of hashes, instead of asking the driver
+     * for the location of a string on every upload.
+     */
+    class ShaderReflection
+    {
+    public:
+        /**
+         * @brief Hashes a uniform name with 64-bit FNV-1a.
+         */
+        static constexpr uint64_t Hash(std::string_view name)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (char c : name)
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Queries the active uniforms and uniform blocks of a linked program.
+         * @param program The GL program.
+         * @return The reflection of the program.
+         */
+        static ShaderReflection Reflect(uint32_t program);
+
+        /**
+         * @brief Adds a uniform. Call Finalize once every uniform was added.
+         */
+        void AddUniform(const ShaderUniformInfo& uniform);
+
+        /**
+         * @brief Adds a uniform block. Call Finalize once every block was added.
+         */
+        void AddUniformBlock(const ShaderUniformBlockInfo& block);
+
+        /**
+         * @brief Sorts the lookup tables, the reflection can be queried afterwards.
+         */
+        void Finalize();
+
+        /**
+         * @brief Finds the location of a uniform.
+         * @param name The name of the uniform. Elements and members of arrays are named like in GLSL, "lights[1].color".
+         * @return The location, or -1 if the program has no such active uniform.
+         */
+        int32_t FindLocation(std::string_view name) const { return FindLocation(Hash(name)); }
+
+        /**
+         * @brief Finds the location of a uniform from the hash of its name.
+         */
+        int32_t FindLocation(uint64_t hash) const;
+
+        /**
+         * @brief Finds a uniform block.
+         * @return The block, or nullptr if the program has no such active block.
+         */
+        const ShaderUniformBlockInfo* FindUniformBlock(std::string_view name) const;
+
+        const std::vector<ShaderUniformInfo>& GetUniforms() const { return m_Uniforms; }
+        const std::vector<ShaderUniformBlockInfo>& GetUniformBlocks() const { return m_UniformBlocks; }
+
+    private:
+        std::vector<ShaderUniformInfo> m_Uniforms;
+        std::vector<ShaderUniformBlockInfo> m_UniformBlocks;
+
+        std::vector<uint64_t> m_Hashes; ///< The sorted hashes of the uniform names.
+        std::vector<int32_t> m_Locations; ///< The location of every hash of m_Hashes.
+    };
+
+    /** @} */
+}
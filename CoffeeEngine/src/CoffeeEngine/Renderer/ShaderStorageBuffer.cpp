@@ -0,0 +1,77 @@
+#include "ShaderStorageBuffer.h"
+#include "CoffeeEngine/Core/Base.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <glad/glad.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    ShaderStorageBuffer::ShaderStorageBuffer(uint32_t size, uint32_t binding)
+        : m_Size(size), m_Binding(binding)
+    {
+        glCreateBuffers(1, &m_ssboID);
+        glNamedBufferData(m_ssboID, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_ssboID);
+    }
+
+    ShaderStorageBuffer::~ShaderStorageBuffer()
+    {
+        glDeleteBuffers(1, &m_ssboID);
+    }
+
+    void ShaderStorageBuffer::SetData(const void* data, uint32_t size, uint32_t offset)
+    {
+        ZoneScoped;
+
+        glNamedBufferSubData(m_ssboID, offset, size, data);
+    }
+
+    void ShaderStorageBuffer::BindRange(uint32_t offset, uint32_t size)
+    {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, m_Binding, m_ssboID, offset, size);
+    }
+
+    Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(uint32_t size, uint32_t binding)
+    {
+        return CreateRef<ShaderStorageBuffer>(size, binding);
+    }
+
+    // The largest storage buffer offset alignment allowed by GL
+    static constexpr uint32_t s_SegmentAlignment = 256;
+
+    ShaderStorageRingBuffer::ShaderStorageRingBuffer(uint32_t elementSize, uint32_t capacity, uint32_t binding)
+        : m_ElementSize(elementSize), m_Binding(binding)
+    {
+        COFFEE_CORE_ASSERT(s_SegmentAlignment % elementSize == 0, "ShaderStorageRingBuffer: the element size does not divide the segment alignment!");
+
+        m_SegmentCapacity = std::max(std::bit_ceil(capacity), s_SegmentAlignment / m_ElementSize);
+        m_Buffer = ShaderStorageBuffer::Create(m_SegmentCapacity * m_ElementSize * Frames, m_Binding);
+    }
+
+    void ShaderStorageRingBuffer::Upload(const void* data, uint32_t count)
+    {
+        ZoneScoped;
+
+        if(count > m_SegmentCapacity)
+        {
+            m_SegmentCapacity = std::bit_ceil(count);
+            m_Buffer = ShaderStorageBuffer::Create(m_SegmentCapacity * m_ElementSize * Frames, m_Binding);
+        }
+
+        m_Segment = (m_Segment + 1) % Frames;
+
+        uint32_t offset = m_Segment * m_SegmentCapacity * m_ElementSize;
+        uint32_t size = count * m_ElementSize;
+        m_Buffer->SetData(data, size, offset);
+        m_Buffer->BindRange(offset, size);
+    }
+
+    Ref<ShaderStorageRingBuffer> ShaderStorageRingBuffer::Create(uint32_t elementSize, uint32_t capacity, uint32_t binding)
+    {
+        return CreateRef<ShaderStorageRingBuffer>(elementSize, capacity, binding);
+    }
+
+}
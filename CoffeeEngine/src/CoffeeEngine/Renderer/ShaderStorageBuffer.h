@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Class representing a shader storage buffer.
+     */
+    class ShaderStorageBuffer
+    {
+    public:
+        /**
+         * @brief Constructs a ShaderStorageBuffer with the specified size and binding.
+         * @param size The size of the buffer.
+         * @param binding The binding point of the buffer.
+         */
+        ShaderStorageBuffer(uint32_t size, uint32_t binding);
+
+        /**
+         * @brief Destructor for the ShaderStorageBuffer class.
+         */
+        virtual ~ShaderStorageBuffer();
+
+        /**
+         * @brief Sets the data of the shader storage buffer.
+         * @param data A pointer to the data to set.
+         * @param size The size of the data.
+         * @param offset The offset in the buffer to set the data.
+         */
+        void SetData(const void* data, uint32_t size, uint32_t offset = 0);
+
+        /**
+         * @brief Binds a range of the buffer to its binding point.
+         * @param offset The offset of the range, a multiple of the storage buffer offset alignment.
+         * @param size The size of the range.
+         */
+        void BindRange(uint32_t offset, uint32_t size);
+
+        /**
+         * @brief Gets the size of the buffer.
+         * @return The size of the buffer in bytes.
+         */
+        uint32_t GetSize() const { return m_Size; }
+
+        /**
+         * @brief Creates a shader storage buffer with the specified size and binding.
+         * @param size The size of the buffer.
+         * @param binding The binding point of the buffer.
+         * @return A reference to the created shader storage buffer.
+         */
+        static Ref<ShaderStorageBuffer> Create(uint32_t size, uint32_t binding);
+    private:
+        uint32_t m_ssboID; ///< The ID of the shader storage buffer.
+        uint32_t m_Size; ///< The size of the buffer.
+        uint32_t m_Binding; ///< The binding point of the buffer.
+    };
+
+    /**
+     * @brief A shader storage buffer split in one segment per frame in flight, for data uploaded again every frame.
+     *
+     * Each upload writes the next segment, so it does not wait for the draws of the previous frames still reading theirs.
+     * Segments are a multiple of 256 bytes, the largest storage buffer offset alignment allowed by GL, and double when an
+     * upload does not fit.
+     */
+    class ShaderStorageRingBuffer
+    {
+    public:
+        static constexpr uint32_t Frames = 3; ///< Number of frames in flight, and so of segments.
+
+        /**
+         * @brief Constructs a ShaderStorageRingBuffer.
+         * @param elementSize The size of an element, a divisor of 256 bytes.
+         * @param capacity The initial number of elements of a segment.
+         * @param binding The binding point of the buffer.
+         */
+        ShaderStorageRingBuffer(uint32_t elementSize, uint32_t capacity, uint32_t binding);
+
+        /**
+         * @brief Writes the elements of the frame into the next segment and binds them.
+         * @param data A pointer to the elements.
+         * @param count The number of elements.
+         */
+        void Upload(const void* data, uint32_t count);
+
+        /**
+         * @brief Gets the number of elements of a segment.
+         */
+        uint32_t GetSegmentCapacity() const { return m_SegmentCapacity; }
+
+        /**
+         * @brief Creates a shader storage ring buffer.
+         * @param elementSize The size of an element, a divisor of 256 bytes.
+         * @param capacity The initial number of elements of a segment.
+         * @param binding The binding point of the buffer.
+         * @return A reference to the created ring buffer.
+         */
+        static Ref<ShaderStorageRingBuffer> Create(uint32_t elementSize, uint32_t capacity, uint32_t binding);
+    private:
+        Ref<ShaderStorageBuffer> m_Buffer; ///< The buffer holding every segment.
+        uint32_t m_ElementSize; ///< The size of an element.
+        uint32_t m_Binding; ///< The binding point of the buffer.
+        uint32_t m_SegmentCapacity; ///< The number of elements of a segment.
+        uint32_t m_Segment = 0; ///< The segment written by the last upload.
+    };
+
+    /** @} */
+}
@@ -0,0 +1,187 @@
+#include "CoffeeEngine/Renderer/SkinData.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace Coffee {
+
+    static uint32_t IndexSize(SkinIndexFormat format) { return format == SkinIndexFormat::UInt8 ? 1 : 2; }
+    static uint32_t WeightSize(SkinWeightFormat format) { return format == SkinWeightFormat::UNorm8 ? 1 : 2; }
+    static uint32_t WeightMax(SkinWeightFormat format) { return format == SkinWeightFormat::UNorm8 ? UINT8_MAX : UINT16_MAX; }
+
+    static void Store(uint8_t*& out, uint32_t value, uint32_t size)
+    {
+        if (size == 1)
+        {
+            *out = static_cast<uint8_t>(value);
+        }
+        else
+        {
+            uint16_t value16 = static_cast<uint16_t>(value);
+            std::memcpy(out, &value16, sizeof(value16));
+        }
+        out += size;
+    }
+
+    static uint32_t Load(const uint8_t*& in, uint32_t size)
+    {
+        uint32_t value = *in;
+        if (size == 2)
+        {
+            uint16_t value16;
+            std::memcpy(&value16, in, sizeof(value16));
+            value = value16;
+        }
+        in += size;
+        return value;
+    }
+
+    void VertexInfluences::Add(uint32_t boneID, float weight)
+    {
+        if (weight <= 0.0f)
+            return;
+
+        // Some exporters split the weight of a bone in several entries
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (boneIDs[i] == boneID)
+            {
+                weights[i] += weight;
+                return;
+            }
+        }
+
+        if (count < kCapacity)
+        {
+            boneIDs[count] = boneID;
+            weights[count] = weight;
+            count++;
+            return;
+        }
+
+        uint32_t weakest = static_cast<uint32_t>(std::min_element(weights.begin(), weights.end()) - weights.begin());
+        if (weight > weights[weakest])
+        {
+            boneIDs[weakest] = boneID;
+            weights[weakest] = weight;
+        }
+    }
+
+    SkinData SkinData::Build(const std::vector<VertexInfluences>& influences, const SkinImportSettings& settings)
+    {
+        ZoneScoped;
+
+        SkinData skin;
+
+        bool influenced = false;
+        uint32_t maxBoneID = 0;
+        for (const VertexInfluences& vertex : influences)
+        {
+            for (uint32_t i = 0; i < vertex.count; i++)
+            {
+                maxBoneID = std::max(maxBoneID, vertex.boneIDs[i]);
+                influenced = true;
+            }
+        }
+
+        // Static meshes carry no skin attributes at all
+        if (!influenced)
+            return skin;
+
+        skin.m_VertexCount = static_cast<uint32_t>(influences.size());
+        skin.m_InfluenceCount = settings.maxInfluences > 4 ? 8 : 4;
+        skin.m_IndexFormat = maxBoneID <= UINT8_MAX ? SkinIndexFormat::UInt8 : SkinIndexFormat::UInt16;
+        skin.m_WeightFormat = settings.weightFormat;
+
+        uint32_t indexSize = IndexSize(skin.m_IndexFormat);
+        uint32_t weightSize = WeightSize(skin.m_WeightFormat);
+        int32_t weightMax = static_cast<int32_t>(WeightMax(skin.m_WeightFormat));
+        skin.m_Stride = skin.m_InfluenceCount * (indexSize + weightSize);
+        skin.m_Data.assign(static_cast<size_t>(skin.m_VertexCount) * skin.m_Stride, 0);
+
+        for (uint32_t v = 0; v < skin.m_VertexCount; v++)
+        {
+            const VertexInfluences& vertex = influences[v];
+
+            std::array<uint32_t, VertexInfluences::kCapacity> order;
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.begin() + vertex.count, [&](uint32_t a, uint32_t b) { return vertex.weights[a] > vertex.weights[b]; });
+
+            uint32_t count = std::min(vertex.count, skin.m_InfluenceCount);
+            float total = 0.0f;
+            for (uint32_t i = 0; i < count; i++)
+                total += vertex.weights[order[i]];
+
+            std::array<uint32_t, VertexInfluences::kCapacity> boneIDs{};
+            std::array<int32_t, VertexInfluences::kCapacity> weights{};
+            if (total > 0.0f)
+            {
+                int32_t sum = 0;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    boneIDs[i] = vertex.boneIDs[order[i]];
+                    weights[i] = static_cast<int32_t>(std::lround(vertex.weights[order[i]] / total * weightMax));
+                    sum += weights[i];
+                }
+
+                // Rounding leaves the sum a few units off, the strongest influence absorbs the difference
+                weights[0] += weightMax - sum;
+            }
+
+            uint8_t* out = skin.m_Data.data() + static_cast<size_t>(v) * skin.m_Stride;
+            for (uint32_t group = 0; group < skin.m_InfluenceCount; group += 4)
+            {
+                for (uint32_t i = group; i < group + 4; i++)
+                    Store(out, boneIDs[i], indexSize);
+                for (uint32_t i = group; i < group + 4; i++)
+                    Store(out, static_cast<uint32_t>(weights[i]), weightSize);
+            }
+        }
+
+        return skin;
+    }
+
+    uint32_t SkinData::Decode(uint32_t vertex, uint32_t* boneIDs, float* weights) const
+    {
+        uint32_t indexSize = IndexSize(m_IndexFormat);
+        uint32_t weightSize = WeightSize(m_WeightFormat);
+        float weightScale = 1.0f / static_cast<float>(WeightMax(m_WeightFormat));
+
+        const uint8_t* in = m_Data.data() + static_cast<size_t>(vertex) * m_Stride;
+        for (uint32_t group = 0; group < m_InfluenceCount; group += 4)
+        {
+            for (uint32_t i = group; i < group + 4; i++)
+                boneIDs[i] = Load(in, indexSize);
+            for (uint32_t i = group; i < group + 4; i++)
+                weights[i] = static_cast<float>(Load(in, weightSize)) * weightScale;
+        }
+
+        return m_InfluenceCount;
+    }
+
+    BufferLayout SkinData::GetLayout() const
+    {
+        ShaderDataType indexType = m_IndexFormat == SkinIndexFormat::UInt8 ? ShaderDataType::UByte4 : ShaderDataType::UShort4;
+        ShaderDataType weightType = m_WeightFormat == SkinWeightFormat::UNorm8 ? ShaderDataType::UByte4 : ShaderDataType::UShort4;
+
+        if (m_InfluenceCount > 4)
+        {
+            return {
+                {indexType, "a_BoneIds"},
+                {weightType, "a_BoneWeights", true},
+                {indexType, "a_BoneIds1"},
+                {weightType, "a_BoneWeights1", true}
+            };
+        }
+
+        return {
+            {indexType, "a_BoneIds"},
+            {weightType, "a_BoneWeights", true}
+        };
+    }
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CoffeeEngine/Renderer/Buffer.h"
+
+#include <cereal/access.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @addtogroup renderer
+     * @{
+     */
+
+    /**
+     * @brief Storage of the bone indices of a skinned vertex.
+     */
+    enum class SkinIndexFormat : uint8_t
+    {
+        UInt8, ///< Up to 256 bones.
+        UInt16 ///< Up to 65536 bones.
+    };
+
+    /**
+     * @brief Storage of the bone weights of a skinned vertex, normalized to [0, 1].
+     */
+    enum class SkinWeightFormat : uint8_t
+    {
+        UNorm8, ///< 1/255 precision, enough for most characters.
+        UNorm16 ///< 1/65535 precision, for rigs with many small weights.
+    };
+
+    /**
+     * @brief How the skin weights of a model are compacted at import.
+     */
+    struct SkinImportSettings
+    {
+        uint32_t maxInfluences = 4; ///< The number of influences kept per vertex, 4 or 8.
+        SkinWeightFormat weightFormat = SkinWeightFormat::UNorm8; ///< The storage of the weights.
+    };
+
+    /**
+     * @brief The bone influences gathered for one vertex during import.
+     *
+     * Only the strongest influences are kept, so the order in which the bones are visited does not matter.
+     */
+    struct VertexInfluences
+    {
+        static constexpr uint32_t kCapacity = 8; ///< The largest number of influences a SkinData can store.
+
+        std::array<uint32_t, kCapacity> boneIDs{}; ///< The bones influencing the vertex.
+        std::array<float, kCapacity> weights{}; ///< The raw weight of each bone.
+        uint32_t count = 0; ///< The number of influences.
+
+        /**
+         * @brief Adds an influence, replacing the weakest one when the vertex is full.
+         * @param boneID The index of the bone in the palette.
+         * @param weight The weight of the bone, ignored if not positive.
+         */
+        void Add(uint32_t boneID, float weight);
+    };
+
+    /**
+     * @brief The compact bone indices and weights of a skinned mesh, uploaded in their own vertex buffer.
+     *
+     * Each vertex stores its influences in groups of four: four indices followed by four weights.
+     * Weights are renormalized after the strongest influences are selected and quantized so they add up to exactly one.
+     * Unused influences point to bone 0 with a zero weight.
+     */
+    class SkinData
+    {
+    public:
+        SkinData() = default;
+
+        /**
+         * @brief Compacts the influences of every vertex of a mesh.
+         * @param influences The influences of each vertex.
+         * @param settings The number of influences kept and the storage of the weights.
+         * @return The skin, empty if no vertex is influenced by a bone.
+         */
+        static SkinData Build(const std::vector<VertexInfluences>& influences, const SkinImportSettings& settings = {});
+
+        /**
+         * @brief Decodes the influences of a vertex.
+         * @param vertex The index of the vertex.
+         * @param boneIDs Receives GetInfluenceCount bone indices.
+         * @param weights Receives GetInfluenceCount weights.
+         * @return The number of influences written.
+         */
+        uint32_t Decode(uint32_t vertex, uint32_t* boneIDs, float* weights) const;
+
+        /**
+         * @brief Gets the layout of the skin vertex buffer, bound after the attributes of Vertex.
+         */
+        BufferLayout GetLayout() const;
+
+        bool IsEmpty() const { return m_VertexCount == 0; }
+        uint32_t GetVertexCount() const { return m_VertexCount; }
+        uint32_t GetInfluenceCount() const { return m_InfluenceCount; }
+        uint32_t GetStride() const { return m_Stride; }
+        SkinIndexFormat GetIndexFormat() const { return m_IndexFormat; }
+        SkinWeightFormat GetWeightFormat() const { return m_WeightFormat; }
+
+        /**
+         * @brief Gets the packed influences of every vertex, GetStride bytes each.
+         */
+        const std::vector<uint8_t>& GetData() const { return m_Data; }
+
+    private:
+        friend class cereal::access;
+
+        template<class Archive>
+        void serialize(Archive& archive)
+        {
+            archive(m_Data, m_VertexCount, m_InfluenceCount, m_Stride, m_IndexFormat, m_WeightFormat);
+        }
+
+    private:
+        std::vector<uint8_t> m_Data; ///< The packed influences.
+        uint32_t m_VertexCount = 0; ///< The number of vertices.
+        uint32_t m_InfluenceCount = 0; ///< The number of influences per vertex, 4 or 8.
+        uint32_t m_Stride = 0; ///< The size of the influences of one vertex in bytes.
+        SkinIndexFormat m_IndexFormat = SkinIndexFormat::UInt8; ///< The storage of the indices.
+        SkinWeightFormat m_WeightFormat = SkinWeightFormat::UNorm8; ///< The storage of the weights.
+    };
+
+    /** @} */
+}
@@ -3,6 +3,7 @@
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/vector.hpp>
@@ -167,6 +168,7 @@ namespace Coffee {
         ZoneScoped;
 
         glDeleteTextures(1, &m_textureID);
+        RenderState::OnTextureDeleted(m_textureID);
 
         if(m_Data.size() > 0)
         {
@@ -178,7 +180,7 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glBindTextureUnit(slot, m_textureID);
+        RenderState::BindTexture(slot, m_textureID);
     }
 
     void Texture2D::Resize(uint32_t width, uint32_t height)
@@ -189,6 +191,7 @@ namespace Coffee {
         m_Height = height;
 
         glDeleteTextures(1, &m_textureID);
+        RenderState::OnTextureDeleted(m_textureID);
 
         int mipLevels = 1 + floor(log2(std::max(m_Width, m_Height)));
 
@@ -215,8 +218,6 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glBindTexture(GL_TEXTURE_2D, m_textureID);
-
         GLenum format = ImageFormatToOpenGLFormat(m_Properties.Format);
         glClearTexImage(m_textureID, 0, format, GL_FLOAT, &color);
     }
@@ -245,6 +246,7 @@ namespace Coffee {
         ZoneScoped;
         glGenTextures(1, &m_textureID);
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
+        RenderState::Invalidate();
 
         int width, height, nrChannels;
         for (unsigned int i = 0; i < paths.size(); i++)
@@ -299,11 +301,12 @@ namespace Coffee {
     {
         ZoneScoped;
         glDeleteTextures(1, &m_textureID);
+        RenderState::OnTextureDeleted(m_textureID);
     }
 
     void Cubemap::Bind(uint32_t slot)
     {
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
+        RenderState::BindTexture(slot, m_textureID);
     }
 
     void Cubemap::LoadStandardFromFile(const std::filesystem::path& path)
@@ -384,6 +387,7 @@ namespace Coffee {
 
         glGenTextures(1, &m_textureID);
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
+        RenderState::Invalidate();
 
         uint32_t targets[6] = {
             GL_TEXTURE_CUBE_MAP_POSITIVE_X, // +X
@@ -452,6 +456,7 @@ namespace Coffee {
         
         glGenTextures(1, &m_textureID);
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
+        RenderState::Invalidate();
         
         uint32_t targets[6] = {
             GL_TEXTURE_CUBE_MAP_POSITIVE_X, // +X
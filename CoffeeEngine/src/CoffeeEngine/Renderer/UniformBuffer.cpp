@@ -1,21 +1,23 @@
 #include "UniformBuffer.h"
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 
 #include <cstdint>
 #include <glad/glad.h>
 
 namespace Coffee {
 
-    UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding)
+    UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding) : m_Binding(binding)
     {
         glCreateBuffers(1, &m_uboID);
         glNamedBufferData(m_uboID, size, nullptr, GL_DYNAMIC_DRAW); //or GL_DYNAMIC_DRAW? Search what are the differences
-        glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_uboID);
+        RenderState::BindUniformBuffer(binding, m_uboID);
     }
 
     UniformBuffer::~UniformBuffer()
     {
         glDeleteBuffers(1, &m_uboID);
+        RenderState::OnUniformBufferDeleted(m_uboID);
     }
 
     void UniformBuffer::SetData(const void* data, uint32_t size, uint32_t offset)
@@ -23,6 +25,11 @@ namespace Coffee {
         glNamedBufferSubData(m_uboID, offset, size, data);
     }
 
+    void UniformBuffer::Bind()
+    {
+        RenderState::BindUniformBuffer(m_Binding, m_uboID);
+    }
+
     Ref<UniformBuffer> UniformBuffer::Create(uint32_t size, uint32_t binding)
     {
         return CreateRef<UniformBuffer>(size, binding);
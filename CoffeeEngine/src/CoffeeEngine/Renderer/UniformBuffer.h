@@ -37,6 +37,11 @@ namespace Coffee {
          */
         void SetData(const void* data, uint32_t size, uint32_t offset = 0);
 
+        /**
+         * @brief Binds the buffer to its binding point, for buffers sharing a binding point like those of the materials.
+         */
+        void Bind();
+
         /**
          * @brief Creates a uniform buffer with the specified size and binding.
          * @param size The size of the buffer.
@@ -46,6 +51,7 @@ namespace Coffee {
         static Ref<UniformBuffer> Create(uint32_t size, uint32_t binding);
     private:
         uint32_t m_uboID; ///< The ID of the uniform buffer.
+        uint32_t m_Binding; ///< The binding point of the buffer.
     };
 
     /** @} */
@@ -1,4 +1,5 @@
 #include "CoffeeEngine/Renderer/VertexArray.h"
+#include "CoffeeEngine/Renderer/RenderState.h"
 
 #include <glad/glad.h>
 #include <tracy/Tracy.hpp>
@@ -11,6 +12,9 @@ namespace Coffee {
 		{
             case ShaderDataType::Bool:     return GL_BOOL;
             case ShaderDataType::Int:      return GL_INT;
+            case ShaderDataType::IVec4:    return GL_INT;
+            case ShaderDataType::UByte4:   return GL_UNSIGNED_BYTE;
+            case ShaderDataType::UShort4:  return GL_UNSIGNED_SHORT;
 			case ShaderDataType::Float:    return GL_FLOAT;
 			case ShaderDataType::Vec2:     return GL_FLOAT;
 			case ShaderDataType::Vec3:     return GL_FLOAT;
@@ -36,20 +40,21 @@ namespace Coffee {
         ZoneScoped;
 
         glDeleteVertexArrays(1, &m_vaoID);
+        RenderState::OnVertexArrayDeleted(m_vaoID);
     }
 
     void VertexArray::Bind()
     {
         ZoneScoped;
 
-        glBindVertexArray(m_vaoID);
+        RenderState::BindVertexArray(m_vaoID);
     }
 
     void VertexArray::Unbind()
     {
         ZoneScoped;
 
-        glBindVertexArray(0);
+        RenderState::BindVertexArray(0);
     }
 
     void VertexArray::AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer)
@@ -58,7 +63,7 @@ namespace Coffee {
 
 		COFFEE_CORE_ASSERT(vertexBuffer->GetLayout().GetElements().size(), "Vertex Buffer has no layout!");
 
-		glBindVertexArray(m_vaoID);
+		RenderState::BindVertexArray(m_vaoID);
 		vertexBuffer->Bind();
 
 		const auto& layout = vertexBuffer->GetLayout();
@@ -81,7 +86,33 @@ namespace Coffee {
 					m_VertexBufferIndex++;
 					break;
 				}
+				case ShaderDataType::UByte4:
+				case ShaderDataType::UShort4:
+				{
+					// Normalized small integers are read as floats (unorm weights), the others as integers (indices)
+					glEnableVertexAttribArray(m_VertexBufferIndex);
+					if (attribute.Normalized)
+					{
+						glVertexAttribPointer(m_VertexBufferIndex,
+							attribute.GetComponentCount(),
+							ShaderDataTypeToOpenGLBaseType(attribute.Type),
+							GL_TRUE,
+							layout.GetStride(),
+							(const void*)attribute.Offset);
+					}
+					else
+					{
+						glVertexAttribIPointer(m_VertexBufferIndex,
+							attribute.GetComponentCount(),
+							ShaderDataTypeToOpenGLBaseType(attribute.Type),
+							layout.GetStride(),
+							(const void*)attribute.Offset);
+					}
+					m_VertexBufferIndex++;
+					break;
+				}
 				case ShaderDataType::Int:
+				case ShaderDataType::IVec4:
 				case ShaderDataType::Bool:
 				{
 					glEnableVertexAttribArray(m_VertexBufferIndex);
@@ -125,7 +156,7 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glBindVertexArray(m_vaoID);
+        RenderState::BindVertexArray(m_vaoID);
         indexBuffer->Bind();
 
         m_IndexBuffer = indexBuffer;
@@ -6,10 +6,15 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Animation/AnimationGraphInstance.h"
+#include "CoffeeEngine/Animation/Animator.h"
+#include "CoffeeEngine/Animation/BakedAnimation.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
+#include "CoffeeEngine/Math/BoundingBox.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Model.h"
+#include "CoffeeEngine/Renderer/MorphedMesh.h"
 #include "CoffeeEngine/Scene/SceneCamera.h"
 #include <cereal/cereal.hpp>
 #include <cereal/access.hpp>
@@ -241,6 +246,171 @@ namespace Coffee {
         }
     };
 
+    /**
+     * @brief Component animating the skinned meshes of an entity and its children.
+     * @ingroup scene
+     *
+     * The component is driven either by an Animator playing clips or by an AnimationGraphInstance.
+     * Its bone matrices are the per-entity palette read by the renderer.
+     */
+    struct AnimatorComponent
+    {
+        Ref<Animation> animation; ///< The clip played by the animator, kept alive by the component.
+        Ref<Animator> animator; ///< The animator, if the component plays clips.
+        Ref<AnimationGraphInstance> graph; ///< The graph instance, if the component is driven by a graph.
+        float Speed = 1.0f; ///< The playback speed multiplier.
+        AABB Bounds = {glm::vec3(-0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 2.0f, 0.5f)}; ///< The local bounds used to pick the LOD.
+
+        // LOD state, owned by the AnimationSystem
+        uint32_t LOD = 0; ///< The LOD tier used by the last update.
+        uint32_t FramesSinceEvaluation = 0; ///< The frames since the pose was last evaluated.
+        float PendingTime = 0.0f; ///< The time elapsed since the pose was last evaluated.
+        bool Evaluated = false; ///< Whether the pose has been evaluated at least once.
+        bool Interpolating = false; ///< Whether the palette is InterpolatedBoneMatrices instead of the one of the evaluator.
+        std::vector<glm::mat4> PreviousBoneMatrices; ///< The palette evaluated before the last one.
+        std::vector<glm::mat4> InterpolatedBoneMatrices; ///< The palette of the frames between two evaluations.
+
+        AnimatorComponent() = default;
+        AnimatorComponent(const Ref<Animation>& animation)
+            : animation(animation), animator(CreateRef<Animator>(animation.get())) {}
+        AnimatorComponent(const Ref<AnimationGraphInstance>& graph)
+            : graph(graph) {}
+
+        // A copy plays on its own animator or graph instance, the AnimationSystem updates every component from its own
+        // worker and a shared one would be advanced twice per frame. The copy starts from the first frame with a fresh LOD state
+        AnimatorComponent(const AnimatorComponent& other)
+            : animation(other.animation), animator(CopyAnimator(other)), graph(CopyGraph(other)),
+              Speed(other.Speed), Bounds(other.Bounds) {}
+
+        AnimatorComponent& operator=(const AnimatorComponent& other)
+        {
+            if (this != &other)
+            {
+                *this = AnimatorComponent(other);
+            }
+            return *this;
+        }
+
+        // The registry moves components when its storage grows, which keeps the animator and the LOD state
+        AnimatorComponent(AnimatorComponent&&) = default;
+        AnimatorComponent& operator=(AnimatorComponent&&) = default;
+
+        /**
+         * @brief Advances the animation and evaluates the bone matrices.
+         * @param dt The elapsed time in seconds.
+         * @param boneReduction The bone reduction level of the evaluation.
+         * @param poseCache The pose cache shared by the animated entities, or nullptr.
+         */
+        void Evaluate(float dt, int boneReduction, AnimationPoseCache* poseCache = nullptr)
+        {
+            if (graph)
+            {
+                graph->SetBoneReduction(boneReduction);
+                graph->Update(dt * Speed);
+            }
+            else if (animator)
+            {
+                animator->SetBoneReduction(boneReduction);
+                animator->UpdateAnimation(dt * Speed, poseCache);
+            }
+        }
+
+        /**
+         * @brief Gets the bone matrices of the last evaluation.
+         * @return The bone matrices, or nullptr if the component has nothing to play.
+         */
+        const std::vector<glm::mat4>* GetEvaluatedBoneMatrices() const
+        {
+            if (graph)
+                return &graph->GetFinalBoneMatrices();
+            if (animator)
+                return &animator->GetFinalBoneMatrices();
+            return nullptr;
+        }
+
+        /**
+         * @brief Gets the bone matrices to draw this frame.
+         * @return The bone matrices, or nullptr if the component has nothing to play.
+         */
+        const std::vector<glm::mat4>* GetBoneMatrices() const
+        {
+            return Interpolating ? &InterpolatedBoneMatrices : GetEvaluatedBoneMatrices();
+        }
+
+    private:
+        static Ref<Animator> CopyAnimator(const AnimatorComponent& other)
+        {
+            if (!other.animator)
+                return nullptr;
+
+            Ref<Animator> animator = CreateRef<Animator>(other.animation.get());
+            animator->SetBoneMask(other.animator->GetBoneMask());
+            return animator;
+        }
+
+        static Ref<AnimationGraphInstance> CopyGraph(const AnimatorComponent& other)
+        {
+            return other.graph ? CreateRef<AnimationGraphInstance>(other.graph->GetGraph()) : nullptr;
+        }
+    };
+
+    /**
+     * @brief Component playing a baked clip, for crowds that do not need blending.
+     * @ingroup scene
+     *
+     * An update only advances the time and picks two frames of the shared table, the standard shader lerps them.
+     */
+    struct BakedAnimatorComponent
+    {
+        Ref<BakedAnimation> baked; ///< The baked clip, shared by every instance playing it.
+        float Time = 0.0f; ///< The playback time in seconds.
+        float Speed = 1.0f; ///< The playback speed multiplier.
+        BakedFrame Frame; ///< The frames drawn this frame, updated by the AnimationSystem.
+
+        BakedAnimatorComponent() = default;
+        BakedAnimatorComponent(const BakedAnimatorComponent&) = default;
+        BakedAnimatorComponent(const Ref<BakedAnimation>& baked, float time = 0.0f)
+            : baked(baked), Time(time), Frame(baked ? baked->GetFrame(time) : BakedFrame{}) {}
+    };
+
+    /**
+     * @brief Component displacing the mesh of an entity by its blend shapes.
+     * @ingroup scene
+     *
+     * When the closest AnimatorComponent plays a clip animating the mesh, the weights follow the clip,
+     * otherwise they keep the values set by the game. The AnimationSystem applies them every frame.
+     */
+    struct MorphTargetComponent
+    {
+        std::vector<float> Weights; ///< The weight of every target of the mesh.
+        float MinWeight = 1.0e-3f; ///< The weight below which a target is skipped.
+        Ref<MorphedMesh> Morphed; ///< The displaced vertices of this instance.
+
+        MorphTargetComponent() = default;
+        MorphTargetComponent(const Ref<Mesh>& mesh)
+            : Weights(mesh->GetMorphTargets().GetDefaultWeights()), Morphed(CreateRef<MorphedMesh>(mesh)) {}
+
+        // A copy displaces its own vertices, sharing the buffer would make every copy draw the weights of the last one updated
+        MorphTargetComponent(const MorphTargetComponent& other)
+            : Weights(other.Weights), MinWeight(other.MinWeight),
+              Morphed(other.Morphed ? CreateRef<MorphedMesh>(other.Morphed->GetMesh()) : nullptr) {}
+
+        MorphTargetComponent& operator=(const MorphTargetComponent& other)
+        {
+            if (this != &other)
+            {
+                Weights = other.Weights;
+                MinWeight = other.MinWeight;
+                Morphed = other.Morphed ? CreateRef<MorphedMesh>(other.Morphed->GetMesh()) : nullptr;
+            }
+            return *this;
+        }
+
+        // The registry moves components when its storage grows, which keeps the buffer of the instance
+        MorphTargetComponent(MorphTargetComponent&&) = default;
+        MorphTargetComponent& operator=(MorphTargetComponent&&) = default;
+    };
+
     /**
      * @brief Component representing a light.
      * @ingroup scene
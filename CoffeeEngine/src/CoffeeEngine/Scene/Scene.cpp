@@ -1,5 +1,6 @@
 #include "Scene.h"
 
+#include "CoffeeEngine/Animation/AnimationSystem.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/DataStructures/Octree.h"
 #include "CoffeeEngine/Math/Frustum.h"
@@ -102,6 +103,10 @@ namespace Coffee {
 
         for (auto& entity : view)
         {
+            // Skinned and morphed meshes move every frame, they are submitted by OnUpdateRuntime instead
+            if (AnimationSystem::FindBonePalette(m_Registry, entity).matrices || m_Registry.all_of<MorphTargetComponent>(entity))
+                continue;
+
             auto& meshComponent = view.get<MeshComponent>(entity);
             auto& transformComponent = m_Registry.get<TransformComponent>(entity);
 
@@ -187,6 +192,8 @@ namespace Coffee {
             cameraTransform = glm::mat4(1.0f);
         }
 
+        AnimationSystem::Update(m_Registry, dt, cameraTransform, camera->GetProjection());
+
         //TODO: Add this to a function bc it is repeated in OnUpdateEditor
         Renderer::BeginScene(*camera, cameraTransform);
 
@@ -205,6 +212,52 @@ namespace Coffee {
         {
             Renderer::Submit(RenderCommand{mesh.transform, mesh.object, mesh.object->GetMaterial(), 0});
         }
+
+        // Skinned and morphed meshes, culled with their animated bounds and drawn with the palette their animator evaluated this frame
+        auto skinnedView = m_Registry.view<MeshComponent, TransformComponent>();
+        for (auto& entity : skinnedView)
+        {
+            BonePalette palette = AnimationSystem::FindBonePalette(m_Registry, entity);
+            const MorphTargetComponent* morph = m_Registry.try_get<MorphTargetComponent>(entity);
+            bool morphed = morph && morph->Morphed;
+            if (!palette.matrices && !morphed)
+                continue;
+
+            auto& meshComponent = skinnedView.get<MeshComponent>(entity);
+            auto& transformComponent = skinnedView.get<TransformComponent>(entity);
+
+            const Ref<Mesh>& mesh = meshComponent.GetMesh();
+            AABB animatedAABB = mesh->GetAnimatedAABB(palette.matrices, palette.count);
+            if (palette.nextMatrices)
+            {
+                // The blended pose lies within the bounds of the two poses it is blended from
+                AABB nextAABB = mesh->GetAnimatedAABB(palette.nextMatrices, palette.count);
+                animatedAABB.min = glm::min(animatedAABB.min, nextAABB.min);
+                animatedAABB.max = glm::max(animatedAABB.max, nextAABB.max);
+            }
+            if (morphed)
+            {
+                // The bones move the displaced vertices, which is close enough to displacing the skinned ones for culling
+                glm::vec3 displacement(morph->Morphed->GetMaxDisplacement());
+                animatedAABB.min -= displacement;
+                animatedAABB.max += displacement;
+            }
+            if (!frustum.Contains(animatedAABB.CalculateTransformedAABB(transformComponent.GetWorldTransform())))
+                continue;
+
+            auto materialComponent = m_Registry.try_get<MaterialComponent>(entity);
+
+            Ref<Material> material = (materialComponent) ? materialComponent->material : nullptr;
+
+            RenderCommand command{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity};
+            command.boneMatrices = palette.matrices;
+            command.boneCount = palette.count;
+            command.nextBoneMatrices = palette.nextMatrices;
+            command.boneLerp = palette.lerp;
+            if (morphed)
+                command.vertexArray = morph->Morphed->GetVertexArray();
+            Renderer::Submit(command);
+        }
         
 /*         // Get all entities with ModelComponent and TransformComponent
         auto view = m_Registry.view<MeshComponent, TransformComponent>();